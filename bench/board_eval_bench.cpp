@@ -0,0 +1,125 @@
+// Throughput of the batch board evaluator. Boards come from real games played
+// by the greedy planner, so stacks, holes and wells look like search input.
+// Every backend's output is checked against the scalar one before timing.
+
+#include "ai/BoardEvaluator.h"
+#include "ai/Planner.h"
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+namespace {
+
+using namespace cretris;
+
+void collect_boards(std::size_t count, std::uint64_t seed, ai::BoardBatch &batch) {
+    // One-ply play with a weakened hole penalty keeps the stacks ragged.
+    ai::Planner::Options options;
+    options.look_ahead = false;
+    options.weights.holes = -1.0f;
+    ai::Planner planner{options};
+    std::vector<ai::Placement> placements;
+    while (batch.size() < count) {
+        core::Game game{seed++};
+        for (int piece = 0; piece < 400 && !game.state().game_over && batch.size() < count; ++piece) {
+            ai::find_placements(game.occupancy(), game.state().active_piece, placements);
+            for (const auto &placement : placements) {
+                if (batch.size() < count) {
+                    batch.push(placement.result);
+                }
+            }
+            for (auto action : planner.plan(game)) {
+                game.apply_action(action);
+            }
+        }
+    }
+}
+
+bool same_features(const ai::FeatureBatch &a, const ai::FeatureBatch &b) {
+    auto equal = [&](const std::vector<std::int16_t> &x, const std::vector<std::int16_t> &y, std::size_t columns) {
+        for (std::size_t c = 0; c < columns; ++c) {
+            for (std::size_t i = 0; i < a.size; ++i) {
+                if (x[c * a.stride + i] != y[c * b.stride + i]) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    };
+    return equal(a.column_heights, b.column_heights, core::BOARD_WIDTH) &&
+           equal(a.aggregate_height, b.aggregate_height, 1) && equal(a.max_height, b.max_height, 1) &&
+           equal(a.holes, b.holes, 1) && equal(a.row_transitions, b.row_transitions, 1) &&
+           equal(a.column_transitions, b.column_transitions, 1) && equal(a.bumpiness, b.bumpiness, 1) &&
+           equal(a.well_sums, b.well_sums, 1);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::size_t boards = 4096;
+    double seconds = 1.0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string { return i + 1 < argc ? argv[++i] : ""; };
+        if (arg == "--boards") {
+            boards = std::max<std::size_t>(1, std::stoul(next()));
+        } else if (arg == "--seconds") {
+            seconds = std::stod(next());
+        } else {
+            std::cout << "Usage: " << argv[0] << " [--boards N] [--seconds SECONDS]\n";
+            return arg == "--help" || arg == "-h" ? 0 : 1;
+        }
+    }
+
+    ai::BoardBatch batch;
+    batch.reserve(boards);
+    collect_boards(boards, 1, batch);
+
+    ai::FeatureBatch reference;
+    ai::evaluate(batch, reference, ai::EvaluatorBackend::Scalar);
+
+    int status = 0;
+    for (auto backend : {ai::EvaluatorBackend::Scalar, ai::EvaluatorBackend::Avx2}) {
+        if (!ai::backend_available(backend)) {
+            std::printf("%-7s: not supported on this CPU\n", ai::backend_name(backend));
+            continue;
+        }
+        ai::FeatureBatch features;
+        ai::evaluate(batch, features, backend);
+        if (!same_features(reference, features)) {
+            std::printf("%-7s: MISMATCH against scalar\n", ai::backend_name(backend));
+            status = 1;
+            continue;
+        }
+
+        using clock_type = std::chrono::steady_clock;
+        std::uint64_t evaluated = 0;
+        auto start = clock_type::now();
+        auto deadline = start + std::chrono::duration_cast<clock_type::duration>(std::chrono::duration<double>(seconds));
+        do {
+            ai::evaluate(batch, features, backend);
+            evaluated += batch.size();
+        } while (clock_type::now() < deadline);
+        double elapsed = std::chrono::duration<double>(clock_type::now() - start).count();
+        std::printf("%-7s: %.1f M boards/sec (batch of %zu)\n", ai::backend_name(backend),
+                    static_cast<double>(evaluated) / elapsed / 1e6, batch.size());
+    }
+
+    ai::Planner planner;
+    core::Game game{7};
+    auto start = std::chrono::steady_clock::now();
+    int pieces = 0;
+    for (; pieces < 2000 && !game.state().game_over; ++pieces) {
+        for (auto action : planner.plan(game)) {
+            game.apply_action(action);
+        }
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("planner: %d pieces, %d lines, %.0f pieces/sec, %.0f boards/piece (%s)\n", pieces,
+                game.state().total_lines, pieces / elapsed,
+                static_cast<double>(planner.boards_evaluated()) / std::max(1, pieces),
+                ai::backend_name(ai::EvaluatorBackend::Auto));
+    return status;
+}
@@ -0,0 +1,68 @@
+// Cost of frame-based play (Game::step_frame) across gravity speeds. With the
+// cached drop distance, 20G should cost no more per frame than 1/60G.
+
+#include "core/Game.h"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+namespace {
+
+using namespace cretris;
+
+template <typename GameType>
+GameType at_level(std::uint64_t seed, int level) {
+    GameType game{seed};
+    auto state = game.state();
+    state.level = level;
+    return GameType{state, seed, game.randomizer().position()};
+}
+
+// Random inputs, mostly idle as a human would be.
+template <typename GameType>
+void run(const char *label, int level, std::uint64_t frames) {
+    using clock_type = std::chrono::steady_clock;
+    std::uint64_t seed = 1;
+    std::uint64_t pieces = 0;
+    std::uint64_t landed_on_spawn = 0;
+    std::uint64_t done = 0;
+    auto start = clock_type::now();
+    while (done < frames) {
+        GameType game = at_level<GameType>(seed++, level);
+        std::uint64_t piece = game.randomizer().position();
+        bool fresh = true;
+        for (std::uint64_t step = 0; done < frames && game.state().game_over == false; ++step, ++done) {
+            std::uint64_t draw = core::counter_random(seed, step);
+            auto action = draw % 8 == 0 ? static_cast<core::InputAction>((draw >> 8) % 7) : core::InputAction::None;
+            if (action == core::InputAction::HardDrop || action == core::InputAction::SoftDrop) {
+                action = core::InputAction::None; // let gravity and lock delay do the work
+            }
+            game.step_frame(action);
+            if (fresh && game.drop_distance() == 0) {
+                ++landed_on_spawn;
+            }
+            fresh = game.randomizer().position() != piece;
+            if (fresh) {
+                piece = game.randomizer().position();
+                ++pieces;
+            }
+        }
+    }
+    double elapsed = std::chrono::duration<double>(clock_type::now() - start).count();
+    std::printf("%-22s level %2d: %6.1f ns/frame, %llu pieces, %.0f%% landed on their first frame\n", label, level,
+                elapsed * 1e9 / static_cast<double>(frames), static_cast<unsigned long long>(pieces),
+                pieces > 0 ? 100.0 * static_cast<double>(landed_on_spawn) / static_cast<double>(pieces) : 0.0);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::uint64_t frames = argc > 1 ? std::stoull(argv[1]) : 20000000;
+    run<core::Game>("StandardRules", 1, frames);
+    run<core::Game>("StandardRules", 20, frames);
+    run<core::MasterGame>("MasterRules (1/60G)", 1, frames);
+    run<core::MasterGame>("MasterRules (1G)", 8, frames);
+    run<core::MasterGame>("MasterRules (20G)", 20, frames);
+    return 0;
+}
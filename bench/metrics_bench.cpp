@@ -0,0 +1,72 @@
+// Cost of recording a metric on the hot path, from one thread and from many
+// threads hammering the same metric at once.
+
+#include "metrics/Metrics.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace cretris;
+
+template <typename Body>
+double ns_per_op(std::size_t threads, std::uint64_t iterations, Body body) {
+    using clock_type = std::chrono::steady_clock;
+    auto start = clock_type::now();
+    std::vector<std::thread> workers;
+    for (std::size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&body, iterations, t] {
+            for (std::uint64_t i = 0; i < iterations; ++i) {
+                body(t, i);
+            }
+        });
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    double elapsed = std::chrono::duration<double>(clock_type::now() - start).count();
+    // Per thread: threads run concurrently, so this is the latency each caller sees.
+    return elapsed * 1e9 / static_cast<double>(iterations);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::uint64_t iterations = 20'000'000;
+    std::size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) {
+            iterations = std::stoull(argv[++i]);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            max_threads = std::stoul(argv[++i]);
+        } else {
+            std::fprintf(stderr, "usage: %s [--iterations N] [--threads N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    auto &registry = metrics::registry();
+    auto &counter = registry.counter("bench_counter_total", "Bench counter.");
+    auto &gauge = registry.gauge("bench_gauge", "Bench gauge.");
+    auto &histogram = registry.histogram("bench_seconds", "Bench histogram.", metrics::latency_bounds());
+
+    for (std::size_t threads = 1; threads <= max_threads; threads *= 2) {
+        double inc = ns_per_op(threads, iterations, [&](std::size_t, std::uint64_t) { counter.inc(); });
+        double set = ns_per_op(threads, iterations,
+                               [&](std::size_t, std::uint64_t i) { gauge.set(static_cast<double>(i)); });
+        double observe = ns_per_op(threads, iterations, [&](std::size_t, std::uint64_t i) {
+            histogram.observe(static_cast<double>(i % 1000) * 1e-5);
+        });
+        std::printf("%2zu thread(s): counter.inc %5.1f ns, gauge.set %5.1f ns, histogram.observe %5.1f ns\n", threads,
+                    inc, set, observe);
+    }
+    std::printf("counter total %llu, histogram count %llu\n", static_cast<unsigned long long>(counter.value()),
+                static_cast<unsigned long long>(histogram.snapshot().count));
+    return 0;
+}
@@ -0,0 +1,149 @@
+// Perfect-clear solver latency on real positions: every seed's opening and,
+// with --midgame, every low stack met while the greedy planner plays on.
+// Solutions are replayed on the board and must leave it empty.
+
+#include "ai/PerfectClear.h"
+#include "ai/Planner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace cretris;
+
+struct Tally {
+    int found{0};
+    int impossible{0};
+    int timed_out{0};
+    int invalid{0};
+    std::uint64_t nodes{0};
+    std::vector<double> millis{};
+};
+
+// Replays the known part of a solution; only complete when it fits in the queue.
+bool check(const ai::PerfectClearProblem &problem, const ai::PerfectClearResult &result) {
+    ai::Bitboard board = problem.board;
+    for (const auto &pose : result.placements) {
+        if (!ai::fits(board, pose)) {
+            return false;
+        }
+        ai::lock(board, pose);
+    }
+    if (result.pieces > static_cast<int>(result.placements.size())) {
+        return true;
+    }
+    return std::all_of(board.begin(), board.end(), [](auto row) { return row == 0; });
+}
+
+void solve(ai::PerfectClearSolver &solver, const core::Game &game, std::chrono::milliseconds budget, Tally &tally) {
+    auto problem = ai::PerfectClearProblem::from(game);
+    auto start = std::chrono::steady_clock::now();
+    auto result = solver.solve(problem, start + budget);
+    tally.millis.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    tally.nodes += result.nodes;
+    switch (result.status) {
+    case ai::PerfectClearStatus::Found:
+        ++tally.found;
+        tally.invalid += check(problem, result) ? 0 : 1;
+        break;
+    case ai::PerfectClearStatus::Impossible:
+        ++tally.impossible;
+        break;
+    case ai::PerfectClearStatus::TimedOut:
+        ++tally.timed_out;
+        break;
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int positions = 100;
+    int budget_ms = 250;
+    bool midgame = false;
+    ai::PerfectClearSolver::Options options;
+    options.threads = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string { return i + 1 < argc ? argv[++i] : "0"; };
+        if (arg == "--positions") {
+            positions = std::max(1, std::stoi(next()));
+        } else if (arg == "--budget-ms") {
+            budget_ms = std::stoi(next());
+        } else if (arg == "--pieces") {
+            options.max_pieces = std::stoi(next());
+        } else if (arg == "--height") {
+            options.max_height = std::stoi(next());
+        } else if (arg == "--threads") {
+            options.threads = std::stoul(next());
+        } else if (arg == "--midgame") {
+            midgame = true;
+        } else {
+            std::cout << "Usage: " << argv[0]
+                      << " [--positions N] [--budget-ms MS] [--pieces N] [--height ROWS] [--threads N] [--midgame]\n";
+            return arg == "--help" || arg == "-h" ? 0 : 1;
+        }
+    }
+
+    ai::PerfectClearSolver solver{options};
+    Tally tally;
+    auto budget = std::chrono::milliseconds{budget_ms};
+    ai::Planner planner;
+    for (std::uint64_t seed = 1; static_cast<int>(tally.millis.size()) < positions; ++seed) {
+        core::Game game{seed};
+        solve(solver, game, budget, tally);
+        for (int piece = 0; midgame && piece < 200 && !game.state().game_over; ++piece) {
+            for (auto action : planner.plan(game)) {
+                game.apply_action(action);
+            }
+            bool low = std::all_of(game.occupancy().begin(), game.occupancy().end() - solver.options().max_height,
+                                   [](auto row) { return row == 0; });
+            if (low && static_cast<int>(tally.millis.size()) < positions) {
+                solve(solver, game, budget, tally);
+            }
+        }
+    }
+
+    std::sort(tally.millis.begin(), tally.millis.end());
+    auto percentile = [&](double p) {
+        return tally.millis[std::min(tally.millis.size() - 1, static_cast<std::size_t>(p * tally.millis.size()))];
+    };
+    std::printf("%zu positions, up to %d pieces and %d rows, %zu thread(s), %d ms budget\n", tally.millis.size(),
+                solver.options().max_pieces, solver.options().max_height, solver.options().threads, budget_ms);
+    std::printf("found %d, impossible %d, timed out %d, invalid %d\n", tally.found, tally.impossible,
+                tally.timed_out, tally.invalid);
+    std::printf("solve time p50 %.2f ms, p90 %.2f ms, max %.2f ms; %.0f nodes per position\n", percentile(0.5),
+                percentile(0.9), tally.millis.back(),
+                static_cast<double>(tally.nodes) / static_cast<double>(tally.millis.size()));
+
+    // The same planner playing with the solver on a per-piece budget, counting
+    // how often the board really ends up empty.
+    for (auto pc_budget : {std::chrono::milliseconds{0}, budget}) {
+        ai::Planner::Options bot_options;
+        bot_options.perfect_clear_budget = pc_budget;
+        bot_options.perfect_clear = options;
+        ai::Planner bot{bot_options};
+        int clears = 0;
+        int pieces = 0;
+        for (std::uint64_t seed = 1; seed <= 5; ++seed) {
+            core::Game game{seed};
+            for (int piece = 0; piece < 200 && !game.state().game_over; ++piece, ++pieces) {
+                for (auto action : bot.plan(game)) {
+                    game.apply_action(action);
+                }
+                bool empty = std::all_of(game.occupancy().begin(), game.occupancy().end(),
+                                         [](auto row) { return row == 0; });
+                clears += empty ? 1 : 0;
+            }
+        }
+        std::printf("planner%s: %d perfect clears in %d pieces (%zu solver moves)\n",
+                    pc_budget.count() > 0 ? " + solver" : "", clears, pieces, bot.perfect_clear_moves());
+    }
+    return tally.invalid == 0 ? 0 : 1;
+}
@@ -0,0 +1,168 @@
+// Cost of SdlFrontend::render on SDL's software renderer, drawing into an
+// offscreen surface so no window or display is needed. Each state of a small
+// corpus is drawn for a number of frames, first plainly for the frame time and
+// then with profiling on for the split by section and the draw calls.
+//
+//   cretris-bench-render [frames] [--window]
+//
+// --window renders through a real window instead; with SDL_VIDEODRIVER=dummy
+// that is the software renderer drawing into the window surface.
+
+#include "frontend/sdl/SdlFrontend.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace cretris;
+
+constexpr int WIDTH = 1280;
+constexpr int HEIGHT = 780;
+
+struct Scenario {
+    const char *name;
+    core::GameState state;
+    core::GameEvents events{}; // handed to on_events before every frame
+};
+
+// Fills rows [top, BOARD_HEIGHT) with random colours, leaving one hole per row
+// so nothing would clear.
+void fill_stack(core::GameState &state, int top, std::uint64_t seed) {
+    for (int y = top; y < core::BOARD_HEIGHT; ++y) {
+        auto hole = static_cast<int>(core::counter_random(seed, static_cast<std::uint64_t>(y)) % core::BOARD_WIDTH);
+        for (int x = 0; x < core::BOARD_WIDTH; ++x) {
+            auto draw = core::counter_random(seed, static_cast<std::uint64_t>(y * core::BOARD_WIDTH + x + 100));
+            state.board[static_cast<std::size_t>(y)][static_cast<std::size_t>(x)] =
+                x == hole ? -1 : static_cast<int>(draw % (core::GARBAGE_CELL + 1));
+        }
+    }
+}
+
+std::vector<Scenario> corpus() {
+    core::Game game{7};
+    std::vector<Scenario> scenarios;
+
+    scenarios.push_back({"empty", game.state()});
+
+    auto half = game.state();
+    fill_stack(half, core::BOARD_HEIGHT / 2, 1);
+    half.score = 48200;
+    half.total_lines = 57;
+    half.level = 6;
+    scenarios.push_back({"half-full", half});
+
+    auto tall = half;
+    fill_stack(tall, 3, 2);
+    tall.score = 1234560;
+    tall.total_lines = 412;
+    tall.level = 15;
+    scenarios.push_back({"tall stack", tall});
+
+    auto over = tall;
+    over.game_over = true;
+    scenarios.push_back({"game over", over});
+
+    // A tetris every frame keeps the flash lit and the particle pool full.
+    Scenario flash{"line flash", half};
+    core::GameEvent cleared;
+    cleared.type = core::GameEventType::LinesCleared;
+    cleared.count = 4;
+    cleared.rows = {19, 18, 17, 16};
+    flash.events.push_back(cleared);
+    scenarios.push_back(flash);
+    return scenarios;
+}
+
+double microseconds(std::chrono::nanoseconds duration) { return static_cast<double>(duration.count()) / 1e3; }
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int frames = 500;
+    bool window = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--window") == 0) {
+            window = true;
+        } else {
+            frames = std::max(1, std::stoi(argv[i]));
+        }
+    }
+
+    auto scenarios = corpus();
+    frontend::SdlFrontend frontend;
+    if (window) {
+        frontend.initialize(scenarios.front().state);
+    } else if (!frontend.initialize_offscreen(WIDTH, HEIGHT)) {
+        return 1;
+    }
+
+    std::printf("%s renderer, %dx%d, %d frames per state\n\n", window ? "window" : "offscreen software", WIDTH, HEIGHT,
+                frames);
+    std::printf("%-11s %8s %8s %8s | %8s %8s %8s %8s %8s %8s %8s %8s %8s  (us/frame)\n", "state", "mean", "p99",
+                "calls", "backgrnd", "board", "particle", "next", "stats", "text", "gameover", "capture", "present");
+
+    std::uint64_t version = 0;
+    for (auto &scenario : scenarios) {
+        auto state = scenario.state;
+        auto draw = [&] {
+            if (!scenario.events.empty()) {
+                frontend.on_events(scenario.events);
+            }
+            state.version = ++version; // a new version, so no frame is skipped
+            frontend.render(state);
+        };
+
+        for (int f = 0; f < frames / 10 + 1; ++f) {
+            draw(); // warm-up
+        }
+
+        frontend.set_profiling(false);
+        std::vector<double> times;
+        times.reserve(static_cast<std::size_t>(frames));
+        for (int f = 0; f < frames; ++f) {
+            auto start = std::chrono::steady_clock::now();
+            draw();
+            times.push_back(microseconds(std::chrono::steady_clock::now() - start));
+        }
+        double mean = 0.0;
+        for (double t : times) {
+            mean += t;
+        }
+        mean /= static_cast<double>(times.size());
+        auto rank = static_cast<std::size_t>(0.99 * static_cast<double>(times.size() - 1));
+        std::nth_element(times.begin(), times.begin() + static_cast<std::ptrdiff_t>(rank), times.end());
+        auto calls = frontend.last_frame_draw_calls();
+
+        frontend.set_profiling(true);
+        frontend::SdlFrontend::FrameProfile total{};
+        for (int f = 0; f < frames; ++f) {
+            draw();
+            const auto &profile = frontend.last_frame_profile();
+            for (std::size_t s = 0; s < total.size(); ++s) {
+                total[s].time += profile[s].time;
+                total[s].draw_calls += profile[s].draw_calls;
+            }
+        }
+
+        std::printf("%-11s %8.1f %8.1f %8llu |", scenario.name, mean, times[rank], static_cast<unsigned long long>(calls));
+        for (const auto &cost : total) {
+            std::printf(" %8.1f", microseconds(cost.time) / frames);
+        }
+        std::printf("\n%-11s %8s %8s %8s |", "", "", "", "calls:");
+        for (const auto &cost : total) {
+            std::printf(" %8llu", static_cast<unsigned long long>(cost.draw_calls / static_cast<std::uint64_t>(frames)));
+        }
+        if (frontend.particles() > 0) {
+            std::printf("  (%zu particles)", frontend.particles());
+        }
+        std::printf("\n");
+    }
+
+    frontend.shutdown();
+    return 0;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "core/Game.h"
+
+#include <cstdint>
+
+namespace cretris::fuzz {
+
+// Frozen copy of the original cell-by-cell core::Game logic. It exists only as
+// an oracle for differential fuzzing; optimisations belong in core::BasicGame.
+class ReferenceGame {
+public:
+    explicit ReferenceGame(std::uint64_t seed);
+
+    const core::GameState &state() const noexcept { return state_; }
+
+    void apply_action(core::InputAction action);
+    bool tick();
+
+private:
+    bool collides(const core::Tetromino &tet) const;
+    void lock_piece();
+    void spawn_piece();
+    void refill_queue();
+    void clear_lines();
+    void place_active(core::Tetromino &target, core::Rotation new_rotation);
+    void move_active(int dx, int dy);
+
+    core::GameState state_{};
+    core::BagRandomizer randomizer_;
+};
+
+} // namespace cretris::fuzz
@@ -0,0 +1,158 @@
+// Differential fuzz target: drives core::Game and the frozen ReferenceGame with
+// the same seed and input stream and aborts on the first diverging GameState.
+//
+// Input layout: 8 bytes of seed, then one byte per step. step % 8 selects
+// InputAction::None..RotateCCW, or a gravity tick for 7.
+//
+// Built with -DCRETRIS_LIBFUZZER this is a libFuzzer target; otherwise the
+// standalone driver below replays corpus files or generates random streams.
+
+#include "ReferenceGame.h"
+
+#include "core/Game.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using cretris::core::GameState;
+using cretris::core::InputAction;
+
+constexpr std::uint8_t TICK_STEP = 7;
+
+void print_state(const char *label, const GameState &state) {
+    std::fprintf(stderr, "%s: score %d lines %d level %d over %d piece %zu rot %zu at (%d,%d) queue", label,
+                 state.score, state.total_lines, state.level, state.game_over ? 1 : 0,
+                 static_cast<std::size_t>(state.active_piece.type), static_cast<std::size_t>(state.active_piece.rotation),
+                 state.active_piece.position.x, state.active_piece.position.y);
+    for (auto type : state.queue) {
+        std::fprintf(stderr, " %zu", static_cast<std::size_t>(type));
+    }
+    std::fprintf(stderr, "\n");
+    for (const auto &row : state.board) {
+        std::fprintf(stderr, "  ");
+        for (int cell : row) {
+            std::fputc(cell < 0 ? '.' : static_cast<char>('0' + cell), stderr);
+        }
+        std::fprintf(stderr, "\n");
+    }
+}
+
+bool same_state(const GameState &a, const GameState &b) {
+    return a.score == b.score && a.total_lines == b.total_lines && a.level == b.level &&
+           a.game_over == b.game_over && a.active_piece.type == b.active_piece.type &&
+           a.active_piece.rotation == b.active_piece.rotation && a.active_piece.position.x == b.active_piece.position.x &&
+           a.active_piece.position.y == b.active_piece.position.y && a.queue == b.queue && a.board == b.board;
+}
+
+// Returns the number of steps executed before both games ended or the input ran out.
+std::size_t run_one(const std::uint8_t *data, std::size_t size) {
+    std::uint64_t seed = 0;
+    std::size_t header = size < sizeof(seed) ? size : sizeof(seed);
+    std::memcpy(&seed, data, header);
+
+    cretris::core::Game game{seed};
+    cretris::fuzz::ReferenceGame reference{seed};
+
+    std::size_t steps = 0;
+    for (std::size_t i = header; i < size; ++i) {
+        std::uint8_t step = data[i] % 8;
+        bool alive = true;
+        bool reference_alive = true;
+        if (step == TICK_STEP) {
+            alive = game.tick();
+            reference_alive = reference.tick();
+        } else {
+            game.apply_action(static_cast<InputAction>(step));
+            reference.apply_action(static_cast<InputAction>(step));
+        }
+        ++steps;
+
+        if (alive != reference_alive || !same_state(game.state(), reference.state())) {
+            std::fprintf(stderr, "divergence at step %zu (byte %zu, step %u, seed %llu)\n", steps, i,
+                         static_cast<unsigned>(step), static_cast<unsigned long long>(seed));
+            print_state("game", game.state());
+            print_state("reference", reference.state());
+            std::abort();
+        }
+        if (game.state().game_over) {
+            break;
+        }
+    }
+    return steps;
+}
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t *data, std::size_t size) {
+    run_one(data, size);
+    return 0;
+}
+
+#ifndef CRETRIS_LIBFUZZER
+
+int main(int argc, char **argv) {
+    double seconds = 5.0;
+    std::uint64_t seed = std::random_device{}();
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--seconds" && i + 1 < argc) {
+            seconds = std::stod(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = std::stoull(argv[++i]);
+        } else if (arg == "--help" || arg == "-h") {
+            std::printf("Usage: %s [--seconds S] [--seed N] [CORPUS_FILE...]\n", argv[0]);
+            return 0;
+        } else {
+            files.push_back(arg);
+        }
+    }
+
+    if (!files.empty()) {
+        for (const auto &path : files) {
+            std::ifstream in(path, std::ios::binary);
+            std::vector<std::uint8_t> bytes{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+            std::size_t steps = run_one(bytes.data(), bytes.size());
+            std::printf("%s: %zu steps ok\n", path.c_str(), steps);
+        }
+        return 0;
+    }
+
+    // Random streams: skew towards movement so pieces travel before they lock.
+    std::mt19937_64 rng{seed};
+    std::vector<std::uint8_t> input(8 + 16384);
+    std::uint64_t total_steps = 0;
+    std::uint64_t games = 0;
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                std::chrono::duration<double>(seconds));
+    while (std::chrono::steady_clock::now() < deadline) {
+        for (int batch = 0; batch < 16; ++batch) {
+            std::uint64_t game_seed = rng();
+            std::memcpy(input.data(), &game_seed, sizeof(game_seed));
+            for (std::size_t i = 8; i < input.size(); i += 8) {
+                std::uint64_t bits = rng();
+                std::memcpy(input.data() + i, &bits, sizeof(bits));
+            }
+            total_steps += run_one(input.data(), input.size());
+            ++games;
+        }
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("seed %llu: %llu games, %llu steps, %.2f M steps/sec, no divergence\n",
+                static_cast<unsigned long long>(seed), static_cast<unsigned long long>(games),
+                static_cast<unsigned long long>(total_steps), static_cast<double>(total_steps) / elapsed / 1e6);
+    return 0;
+}
+
+#endif
@@ -0,0 +1,278 @@
+#include "BoardEvaluator.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdlib>
+#include <iterator>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CRETRIS_AI_X86 1
+#endif
+
+namespace cretris::ai {
+
+namespace {
+
+static_assert(sizeof(Bitboard::value_type) == sizeof(std::uint16_t), "batch rows are stored as 16-bit words");
+
+constexpr int WIDTH = core::BOARD_WIDTH;
+constexpr int HEIGHT = core::BOARD_HEIGHT;
+constexpr std::uint16_t FULL = core::StandardGeometry::full_row;
+constexpr std::uint16_t LEFT_WALL = 1;                       // column 0's left neighbour, after a shift left
+constexpr std::uint16_t RIGHT_WALL = 1u << (WIDTH - 1);      // column W-1's right neighbour, after a shift right
+constexpr std::uint16_t WALLED_ROW = (1u << (WIDTH + 2)) - 1; // row shifted by one with a wall on each side
+
+void prepare(const BoardBatch &boards, FeatureBatch &features) {
+    features.size = boards.size();
+    features.stride = boards.stride();
+    auto resize = [&](std::vector<std::int16_t> &column, std::size_t count) {
+        column.assign(count, 0);
+    };
+    resize(features.column_heights, features.stride * WIDTH);
+    for (auto *column : {&features.aggregate_height, &features.max_height, &features.holes,
+                         &features.row_transitions, &features.column_transitions, &features.bumpiness,
+                         &features.well_sums}) {
+        resize(*column, features.stride);
+    }
+}
+
+void evaluate_scalar(const BoardBatch &boards, FeatureBatch &features, std::size_t begin) {
+    const std::size_t stride = boards.stride();
+    for (std::size_t b = begin; b < boards.size(); ++b) {
+        std::uint16_t covered = 0;
+        std::uint16_t previous = 0; // the sky is empty
+        int heights[WIDTH] = {};
+        int wells[WIDTH] = {};
+        int aggregate = 0;
+        int max_height = 0;
+        int holes = 0;
+        int row_transitions = 0;
+        int column_transitions = 0;
+        int well_sums = 0;
+        for (int y = 0; y < HEIGHT; ++y) {
+            std::uint16_t row = boards.rows()[static_cast<std::size_t>(y) * stride + b];
+            holes += std::popcount(static_cast<std::uint16_t>(~row & covered & FULL));
+            auto walled = static_cast<std::uint16_t>((row << 1) | 1u | (1u << (WIDTH + 1)));
+            row_transitions += std::popcount(static_cast<std::uint16_t>((walled ^ (walled >> 1)) & (WALLED_ROW >> 1)));
+            column_transitions += std::popcount(static_cast<std::uint16_t>(row ^ previous));
+            previous = row;
+
+            auto neighbours = static_cast<std::uint16_t>(((row << 1) | LEFT_WALL) & ((row >> 1) | RIGHT_WALL));
+            auto well = static_cast<std::uint16_t>(~row & ~covered & neighbours & FULL);
+            covered |= row;
+            aggregate += std::popcount(covered);
+            max_height += covered != 0 ? 1 : 0;
+            for (int c = 0; c < WIDTH; ++c) {
+                heights[c] += (covered >> c) & 1;
+                wells[c] = (well >> c) & 1 ? wells[c] + 1 : 0;
+                well_sums += wells[c];
+            }
+        }
+        column_transitions += std::popcount(static_cast<std::uint16_t>(~previous & FULL)); // the floor is filled
+
+        int bumpiness = 0;
+        for (int c = 0; c < WIDTH; ++c) {
+            features.column_heights[static_cast<std::size_t>(c) * stride + b] = static_cast<std::int16_t>(heights[c]);
+            if (c + 1 < WIDTH) {
+                bumpiness += std::abs(heights[c] - heights[c + 1]);
+            }
+        }
+        features.aggregate_height[b] = static_cast<std::int16_t>(aggregate);
+        features.max_height[b] = static_cast<std::int16_t>(max_height);
+        features.holes[b] = static_cast<std::int16_t>(holes);
+        features.row_transitions[b] = static_cast<std::int16_t>(row_transitions);
+        features.column_transitions[b] = static_cast<std::int16_t>(column_transitions);
+        features.bumpiness[b] = static_cast<std::int16_t>(bumpiness);
+        features.well_sums[b] = static_cast<std::int16_t>(well_sums);
+    }
+}
+
+#ifdef CRETRIS_AI_X86
+
+// 16 boards per iteration, one 16-bit lane each. Popcounts use the nibble
+// lookup (pshufb) and fold byte pairs with maddubs.
+__attribute__((target("avx2"))) inline __m256i popcount16(__m256i v) {
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1,
+                                            2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_nibble = _mm256_set1_epi8(0x0F);
+    __m256i low = _mm256_shuffle_epi8(lookup, _mm256_and_si256(v, low_nibble));
+    __m256i high = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(v, 4), low_nibble));
+    return _mm256_maddubs_epi16(_mm256_add_epi8(low, high), _mm256_set1_epi8(1));
+}
+
+__attribute__((target("avx2"))) std::size_t evaluate_avx2(const BoardBatch &boards, FeatureBatch &features) {
+    const std::size_t stride = boards.stride();
+    const std::size_t blocks = boards.size() / BoardBatch::LANES;
+    const __m256i full = _mm256_set1_epi16(static_cast<short>(FULL));
+    const __m256i one = _mm256_set1_epi16(1);
+    const __m256i walls = _mm256_set1_epi16(static_cast<short>(1u | (1u << (WIDTH + 1))));
+    const __m256i walled_mask = _mm256_set1_epi16(static_cast<short>(WALLED_ROW >> 1));
+    const __m256i left_wall = _mm256_set1_epi16(LEFT_WALL);
+    const __m256i right_wall = _mm256_set1_epi16(static_cast<short>(RIGHT_WALL));
+    const __m256i zero = _mm256_setzero_si256();
+
+    for (std::size_t block = 0; block < blocks; ++block) {
+        const std::size_t b = block * BoardBatch::LANES;
+        __m256i covered = zero;
+        __m256i previous = zero;
+        __m256i heights[WIDTH];
+        __m256i wells[WIDTH];
+        for (int c = 0; c < WIDTH; ++c) {
+            heights[c] = zero;
+            wells[c] = zero;
+        }
+        __m256i aggregate = zero;
+        __m256i max_height = zero;
+        __m256i holes = zero;
+        __m256i row_transitions = zero;
+        __m256i column_transitions = zero;
+        __m256i well_sums = zero;
+
+        for (int y = 0; y < HEIGHT; ++y) {
+            __m256i row = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i *>(boards.rows() + static_cast<std::size_t>(y) * stride + b));
+            holes = _mm256_add_epi16(holes, popcount16(_mm256_and_si256(_mm256_andnot_si256(row, covered), full)));
+            __m256i walled = _mm256_or_si256(_mm256_slli_epi16(row, 1), walls);
+            row_transitions = _mm256_add_epi16(
+                row_transitions,
+                popcount16(_mm256_and_si256(_mm256_xor_si256(walled, _mm256_srli_epi16(walled, 1)), walled_mask)));
+            column_transitions = _mm256_add_epi16(column_transitions, popcount16(_mm256_xor_si256(row, previous)));
+            previous = row;
+
+            __m256i neighbours = _mm256_and_si256(_mm256_or_si256(_mm256_slli_epi16(row, 1), left_wall),
+                                                  _mm256_or_si256(_mm256_srli_epi16(row, 1), right_wall));
+            __m256i well = _mm256_and_si256(_mm256_andnot_si256(_mm256_or_si256(row, covered), neighbours), full);
+            covered = _mm256_or_si256(covered, row);
+            aggregate = _mm256_add_epi16(aggregate, popcount16(covered));
+            // covered != 0 adds one row of stack height: cmpeq gives -1 for empty, so add one and the mask.
+            max_height = _mm256_add_epi16(max_height, _mm256_add_epi16(one, _mm256_cmpeq_epi16(covered, zero)));
+
+            __m256i covered_bits = covered;
+            __m256i well_bits = well;
+            for (int c = 0; c < WIDTH; ++c) {
+                heights[c] = _mm256_add_epi16(heights[c], _mm256_and_si256(covered_bits, one));
+                __m256i in_well = _mm256_sub_epi16(zero, _mm256_and_si256(well_bits, one));
+                wells[c] = _mm256_and_si256(_mm256_add_epi16(wells[c], one), in_well);
+                well_sums = _mm256_add_epi16(well_sums, wells[c]);
+                covered_bits = _mm256_srli_epi16(covered_bits, 1);
+                well_bits = _mm256_srli_epi16(well_bits, 1);
+            }
+        }
+        column_transitions =
+            _mm256_add_epi16(column_transitions, popcount16(_mm256_andnot_si256(previous, full)));
+
+        __m256i bumpiness = zero;
+        for (int c = 0; c < WIDTH; ++c) {
+            _mm256_storeu_si256(
+                reinterpret_cast<__m256i *>(features.column_heights.data() + static_cast<std::size_t>(c) * stride + b),
+                heights[c]);
+            if (c + 1 < WIDTH) {
+                bumpiness = _mm256_add_epi16(bumpiness, _mm256_abs_epi16(_mm256_sub_epi16(heights[c], heights[c + 1])));
+            }
+        }
+        std::int16_t *columns[] = {features.aggregate_height.data(),   features.max_height.data(),
+                                   features.holes.data(),              features.row_transitions.data(),
+                                   features.column_transitions.data(), features.bumpiness.data(),
+                                   features.well_sums.data()};
+        const __m256i values[] = {aggregate, max_height, holes, row_transitions, column_transitions, bumpiness,
+                                  well_sums};
+        for (std::size_t i = 0; i < std::size(values); ++i) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(columns[i] + b), values[i]);
+        }
+    }
+    return blocks * BoardBatch::LANES;
+}
+
+#endif
+
+} // namespace
+
+void BoardBatch::reserve(std::size_t boards) {
+    std::size_t stride = (boards + LANES - 1) / LANES * LANES;
+    if (stride > stride_) {
+        grow(stride);
+    }
+}
+
+std::size_t BoardBatch::push(const Bitboard &board) {
+    if (size_ == stride_) {
+        grow(std::max(LANES, stride_ * 2));
+    }
+    for (int y = 0; y < HEIGHT; ++y) {
+        rows_[static_cast<std::size_t>(y) * stride_ + size_] = board[static_cast<std::size_t>(y)];
+    }
+    return size_++;
+}
+
+Bitboard BoardBatch::board(std::size_t index) const {
+    Bitboard board{};
+    for (int y = 0; y < HEIGHT; ++y) {
+        board[static_cast<std::size_t>(y)] = rows_[static_cast<std::size_t>(y) * stride_ + index];
+    }
+    return board;
+}
+
+void BoardBatch::grow(std::size_t stride) {
+    std::vector<std::uint16_t> rows(stride * HEIGHT, 0);
+    for (int y = 0; y < HEIGHT; ++y) {
+        std::copy_n(rows_.begin() + static_cast<std::ptrdiff_t>(static_cast<std::size_t>(y) * stride_), size_,
+                    rows.begin() + static_cast<std::ptrdiff_t>(static_cast<std::size_t>(y) * stride));
+    }
+    rows_ = std::move(rows);
+    stride_ = stride;
+}
+
+bool backend_available(EvaluatorBackend backend) {
+    switch (backend) {
+    case EvaluatorBackend::Auto:
+    case EvaluatorBackend::Scalar:
+        return true;
+    case EvaluatorBackend::Avx2:
+#ifdef CRETRIS_AI_X86
+        return __builtin_cpu_supports("avx2");
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+const char *backend_name(EvaluatorBackend backend) {
+    switch (backend) {
+    case EvaluatorBackend::Auto:
+        return backend_available(EvaluatorBackend::Avx2) ? "avx2" : "scalar";
+    case EvaluatorBackend::Scalar:
+        return "scalar";
+    case EvaluatorBackend::Avx2:
+        return "avx2";
+    }
+    return "unknown";
+}
+
+void evaluate(const BoardBatch &boards, FeatureBatch &features, EvaluatorBackend backend) {
+    prepare(boards, features);
+    std::size_t done = 0;
+#ifdef CRETRIS_AI_X86
+    if (backend != EvaluatorBackend::Scalar && backend_available(EvaluatorBackend::Avx2)) {
+        done = evaluate_avx2(boards, features);
+    }
+#else
+    (void)backend;
+#endif
+    evaluate_scalar(boards, features, done); // the tail that does not fill a whole vector
+}
+
+void score(const FeatureBatch &features, const Weights &weights, const float *landing_height,
+           const float *eroded_cells, std::vector<float> &out) {
+    out.resize(features.size);
+    for (std::size_t b = 0; b < features.size; ++b) {
+        out[b] = weights.landing_height * landing_height[b] + weights.eroded_cells * eroded_cells[b] +
+                 weights.row_transitions * features.row_transitions[b] +
+                 weights.column_transitions * features.column_transitions[b] + weights.holes * features.holes[b] +
+                 weights.well_sums * features.well_sums[b] + weights.aggregate_height * features.aggregate_height[b] +
+                 weights.bumpiness * features.bumpiness[b];
+    }
+}
+
+} // namespace cretris::ai
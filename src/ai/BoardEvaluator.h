@@ -0,0 +1,80 @@
+#pragma once
+
+#include "Placement.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace cretris::ai {
+
+// Many boards stored structure-of-arrays: row y of board b lives at
+// rows[y * stride + b], so one vector load reads the same row of 16 boards.
+class BoardBatch {
+public:
+    static constexpr std::size_t LANES = 16;
+
+    void clear() noexcept { size_ = 0; }
+    void reserve(std::size_t boards);
+    std::size_t push(const Bitboard &board); // returns the board's index
+
+    std::size_t size() const noexcept { return size_; }
+    std::size_t stride() const noexcept { return stride_; }
+    const std::uint16_t *rows() const noexcept { return rows_.data(); }
+    Bitboard board(std::size_t index) const;
+
+private:
+    void grow(std::size_t stride);
+
+    std::vector<std::uint16_t> rows_{};
+    std::size_t stride_{0}; // capacity, always a multiple of LANES
+    std::size_t size_{0};
+};
+
+// Per-board features, also structure-of-arrays. Heights are column-major:
+// column c of board b is column_heights[c * stride + b].
+struct FeatureBatch {
+    std::size_t size{0};
+    std::size_t stride{0};
+    std::vector<std::int16_t> column_heights{};
+    std::vector<std::int16_t> aggregate_height{};
+    std::vector<std::int16_t> max_height{};
+    std::vector<std::int16_t> holes{};              // empty cells with a filled cell somewhere above
+    std::vector<std::int16_t> row_transitions{};    // filled/empty changes along rows, walls count as filled
+    std::vector<std::int16_t> column_transitions{}; // changes down columns, the floor counts as filled
+    std::vector<std::int16_t> bumpiness{};          // sum of |height difference| between neighbouring columns
+    std::vector<std::int16_t> well_sums{};          // 1 + 2 + ... + depth over every open well
+};
+
+// Linear weights over the features. The defaults are the El-Tetris fit of
+// Dellacherie's evaluation; landing height and eroded cells are placement
+// properties, passed alongside the batch.
+struct Weights {
+    float landing_height{-4.500158825082766f};
+    float eroded_cells{3.4181268101392694f};
+    float row_transitions{-3.2178882868487753f};
+    float column_transitions{-9.348695305445199f};
+    float holes{-7.899265427351652f};
+    float well_sums{-3.3855972247263626f};
+    float aggregate_height{0.0f};
+    float bumpiness{0.0f};
+};
+
+enum class EvaluatorBackend {
+    Auto,   // AVX2 when the CPU has it, scalar otherwise
+    Scalar,
+    Avx2,
+};
+
+bool backend_available(EvaluatorBackend backend);
+const char *backend_name(EvaluatorBackend backend);
+
+// Fills `features` for every board in `boards`. Asking for a backend the CPU
+// lacks falls back to scalar.
+void evaluate(const BoardBatch &boards, FeatureBatch &features, EvaluatorBackend backend = EvaluatorBackend::Auto);
+
+// Combines features with the per-board landing height and eroded cells.
+void score(const FeatureBatch &features, const Weights &weights, const float *landing_height,
+           const float *eroded_cells, std::vector<float> &out);
+
+} // namespace cretris::ai
@@ -0,0 +1,257 @@
+#include "HintEngine.h"
+
+#include <bit>
+#include <cstdlib>
+#include <limits>
+
+namespace cretris::ai {
+
+namespace {
+
+constexpr int TYPES = static_cast<int>(core::TetrominoType::Count);
+constexpr std::uint8_t FULL_BAG = (1u << TYPES) - 1;
+constexpr int ROTATIONS = static_cast<int>(core::Rotation::Count);
+constexpr std::size_t MAX_DROPS = ROTATIONS * core::BOARD_WIDTH;
+
+// Heuristic the rollout policy steers by (Yiyuan Lee's weights). Zero for an
+// empty board, more negative the worse the stack.
+float evaluate(const Bitboard &board) {
+    int aggregate = 0;
+    int holes = 0;
+    std::array<int, core::BOARD_WIDTH> heights{};
+    core::Game::RowWord covered = 0;
+    for (int y = 0; y < core::BOARD_HEIGHT; ++y) {
+        auto row = board[static_cast<std::size_t>(y)];
+        holes += std::popcount(static_cast<core::Game::RowWord>(covered & ~row));
+        for (auto fresh = static_cast<core::Game::RowWord>(row & ~covered); fresh; fresh &= fresh - 1) {
+            heights[static_cast<std::size_t>(std::countr_zero(fresh))] = core::BOARD_HEIGHT - y;
+            aggregate += core::BOARD_HEIGHT - y;
+        }
+        covered |= row;
+    }
+    int bumpiness = 0;
+    for (std::size_t x = 1; x < heights.size(); ++x) {
+        bumpiness += std::abs(heights[x] - heights[x - 1]);
+    }
+    return -0.510066f * static_cast<float>(aggregate) - 0.35663f * static_cast<float>(holes) -
+           0.184483f * static_cast<float>(bumpiness);
+}
+
+int stack_top(const Bitboard &board) {
+    int y = 0;
+    while (y < core::BOARD_HEIGHT && board[static_cast<std::size_t>(y)] == 0) {
+        ++y;
+    }
+    return y;
+}
+
+// Every rotation and column of `type` dropped straight down from just above
+// the stack. Cheaper than find_placements and good enough to play out a future
+// the rollout is only guessing at anyway.
+std::size_t drops(const Bitboard &board, core::TetrominoType type, std::array<core::Tetromino, MAX_DROPS> &out) {
+    std::size_t count = 0;
+    int top = stack_top(board);
+    for (int r = 0; r < ROTATIONS; ++r) {
+        auto rotation = static_cast<core::Rotation>(r);
+        const auto &mask = core::tetromino_mask(type, rotation);
+        int y = std::max(0, top - mask.height) - mask.min_y;
+        for (int left = 0; left + mask.width <= core::BOARD_WIDTH; ++left) {
+            core::Tetromino piece{type, rotation, {left - mask.min_x, y}};
+            if (!fits(board, piece)) {
+                continue;
+            }
+            for (++piece.position.y; fits(board, piece); ++piece.position.y) {
+            }
+            --piece.position.y;
+            out[count++] = piece;
+        }
+    }
+    return count;
+}
+
+float unit(std::uint64_t draw) { return static_cast<float>(draw >> 40) * 0x1.0p-24f; }
+
+} // namespace
+
+HintEngine::HintEngine() : HintEngine(Options{}) {}
+
+HintEngine::HintEngine(Options options) : options_{options}, tallies_{std::max<std::size_t>(options.threads, 1)} {
+    options_.threads = tallies_.size();
+    options_.rollouts = std::max<std::uint32_t>(options_.rollouts, 1);
+    rounds_per_worker_ = static_cast<std::uint32_t>((options_.rollouts + options_.threads - 1) / options_.threads);
+    for (std::size_t i = 0; i < options_.threads; ++i) {
+        workers_.emplace_back([this, i] { run(i); });
+    }
+}
+
+HintEngine::~HintEngine() {
+    {
+        std::lock_guard lock{mutex_};
+        stopping_ = true;
+        generation_.fetch_add(1, std::memory_order_relaxed); // abandons rollouts in flight
+    }
+    wake_.notify_all();
+    for (auto &worker : workers_) {
+        worker.join();
+    }
+}
+
+void HintEngine::update(const core::Game &game) {
+    const auto &state = game.state();
+    auto drawn = game.randomizer().position();
+    const auto &board = game.occupancy();
+    if (drawn == drawn_ && board == board_ && state.active_piece.type == active_ && state.queue == queue_) {
+        return;
+    }
+    drawn_ = drawn;
+    board_ = board;
+    active_ = state.active_piece.type;
+    queue_ = state.queue;
+
+    candidates_.clear();
+    if (!state.game_over) {
+        find_placements(board_, state.active_piece, candidates_);
+        candidates_.resize(std::min(candidates_.size(), MAX_CANDIDATES));
+    }
+
+    Problem problem;
+    problem.candidates = candidates_;
+    problem.queue.assign(state.queue.begin(), state.queue.end());
+    problem.bag = bag_remaining(game);
+    {
+        std::lock_guard lock{mutex_};
+        problem.generation = generation_.load(std::memory_order_relaxed) + 1;
+        problem_ = std::move(problem);
+        generation_.store(problem_.generation, std::memory_order_release);
+    }
+    wake_.notify_all();
+}
+
+std::optional<Hint> HintEngine::best() const {
+    auto generation = generation_.load(std::memory_order_acquire);
+    std::array<float, MAX_CANDIDATES> sums{};
+    std::uint32_t rounds = 0;
+    Tally tally;
+    for (std::size_t slot = 0; slot < tallies_.size(); ++slot) {
+        tallies_.read(slot, tally);
+        if (tally.generation != generation) {
+            continue;
+        }
+        rounds += tally.rounds;
+        for (std::size_t i = 0; i < candidates_.size(); ++i) {
+            sums[i] += tally.sums[i];
+        }
+    }
+    if (rounds == 0 || candidates_.empty()) {
+        return std::nullopt;
+    }
+    auto best = static_cast<std::size_t>(
+        std::max_element(sums.begin(), sums.begin() + static_cast<std::ptrdiff_t>(candidates_.size())) - sums.begin());
+    return Hint{candidates_[best].piece, sums[best] / static_cast<float>(rounds), rounds};
+}
+
+bool HintEngine::refining() const {
+    if (candidates_.empty()) {
+        return false;
+    }
+    auto generation = generation_.load(std::memory_order_acquire);
+    Tally tally;
+    for (std::size_t slot = 0; slot < tallies_.size(); ++slot) {
+        tallies_.read(slot, tally);
+        if (tally.generation != generation || !tally.done) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void HintEngine::run(std::size_t worker) {
+    Problem problem;
+    std::uint64_t key = core::counter_random(options_.seed, worker);
+    std::uint64_t draw = 0;
+    for (;;) {
+        {
+            std::unique_lock lock{mutex_};
+            wake_.wait(lock, [&] { return stopping_ || problem_.generation != problem.generation; });
+            if (stopping_) {
+                return;
+            }
+            problem = problem_;
+        }
+
+        // One round plays every candidate once, so published means always
+        // cover the same number of rollouts per candidate.
+        Tally tally;
+        tally.generation = problem.generation;
+        bool cancelled = false;
+        while (tally.rounds < rounds_per_worker_ && !cancelled) {
+            for (std::size_t i = 0; i < problem.candidates.size(); ++i) {
+                float value = rollout(problem, problem.candidates[i], problem.generation, key, draw);
+                if (generation_.load(std::memory_order_relaxed) != problem.generation) {
+                    cancelled = true;
+                    break;
+                }
+                tally.sums[i] += value;
+            }
+            if (!cancelled) {
+                ++tally.rounds;
+                tally.done = tally.rounds == rounds_per_worker_ ? 1 : 0;
+                tallies_.publish(worker, tally);
+            }
+        }
+    }
+}
+
+float HintEngine::rollout(const Problem &problem, const Placement &candidate, std::uint64_t generation,
+                          std::uint64_t key, std::uint64_t &draw) const {
+    Bitboard board = candidate.result;
+    float points = static_cast<float>(core::StandardRules::line_clear_score(candidate.lines_cleared));
+    std::uint8_t bag = problem.bag;
+    std::array<core::Tetromino, MAX_DROPS> poses;
+    for (int d = 0; d < options_.depth; ++d) {
+        if (generation_.load(std::memory_order_relaxed) != generation) {
+            return 0.0f; // the caller discards it
+        }
+
+        // The queue is known; past it, deal from the bag without replacement.
+        core::TetrominoType type;
+        if (static_cast<std::size_t>(d) < problem.queue.size()) {
+            type = problem.queue[static_cast<std::size_t>(d)];
+        } else {
+            bag = bag ? bag : FULL_BAG;
+            auto pick = core::counter_random(key, draw++) % static_cast<std::uint64_t>(std::popcount(bag));
+            auto left = bag;
+            for (; pick > 0; --pick) {
+                left &= static_cast<std::uint8_t>(left - 1);
+            }
+            type = static_cast<core::TetrominoType>(std::countr_zero(left));
+            bag = static_cast<std::uint8_t>(bag & ~(1u << static_cast<int>(type)));
+        }
+
+        core::Tetromino spawn{type, core::Rotation::R0, {core::Game::spawn_x(), core::Game::spawn_y()}};
+        std::size_t count = fits(board, spawn) ? drops(board, type, poses) : 0;
+        if (count == 0) {
+            return points + options_.top_out_penalty;
+        }
+
+        std::size_t chosen = 0;
+        if (unit(core::counter_random(key, draw++)) < options_.epsilon) {
+            chosen = core::counter_random(key, draw++) % count;
+        } else {
+            float best = -std::numeric_limits<float>::infinity();
+            for (std::size_t i = 0; i < count; ++i) {
+                Bitboard after = board;
+                int lines = ai::lock(after, poses[i]);
+                float value = evaluate(after) + 0.760666f * static_cast<float>(lines);
+                if (value > best) {
+                    best = value;
+                    chosen = i;
+                }
+            }
+        }
+        points += static_cast<float>(core::StandardRules::line_clear_score(ai::lock(board, poses[chosen])));
+    }
+    return points + options_.terminal_weight * evaluate(board);
+}
+
+} // namespace cretris::ai
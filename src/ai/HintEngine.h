@@ -0,0 +1,98 @@
+#pragma once
+
+#include "Placement.h"
+#include "../runtime/SeqlockTable.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace cretris::ai {
+
+struct Hint {
+    core::Tetromino piece{}; // resting pose, as a Placement's
+    float value{0};          // mean rollout return
+    std::uint32_t rollouts{0};
+};
+
+// Monte Carlo placement hints. Every reachable placement of the active piece
+// is played out many times by worker threads: the pieces after it come from
+// the queue, then from what the current 7-bag still holds, then from fresh
+// bags, each rollout dealing its own shuffle. Workers publish running totals
+// to seqlock slots, so best() never waits on them and sharpens as rollouts
+// land. A new piece bumps the generation, which abandons rollouts in flight.
+class HintEngine {
+public:
+    static constexpr std::size_t MAX_CANDIDATES = 128;
+
+    struct Options {
+        std::size_t threads{std::max(2u, std::thread::hardware_concurrency()) - 1}; // leaves a core to the game
+        int depth{8};                      // pieces placed after the candidate
+        std::uint32_t rollouts{256};       // per candidate before the hint settles
+        float epsilon{0.1f};               // chance a rollout places a piece at random
+        float terminal_weight{25.0f};      // points per unit of the final board's evaluation
+        float top_out_penalty{-4000.0f};
+        std::uint64_t seed{0x68696e74};
+    };
+
+    HintEngine();
+    explicit HintEngine(Options options);
+    ~HintEngine();
+
+    HintEngine(const HintEngine &) = delete;
+    HintEngine &operator=(const HintEngine &) = delete;
+
+    // Restarts the rollouts when a new piece has spawned; cheap otherwise.
+    void update(const core::Game &game);
+    // The best placement so far for the current piece, if any rollout finished.
+    std::optional<Hint> best() const;
+    // True until every worker has finished its share for the current piece.
+    bool refining() const;
+
+private:
+    struct Problem {
+        std::uint64_t generation{0};
+        std::vector<Placement> candidates{};
+        std::vector<core::TetrominoType> queue{};
+        std::uint8_t bag{0};
+    };
+
+    // One worker's totals for one generation.
+    struct Tally {
+        std::uint64_t generation{0};
+        std::uint32_t rounds{0}; // rollouts of every candidate
+        std::uint32_t done{0};
+        std::array<float, MAX_CANDIDATES> sums{};
+    };
+
+    void run(std::size_t worker);
+    float rollout(const Problem &problem, const Placement &candidate, std::uint64_t generation, std::uint64_t key,
+                  std::uint64_t &draw) const;
+
+    Options options_;
+    std::uint32_t rounds_per_worker_{0};
+
+    // Main thread's view of the position being hinted.
+    Bitboard board_{};
+    std::uint64_t drawn_{~std::uint64_t{0}}; // randomizer position, which moves with every spawn
+    core::TetrominoType active_{};
+    decltype(core::GameState::queue) queue_{};
+    std::vector<Placement> candidates_{};
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    Problem problem_{};
+    bool stopping_{false};
+    std::atomic<std::uint64_t> generation_{0};
+    runtime::SeqlockTable<Tally> tallies_;
+    std::vector<std::thread> workers_{};
+};
+
+} // namespace cretris::ai
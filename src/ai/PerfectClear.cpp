@@ -0,0 +1,386 @@
+#include "PerfectClear.h"
+
+#include "../runtime/ThreadPool.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdlib>
+#include <limits>
+#include <unordered_map>
+
+namespace cretris::ai {
+
+namespace {
+
+using RowWord = core::Game::RowWord;
+
+constexpr int MAX_HEIGHT = 6; // 60 bits of board in a memo key
+constexpr int TYPES = static_cast<int>(core::TetrominoType::Count);
+constexpr std::uint8_t FULL_BAG = (1u << TYPES) - 1;
+constexpr RowWord EVEN_COLUMNS = 0b0101010101;
+constexpr std::size_t NO_TASK = std::numeric_limits<std::size_t>::max();
+
+constexpr std::uint8_t type_bit(core::TetrominoType type) {
+    return static_cast<std::uint8_t>(1u << static_cast<int>(type));
+}
+
+const RowWord &bottom_row(const Bitboard &board, int r) {
+    return board[static_cast<std::size_t>(core::BOARD_HEIGHT - 1 - r)];
+}
+
+int stack_height(const Bitboard &board) {
+    for (int r = MAX_HEIGHT; r < core::BOARD_HEIGHT; ++r) {
+        if (bottom_row(board, r)) {
+            return core::BOARD_HEIGHT;
+        }
+    }
+    int height = 0;
+    for (int r = 0; r < MAX_HEIGHT; ++r) {
+        if (bottom_row(board, r)) {
+            height = r + 1;
+        }
+    }
+    return height;
+}
+
+// Bottom MAX_HEIGHT rows, ten bits each; everything above is empty while searching.
+std::uint64_t pack(const Bitboard &board) {
+    std::uint64_t packed = 0;
+    for (int r = 0; r < MAX_HEIGHT; ++r) {
+        packed |= std::uint64_t{bottom_row(board, r)} << (r * core::BOARD_WIDTH);
+    }
+    return packed;
+}
+
+int cells_below(const Bitboard &board, int limit) {
+    int cells = 0;
+    for (int r = 0; r < limit; ++r) {
+        cells += std::popcount(bottom_row(board, r));
+    }
+    return cells;
+}
+
+// Every column ends up filled `limit` times over, and cleared rows are five
+// and five, so the pieces still to come must cover exactly the empty cells of
+// each column. Per piece the even-minus-odd column count is 0 for O, S and Z,
+// +-2 for J and L, 0 or +-2 for T and 0 or +-4 for I.
+bool parity_feasible(const Bitboard &board, int limit, const std::vector<core::TetrominoType> &sequence,
+                     int depth, int needed) {
+    int balance = 0;
+    for (int r = 0; r < limit; ++r) {
+        auto empty = static_cast<RowWord>(~bottom_row(board, r) & core::StandardGeometry::full_row);
+        balance += std::popcount(static_cast<RowWord>(empty & EVEN_COLUMNS)) -
+                   std::popcount(static_cast<RowWord>(empty & ~EVEN_COLUMNS));
+    }
+    int reach = 0;
+    int fixed_twos = 0;
+    bool flexible = false;
+    for (int i = depth; i < depth + needed; ++i) {
+        if (i >= static_cast<int>(sequence.size())) {
+            reach += 4; // unknown piece: anything an I or a T could do
+            flexible = true;
+            continue;
+        }
+        switch (sequence[static_cast<std::size_t>(i)]) {
+        case core::TetrominoType::I:
+            reach += 4;
+            break;
+        case core::TetrominoType::T:
+            reach += 2;
+            flexible = true;
+            break;
+        case core::TetrominoType::J:
+        case core::TetrominoType::L:
+            reach += 2;
+            ++fixed_twos;
+            break;
+        default:
+            break;
+        }
+    }
+    if (std::abs(balance) > reach) {
+        return false;
+    }
+    return flexible || ((balance / 2 - fixed_twos) & 1) == 0;
+}
+
+// Rows below a piece's position its cells reach, over every rotation.
+int reach_below(core::TetrominoType type) {
+    int reach = 0;
+    for (int r = 0; r < static_cast<int>(core::Rotation::Count); ++r) {
+        const auto &mask = core::tetromino_mask(type, static_cast<core::Rotation>(r));
+        reach = std::max(reach, mask.min_y + mask.height - 1);
+    }
+    return reach;
+}
+
+// Everything above `limit` is empty, so every pose the spawn could reach is
+// also reachable from one just clear of the stack; starting there keeps the
+// flood to the rows that matter.
+core::Tetromino search_start(core::TetrominoType type, int limit) {
+    static const auto reach = [] {
+        std::array<int, TYPES> table{};
+        for (int t = 0; t < TYPES; ++t) {
+            table[static_cast<std::size_t>(t)] = reach_below(static_cast<core::TetrominoType>(t));
+        }
+        return table;
+    }();
+    int y = core::BOARD_HEIGHT - limit - 1 - reach[static_cast<std::size_t>(type)];
+    return core::Tetromino{type, core::Rotation::R0, {core::Game::spawn_x(), std::max(y, core::Game::spawn_y())}};
+}
+
+struct Task {
+    int height{0};
+    Placement root{};
+};
+
+struct Shared {
+    const PerfectClearProblem *problem{nullptr};
+    std::vector<core::TetrominoType> sequence{}; // active piece, then the queue
+    std::vector<Task> tasks{};
+    int max_pieces{0};
+    std::chrono::steady_clock::time_point deadline{};
+    std::atomic<std::size_t> next{0};
+    std::atomic<std::size_t> best{NO_TASK}; // lowest task index known to succeed
+    std::atomic<bool> timed_out{false};
+};
+
+} // namespace
+
+struct PerfectClearSolver::Worker {
+    struct Key {
+        std::uint64_t board{0};
+        std::uint8_t depth{0};
+        std::uint8_t limit{0};
+        std::uint8_t bag{0};
+        bool operator==(const Key &) const = default;
+    };
+    struct KeyHash {
+        std::size_t operator()(const Key &key) const noexcept {
+            return static_cast<std::size_t>(
+                core::counter_random(key.board, key.depth | (key.limit << 8) | (key.bag << 16)));
+        }
+    };
+
+    void run(Shared &shared) {
+        shared_ = &shared;
+        memo_.clear();
+        nodes_ = 0;
+        task_ = NO_TASK;
+        placements_.resize(static_cast<std::size_t>(shared.max_pieces) + 1);
+        path_.assign(shared.sequence.size(), core::Tetromino{});
+        while (true) {
+            std::size_t index = shared.next.fetch_add(1, std::memory_order_relaxed);
+            if (index >= shared.tasks.size() || index > shared.best.load(std::memory_order_relaxed)) {
+                return;
+            }
+            current_ = index;
+            aborted_ = false;
+            const Task &task = shared.tasks[index];
+            if (search(task.root.result, 1, task.height - task.root.lines_cleared, shared.problem->bag_remaining) &&
+                !aborted_) {
+                path_[0] = task.root.piece;
+                solution_ = path_;
+                task_ = index;
+                std::size_t best = shared.best.load(std::memory_order_relaxed);
+                while (index < best && !shared.best.compare_exchange_weak(best, index, std::memory_order_relaxed)) {
+                }
+                return;
+            }
+            if (shared.timed_out.load(std::memory_order_relaxed)) {
+                return;
+            }
+        }
+    }
+
+    bool should_stop() {
+        if (shared_->best.load(std::memory_order_relaxed) < current_ ||
+            shared_->timed_out.load(std::memory_order_relaxed)) {
+            return true;
+        }
+        if (std::chrono::steady_clock::now() >= shared_->deadline) {
+            shared_->timed_out.store(true, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    bool search(const Bitboard &board, int depth, int limit, std::uint8_t bag) {
+        if (limit == 0) {
+            return true; // nothing below the limit and nothing above it
+        }
+        if (aborted_ || ((++nodes_ & 15) == 0 && should_stop())) {
+            aborted_ = true;
+            return false;
+        }
+        int needed = (limit * core::BOARD_WIDTH - cells_below(board, limit)) / 4;
+        if (depth + needed > shared_->max_pieces ||
+            !parity_feasible(board, limit, shared_->sequence, depth, needed)) {
+            return false;
+        }
+
+        Key key{pack(board), static_cast<std::uint8_t>(depth), static_cast<std::uint8_t>(limit), bag};
+        if (auto found = memo_.find(key); found != memo_.end()) {
+            return found->second;
+        }
+
+        bool known = depth < static_cast<int>(shared_->sequence.size());
+        bool solved = true;
+        if (known) {
+            solved = place(shared_->sequence[static_cast<std::size_t>(depth)], board, depth, limit, bag);
+        } else {
+            // The bag deals any piece it still holds, so every one of them needs an answer.
+            std::uint8_t holding = bag ? bag : FULL_BAG;
+            for (int t = 0; t < TYPES && solved; ++t) {
+                auto type = static_cast<core::TetrominoType>(t);
+                if (holding & type_bit(type)) {
+                    solved = place(type, board, depth, limit, static_cast<std::uint8_t>(holding & ~type_bit(type)));
+                }
+            }
+        }
+        if (aborted_) {
+            return false;
+        }
+        // Successes on the known prefix are not cached: they end the search and
+        // the path has to be filled in on the way back up.
+        if (!solved || !known) {
+            memo_.emplace(key, solved);
+        }
+        return solved;
+    }
+
+    bool place(core::TetrominoType type, const Bitboard &board, int depth, int limit, std::uint8_t bag) {
+        auto &candidates = placements_[static_cast<std::size_t>(depth)];
+        find_placements(board, search_start(type, limit), candidates);
+        seen_.clear();
+        for (const Placement &placement : candidates) {
+            const auto &mask = core::tetromino_mask(placement.piece.type, placement.piece.rotation);
+            if (placement.piece.position.y + mask.min_y < core::BOARD_HEIGHT - limit) {
+                continue;
+            }
+            std::uint64_t packed = pack(placement.result);
+            if (std::find(seen_.begin(), seen_.end(), packed) != seen_.end()) {
+                continue; // same cells as a pose already tried
+            }
+            seen_.push_back(packed);
+            if (search(placement.result, depth + 1, limit - placement.lines_cleared, bag)) {
+                if (depth < static_cast<int>(path_.size())) {
+                    path_[static_cast<std::size_t>(depth)] = placement.piece;
+                }
+                return true;
+            }
+            if (aborted_) {
+                return false;
+            }
+        }
+        return false;
+    }
+
+    Shared *shared_{nullptr};
+    std::unordered_map<Key, bool, KeyHash> memo_{};
+    std::vector<std::vector<Placement>> placements_{}; // candidates per depth
+    std::vector<std::uint64_t> seen_{};
+    std::vector<core::Tetromino> path_{};
+    std::vector<core::Tetromino> solution_{};
+    std::size_t current_{NO_TASK};
+    std::size_t task_{NO_TASK}; // task `solution_` belongs to
+    std::uint64_t nodes_{0};
+    bool aborted_{false};
+};
+
+PerfectClearProblem PerfectClearProblem::from(const core::Game &game) {
+    const auto &state = game.state();
+    PerfectClearProblem problem;
+    problem.board = game.occupancy();
+    problem.active = state.active_piece;
+    problem.queue.assign(state.queue.begin(), state.queue.end());
+    problem.bag_remaining = ai::bag_remaining(game);
+    return problem;
+}
+
+PerfectClearSolver::PerfectClearSolver() : PerfectClearSolver(Options{}) {}
+
+PerfectClearSolver::PerfectClearSolver(Options options) : options_{options} {
+    options_.max_height = std::clamp(options_.max_height, 1, MAX_HEIGHT);
+    options_.threads = std::max<std::size_t>(options_.threads, 1);
+    if (options_.threads > 1) {
+        pool_ = std::make_unique<runtime::ThreadPool>(options_.threads - 1);
+    }
+    for (std::size_t i = 0; i < options_.threads; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+}
+
+PerfectClearSolver::~PerfectClearSolver() = default;
+
+PerfectClearResult PerfectClearSolver::solve(const PerfectClearProblem &problem,
+                                             std::chrono::steady_clock::time_point deadline) {
+    PerfectClearResult result;
+    int height = stack_height(problem.board);
+    if (height > options_.max_height) {
+        return result;
+    }
+
+    Shared shared;
+    shared.problem = &problem;
+    shared.sequence.push_back(problem.active.type);
+    shared.sequence.insert(shared.sequence.end(), problem.queue.begin(), problem.queue.end());
+    shared.max_pieces = options_.max_pieces;
+    shared.deadline = deadline;
+
+    // One task per clear height and distinct first placement, lowest heights first.
+    int cells = cells_below(problem.board, height);
+    std::vector<Placement> roots;
+    find_placements(problem.board, problem.active, roots);
+    for (int h = std::max(height, 1); h <= options_.max_height; ++h) {
+        int empty = h * core::BOARD_WIDTH - cells;
+        if (empty % 4 != 0 || empty / 4 > options_.max_pieces ||
+            !parity_feasible(problem.board, h, shared.sequence, 0, empty / 4)) {
+            continue;
+        }
+        std::vector<std::uint64_t> seen;
+        for (const Placement &root : roots) {
+            const auto &mask = core::tetromino_mask(root.piece.type, root.piece.rotation);
+            std::uint64_t packed = pack(root.result);
+            if (root.piece.position.y + mask.min_y < core::BOARD_HEIGHT - h ||
+                std::find(seen.begin(), seen.end(), packed) != seen.end()) {
+                continue;
+            }
+            seen.push_back(packed);
+            shared.tasks.push_back(Task{h, root});
+        }
+    }
+
+    auto run = [&](std::size_t begin, std::size_t end) {
+        for (std::size_t w = begin; w < end; ++w) {
+            workers_[w]->run(shared);
+        }
+    };
+    if (pool_) {
+        pool_->parallel_for(workers_.size(), run);
+    } else {
+        run(0, workers_.size());
+    }
+
+    std::size_t best = shared.best.load();
+    for (const auto &worker : workers_) {
+        result.nodes += worker->nodes_;
+        if (best != NO_TASK && worker->task_ == best) {
+            const Task &task = shared.tasks[best];
+            result.status = PerfectClearStatus::Found;
+            result.lines = task.height;
+            result.pieces = (task.height * core::BOARD_WIDTH - cells) / 4;
+            result.placements.assign(worker->solution_.begin(),
+                                     worker->solution_.begin() +
+                                         std::min<std::ptrdiff_t>(result.pieces, std::ssize(worker->solution_)));
+        }
+    }
+    if (best == NO_TASK && shared.timed_out.load()) {
+        result.status = PerfectClearStatus::TimedOut;
+    }
+    return result;
+}
+
+} // namespace cretris::ai
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Placement.h"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace cretris::runtime {
+class ThreadPool;
+}
+
+namespace cretris::ai {
+
+// Pieces the solver may plan with: the active piece and the visible queue in
+// order, then whatever the 7-bag can still deal. Beyond the queue the next
+// piece is any type left in the current bag (any type once it is used up), so
+// a solution there has to work for every piece the bag could deal.
+struct PerfectClearProblem {
+    Bitboard board{};
+    core::Tetromino active{};
+    std::vector<core::TetrominoType> queue{};
+    std::uint8_t bag_remaining{0}; // bit t: type t still in the bag after the queue; 0 = fresh bag
+
+    static PerfectClearProblem from(const core::Game &game);
+};
+
+enum class PerfectClearStatus : std::uint8_t {
+    Found,      // `placements` leads to an empty board
+    Impossible, // no perfect clear within the piece and height limits
+    TimedOut,   // the deadline passed before either was established
+};
+
+struct PerfectClearResult {
+    PerfectClearStatus status{PerfectClearStatus::Impossible};
+    // Resting poses for the active piece and the queued pieces that follow it,
+    // as far as the solution uses known pieces.
+    std::vector<core::Tetromino> placements{};
+    int pieces{0}; // pieces the perfect clear takes
+    int lines{0};  // rows it clears
+    std::uint64_t nodes{0};
+};
+
+// Depth-first search for a line-clear sequence that empties the board. Every
+// candidate clear height h fixes the piece count ((10h - cells) / 4) and caps
+// placements at h rows, column parity rules out boards the remaining pieces
+// cannot balance, and boards already proven dead are memoised per worker. The
+// placements of the active piece are shared out across threads.
+class PerfectClearSolver {
+public:
+    struct Options {
+        int max_pieces{core::QUEUE_SIZE + 2}; // the queue plus one piece the bag has to guarantee
+        int max_height{4}; // at most 6 rows
+        std::size_t threads{1};
+    };
+
+    PerfectClearSolver();
+    explicit PerfectClearSolver(Options options);
+    ~PerfectClearSolver();
+
+    PerfectClearSolver(const PerfectClearSolver &) = delete;
+    PerfectClearSolver &operator=(const PerfectClearSolver &) = delete;
+
+    PerfectClearResult solve(const PerfectClearProblem &problem, std::chrono::steady_clock::time_point deadline);
+
+    const Options &options() const noexcept { return options_; }
+
+private:
+    struct Worker;
+
+    Options options_;
+    std::unique_ptr<runtime::ThreadPool> pool_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+};
+
+} // namespace cretris::ai
@@ -0,0 +1,207 @@
+#include "Placement.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace cretris::ai {
+
+namespace {
+
+constexpr int X_MIN = -2;
+constexpr int X_SPAN = core::BOARD_WIDTH + 4;
+constexpr int Y_MIN = -2;
+constexpr int Y_SPAN = core::BOARD_HEIGHT + 4;
+constexpr int ROTATIONS = static_cast<int>(core::Rotation::Count);
+constexpr int NODE_COUNT = ROTATIONS * X_SPAN * Y_SPAN;
+constexpr int NO_PARENT = -1;
+
+constexpr std::array<core::InputAction, 5> MOVES = {core::InputAction::MoveLeft, core::InputAction::MoveRight,
+                                                    core::InputAction::RotateCW, core::InputAction::RotateCCW,
+                                                    core::InputAction::SoftDrop};
+
+int node_of(const core::Tetromino &piece) {
+    int x = piece.position.x - X_MIN;
+    int y = piece.position.y - Y_MIN;
+    if (x < 0 || x >= X_SPAN || y < 0 || y >= Y_SPAN) {
+        return -1;
+    }
+    return (static_cast<int>(piece.rotation) * Y_SPAN + y) * X_SPAN + x;
+}
+
+core::Tetromino apply_move(core::Tetromino piece, core::InputAction move) {
+    constexpr auto count = static_cast<std::size_t>(core::Rotation::Count);
+    switch (move) {
+    case core::InputAction::MoveLeft:
+        --piece.position.x;
+        break;
+    case core::InputAction::MoveRight:
+        ++piece.position.x;
+        break;
+    case core::InputAction::SoftDrop:
+        ++piece.position.y;
+        break;
+    case core::InputAction::RotateCW:
+        piece.rotation = static_cast<core::Rotation>((static_cast<std::size_t>(piece.rotation) + 1) % count);
+        break;
+    case core::InputAction::RotateCCW:
+        piece.rotation = static_cast<core::Rotation>((static_cast<std::size_t>(piece.rotation) + count - 1) % count);
+        break;
+    default:
+        break;
+    }
+    return piece;
+}
+
+struct Search {
+    std::array<std::int16_t, NODE_COUNT> parent{};
+    std::array<std::uint8_t, NODE_COUNT> via{};
+    std::vector<core::Tetromino> frontier{};
+    // What the tables above were last flooded from, so plan_actions right after
+    // find_placements on the same position can reuse them.
+    Bitboard board{};
+    core::Tetromino start{};
+    bool valid{false};
+
+    bool flooded_from(const Bitboard &b, const core::Tetromino &s) const {
+        return valid && s.type == start.type && s.rotation == start.rotation && s.position.x == start.position.x &&
+               s.position.y == start.position.y && b == board;
+    }
+};
+
+// Breadth-first flood over poses; visit(piece) is called for each reachable pose.
+template <typename Visit>
+void flood(const Bitboard &board, const core::Tetromino &start, Search &search, Visit &&visit) {
+    search.parent.fill(static_cast<std::int16_t>(NO_PARENT - 1));
+    search.frontier.clear();
+    search.board = board;
+    search.start = start;
+    search.valid = true;
+    int start_node = node_of(start);
+    if (start_node < 0 || !fits(board, start)) {
+        return;
+    }
+    search.parent[static_cast<std::size_t>(start_node)] = NO_PARENT;
+    search.frontier.push_back(start);
+    for (std::size_t head = 0; head < search.frontier.size(); ++head) {
+        core::Tetromino current = search.frontier[head];
+        visit(current);
+        int current_node = node_of(current);
+        for (std::size_t m = 0; m < MOVES.size(); ++m) {
+            core::Tetromino next = apply_move(current, MOVES[m]);
+            int node = node_of(next);
+            if (node < 0 || search.parent[static_cast<std::size_t>(node)] != NO_PARENT - 1 || !fits(board, next)) {
+                continue;
+            }
+            search.parent[static_cast<std::size_t>(node)] = static_cast<std::int16_t>(current_node);
+            search.via[static_cast<std::size_t>(node)] = static_cast<std::uint8_t>(m);
+            search.frontier.push_back(next);
+        }
+    }
+}
+
+thread_local Search scratch;
+
+} // namespace
+
+bool fits(const Bitboard &board, const core::Tetromino &piece) {
+    const auto &mask = core::tetromino_mask(piece.type, piece.rotation);
+    int left = piece.position.x + mask.min_x;
+    int top = piece.position.y + mask.min_y;
+    if (left < 0 || left + mask.width > core::BOARD_WIDTH || top < 0 || top + mask.height > core::BOARD_HEIGHT) {
+        return false;
+    }
+    for (int r = 0; r < mask.height; ++r) {
+        if (board[static_cast<std::size_t>(top + r)] &
+            (static_cast<core::Game::RowWord>(mask.rows[static_cast<std::size_t>(r)]) << left)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int lock(Bitboard &board, const core::Tetromino &piece) {
+    const auto &mask = core::tetromino_mask(piece.type, piece.rotation);
+    int left = piece.position.x + mask.min_x;
+    int top = piece.position.y + mask.min_y;
+    for (int r = 0; r < mask.height; ++r) {
+        board[static_cast<std::size_t>(top + r)] |=
+            static_cast<core::Game::RowWord>(mask.rows[static_cast<std::size_t>(r)] << left);
+    }
+
+    int cleared = 0;
+    int write = core::BOARD_HEIGHT - 1;
+    for (int read = core::BOARD_HEIGHT - 1; read >= 0; --read) {
+        if (board[static_cast<std::size_t>(read)] == core::StandardGeometry::full_row) {
+            ++cleared;
+            continue;
+        }
+        board[static_cast<std::size_t>(write--)] = board[static_cast<std::size_t>(read)];
+    }
+    for (; write >= 0; --write) {
+        board[static_cast<std::size_t>(write)] = 0;
+    }
+    return cleared;
+}
+
+void find_placements(const Bitboard &board, const core::Tetromino &start, std::vector<Placement> &out) {
+    out.clear();
+    flood(board, start, scratch, [&](const core::Tetromino &pose) {
+        core::Tetromino below = pose;
+        ++below.position.y;
+        if (fits(board, below)) {
+            return;
+        }
+        const auto &mask = core::tetromino_mask(pose.type, pose.rotation);
+        int left = pose.position.x + mask.min_x;
+        int top = pose.position.y + mask.min_y;
+        Placement placement{pose, 0, 0, 0.0f, board};
+        for (int r = 0; r < mask.height; ++r) {
+            auto piece_row = static_cast<core::Game::RowWord>(mask.rows[static_cast<std::size_t>(r)] << left);
+            if ((board[static_cast<std::size_t>(top + r)] | piece_row) == core::StandardGeometry::full_row) {
+                placement.eroded_cells += std::popcount(piece_row);
+            }
+        }
+        placement.landing_height = static_cast<float>(core::BOARD_HEIGHT - top) - 0.5f * static_cast<float>(mask.height - 1);
+        placement.lines_cleared = lock(placement.result, pose);
+        placement.eroded_cells *= placement.lines_cleared;
+        out.push_back(placement);
+    });
+}
+
+std::vector<core::InputAction> plan_actions(const Bitboard &board, const core::Tetromino &start,
+                                            const core::Tetromino &target) {
+    std::vector<core::InputAction> actions;
+    if (!scratch.flooded_from(board, start)) {
+        flood(board, start, scratch, [](const core::Tetromino &) {});
+    }
+    int node = node_of(target);
+    if (node < 0 || scratch.parent[static_cast<std::size_t>(node)] == NO_PARENT - 1) {
+        return actions;
+    }
+    actions.push_back(core::InputAction::HardDrop);
+    while (scratch.parent[static_cast<std::size_t>(node)] != NO_PARENT) {
+        actions.push_back(MOVES[scratch.via[static_cast<std::size_t>(node)]]);
+        node = scratch.parent[static_cast<std::size_t>(node)];
+    }
+    std::reverse(actions.begin(), actions.end());
+    return actions;
+}
+
+std::uint8_t bag_remaining(const core::Game &game) {
+    constexpr auto types = static_cast<std::size_t>(core::TetrominoType::Count);
+    const auto &state = game.state();
+    auto drawn = static_cast<std::size_t>(game.randomizer().position() % types);
+    if (drawn == 0) {
+        return 0;
+    }
+    // The most recent draws are the queue's tail; those from the current bag are gone from it.
+    std::vector<core::TetrominoType> known{state.active_piece.type};
+    known.insert(known.end(), state.queue.begin(), state.queue.end());
+    auto remaining = static_cast<std::uint8_t>((1u << types) - 1);
+    for (std::size_t i = known.size() - std::min(drawn, known.size()); i < known.size(); ++i) {
+        remaining = static_cast<std::uint8_t>(remaining & ~(1u << static_cast<std::size_t>(known[i])));
+    }
+    return remaining;
+}
+
+} // namespace cretris::ai
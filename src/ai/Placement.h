@@ -0,0 +1,40 @@
+#pragma once
+
+#include "../core/Game.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace cretris::ai {
+
+// Occupancy of the classic board, one word per row from the top (bit x = column x).
+using Bitboard = std::array<core::Game::RowWord, core::BOARD_HEIGHT>;
+
+struct Placement {
+    core::Tetromino piece{}; // resting pose just before the lock
+    int lines_cleared{0};
+    int eroded_cells{0};     // cells of this piece removed by the clear
+    float landing_height{0}; // height of the piece's centre above the floor
+    Bitboard result{};       // board after the lock and line clear
+};
+
+bool fits(const Bitboard &board, const core::Tetromino &piece);
+
+// Writes the piece into the board, clears full rows and returns how many were cleared.
+int lock(Bitboard &board, const core::Tetromino &piece);
+
+// Every distinct resting pose reachable from `start` with shifts, rotations and
+// soft drops, as core::Game would execute them (no kicks, no gravity).
+void find_placements(const Bitboard &board, const core::Tetromino &start, std::vector<Placement> &out);
+
+// Types still undealt in the current 7-bag, bit t for TetrominoType t, given
+// that the active piece and the queue are the most recent draws. 0 when the
+// bag is used up and the next draw opens a fresh one.
+std::uint8_t bag_remaining(const core::Game &game);
+
+// Input sequence that carries `start` to `target` and hard-drops it; empty if unreachable.
+std::vector<core::InputAction> plan_actions(const Bitboard &board, const core::Tetromino &start,
+                                            const core::Tetromino &target);
+
+} // namespace cretris::ai
@@ -0,0 +1,100 @@
+#include "Planner.h"
+
+namespace cretris::ai {
+
+Planner::Planner() : Planner(Options{}) {}
+
+Planner::Planner(Options options) : options_{options} {
+    if (options_.perfect_clear_budget.count() > 0) {
+        perfect_clear_ = std::make_unique<PerfectClearSolver>(options_.perfect_clear);
+    }
+}
+
+std::optional<Placement> Planner::choose(const core::Game &game) {
+    const auto &state = game.state();
+    if (state.game_over) {
+        return std::nullopt;
+    }
+
+    const Bitboard &board = game.occupancy();
+    find_placements(board, state.active_piece, first_);
+    if (first_.empty()) {
+        return std::nullopt;
+    }
+    if (auto move = perfect_clear_move(game)) {
+        return move;
+    }
+
+    batch_.clear();
+    parent_.clear();
+    landing_.clear();
+    eroded_.clear();
+    auto add = [&](std::size_t first_index, const Placement &placement, float landing, float eroded) {
+        batch_.push(placement.result);
+        parent_.push_back(first_index);
+        landing_.push_back(landing);
+        eroded_.push_back(eroded);
+    };
+
+    bool look_ahead = options_.look_ahead && !state.queue.empty();
+    core::Tetromino spawn{look_ahead ? state.queue.front() : core::TetrominoType::I, core::Rotation::R0,
+                          {core::Game::spawn_x(), core::Game::spawn_y()}};
+    for (std::size_t i = 0; i < first_.size(); ++i) {
+        const Placement &first = first_[i];
+        if (!look_ahead) {
+            add(i, first, first.landing_height, static_cast<float>(first.eroded_cells));
+            continue;
+        }
+        // Placements after which the next piece cannot spawn are never candidates.
+        find_placements(first.result, spawn, second_);
+        for (const Placement &second : second_) {
+            add(i, second, first.landing_height + second.landing_height,
+                static_cast<float>(first.eroded_cells + second.eroded_cells));
+        }
+    }
+    if (batch_.size() == 0) {
+        return first_.front(); // every move tops out; any of them will do
+    }
+
+    evaluate(batch_, features_, options_.backend);
+    score(features_, options_.weights, landing_.data(), eroded_.data(), scores_);
+    boards_evaluated_ += batch_.size();
+
+    std::size_t best = 0;
+    for (std::size_t b = 1; b < scores_.size(); ++b) {
+        if (scores_[b] > scores_[best]) {
+            best = b;
+        }
+    }
+    return first_[parent_[best]];
+}
+
+std::optional<Placement> Planner::perfect_clear_move(const core::Game &game) {
+    if (!perfect_clear_) {
+        return std::nullopt;
+    }
+    auto deadline = std::chrono::steady_clock::now() + options_.perfect_clear_budget;
+    auto result = perfect_clear_->solve(PerfectClearProblem::from(game), deadline);
+    if (result.status != PerfectClearStatus::Found || result.placements.empty()) {
+        return std::nullopt;
+    }
+    const core::Tetromino &target = result.placements.front();
+    for (const Placement &placement : first_) {
+        if (placement.piece.rotation == target.rotation && placement.piece.position.x == target.position.x &&
+            placement.piece.position.y == target.position.y) {
+            ++perfect_clear_moves_;
+            return placement;
+        }
+    }
+    return std::nullopt;
+}
+
+std::vector<core::InputAction> Planner::plan(const core::Game &game) {
+    auto placement = choose(game);
+    if (!placement) {
+        return {};
+    }
+    return plan_actions(game.occupancy(), game.state().active_piece, placement->piece);
+}
+
+} // namespace cretris::ai
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "BoardEvaluator.h"
+#include "PerfectClear.h"
+#include "Placement.h"
+
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace cretris::ai {
+
+// Greedy placement search over a core::Game. Every candidate board (all
+// placements of the active piece, or of the active and the next piece when
+// looking ahead) goes through one BoardEvaluator batch.
+class Planner {
+public:
+    struct Options {
+        Weights weights{};
+        bool look_ahead{true}; // also place the first queued piece
+        EvaluatorBackend backend{EvaluatorBackend::Auto};
+        // When non-zero, a perfect clear found within this time overrides the
+        // evaluator's choice.
+        std::chrono::milliseconds perfect_clear_budget{0};
+        PerfectClearSolver::Options perfect_clear{};
+    };
+
+    Planner();
+    explicit Planner(Options options);
+
+    // Best resting pose for the active piece, or nothing when the game is over.
+    std::optional<Placement> choose(const core::Game &game);
+
+    // Inputs that carry the active piece to choose()'s pose and hard-drop it.
+    std::vector<core::InputAction> plan(const core::Game &game);
+
+    std::size_t boards_evaluated() const noexcept { return boards_evaluated_; }
+    std::size_t perfect_clear_moves() const noexcept { return perfect_clear_moves_; }
+
+private:
+    std::optional<Placement> perfect_clear_move(const core::Game &game);
+
+    Options options_;
+    std::unique_ptr<PerfectClearSolver> perfect_clear_{};
+    std::vector<Placement> first_{};
+    std::vector<Placement> second_{};
+    std::vector<std::size_t> parent_{}; // batch index -> index into first_
+    std::vector<float> landing_{};
+    std::vector<float> eroded_{};
+    std::vector<float> scores_{};
+    BoardBatch batch_{};
+    FeatureBatch features_{};
+    std::size_t boards_evaluated_{0};
+    std::size_t perfect_clear_moves_{0};
+};
+
+} // namespace cretris::ai
@@ -2,26 +2,234 @@
 
 #include "Tetromino.h"
 
+#include <algorithm>
 #include <array>
 #include <chrono>
-#include <deque>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
 
 namespace cretris::core {
 
-constexpr int BOARD_WIDTH = 10;
-constexpr int BOARD_HEIGHT = 20;
-constexpr int QUEUE_SIZE = 5;
-constexpr int LINES_PER_LEVEL = 20;
-constexpr int MAX_LEVEL = 20;
+// Board dimensions. Occupancy is mirrored as one machine word per row, the
+// narrowest unsigned type that holds Width bits.
+template <int Width, int Height>
+struct BoardGeometry {
+    static_assert(Width >= 4 && Width <= 64, "board width must be between 4 and 64 columns");
+    static_assert(Height >= 4, "board height must be at least 4 rows");
 
-struct GameState {
-    std::array<std::array<int, BOARD_WIDTH>, BOARD_HEIGHT> board{}; // -1 empty, else TetrominoType
+    static constexpr int width = Width;
+    static constexpr int height = Height;
+
+    using RowWord = std::conditional_t<(Width <= 16), std::uint16_t,
+                                       std::conditional_t<(Width <= 32), std::uint32_t, std::uint64_t>>;
+    static constexpr RowWord full_row =
+        Width == 64 ? static_cast<RowWord>(~RowWord{0}) : static_cast<RowWord>((std::uint64_t{1} << Width) - 1);
+};
+
+// Scoring, levelling and gravity of the classic game.
+struct StandardRules {
+    static constexpr int queue_size = 5;
+    static constexpr int lines_per_level = 20;
+    static constexpr int max_level = 20;
+    static constexpr int soft_drop_score = 1;
+    static constexpr int hard_drop_score_per_row = 2;
+
+    static constexpr int line_clear_score(int lines) {
+        constexpr std::array<int, 5> scores = {0, 100, 300, 500, 800};
+        if (lines < 0 || static_cast<std::size_t>(lines) >= scores.size()) {
+            return 0;
+        }
+        return scores[static_cast<std::size_t>(lines)];
+    }
+
+    static constexpr std::chrono::milliseconds gravity_interval(int level) {
+        constexpr int base_ms = 500;
+        constexpr int step_ms = 20;
+        constexpr int min_ms = 100;
+        int level_offset = std::max(0, level - 1);
+        return std::chrono::milliseconds{std::max(min_ms, base_ms - level_offset * step_ms)};
+    }
+
+    // Frame-based play (BasicGame::step_frame). Gravity is in G, cells per
+    // frame, as 16.16 fixed point; here it follows the tick interval above.
+    static constexpr int frame_rate = 60;
+    static constexpr int lock_delay_frames = 30;
+
+    static constexpr std::uint32_t gravity(int level) {
+        return static_cast<std::uint32_t>((std::int64_t{1} << 16) * 1000 /
+                                          (frame_rate * gravity_interval(level).count()));
+    }
+};
+
+// Fixed-point G helper: cells_per_frame(1) is 1G, cells_per_frame(1, 60) one row per second.
+constexpr std::uint32_t cells_per_frame(std::uint32_t cells, std::uint32_t frames = 1) {
+    return (cells << 16) / frames;
+}
+
+// Arcade-style curve: levels every 10 lines, gravity climbing to 20G (a piece
+// lands the frame it spawns), and lock delay as the only time left to place it.
+struct MasterRules : StandardRules {
+    static constexpr int lines_per_level = 10;
+
+    static constexpr std::uint32_t gravity(int level) {
+        constexpr std::array<std::uint32_t, 20> curve = {
+            cells_per_frame(1, 60), cells_per_frame(1, 30), cells_per_frame(1, 20), cells_per_frame(1, 10),
+            cells_per_frame(1, 5),  cells_per_frame(1, 3),  cells_per_frame(1, 2),  cells_per_frame(1),
+            cells_per_frame(3, 2),  cells_per_frame(2),     cells_per_frame(3),     cells_per_frame(4),
+            cells_per_frame(5),     cells_per_frame(8),     cells_per_frame(10),    cells_per_frame(12),
+            cells_per_frame(15),    cells_per_frame(18),    cells_per_frame(20),    cells_per_frame(20)};
+        return curve[static_cast<std::size_t>(std::clamp(level, 1, static_cast<int>(curve.size())) - 1)];
+    }
+};
+
+using StandardGeometry = BoardGeometry<10, 20>;
+
+constexpr int BOARD_WIDTH = StandardGeometry::width;
+constexpr int BOARD_HEIGHT = StandardGeometry::height;
+constexpr int QUEUE_SIZE = StandardRules::queue_size;
+constexpr int LINES_PER_LEVEL = StandardRules::lines_per_level;
+constexpr int MAX_LEVEL = StandardRules::max_level;
+
+// Board cell of a garbage row sent by a versus opponent.
+constexpr int GARBAGE_CELL = static_cast<int>(TetrominoType::Count);
+
+// Upcoming pieces, stored inline so game state stays trivially copyable and a
+// snapshot is a plain memcpy.
+template <std::size_t Capacity>
+class PieceQueue {
+public:
+    using value_type = TetrominoType;
+    using const_iterator = const TetrominoType *;
+
+    static constexpr std::size_t capacity() noexcept { return Capacity; }
+    std::size_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+
+    TetrominoType front() const noexcept { return items_[0]; }
+    TetrominoType back() const noexcept { return items_[size_ - 1]; }
+    TetrominoType operator[](std::size_t index) const noexcept { return items_[index]; }
+    const_iterator begin() const noexcept { return items_.data(); }
+    const_iterator end() const noexcept { return items_.data() + size_; }
+
+    void push_back(TetrominoType type) noexcept {
+        if (size_ < Capacity) {
+            items_[size_++] = type;
+        }
+    }
+    void pop_front() noexcept {
+        if (size_ > 0) {
+            std::copy(items_.begin() + 1, items_.begin() + size_, items_.begin());
+            --size_;
+        }
+    }
+    void clear() noexcept { size_ = 0; }
+
+    friend bool operator==(const PieceQueue &a, const PieceQueue &b) noexcept {
+        return std::equal(a.begin(), a.end(), b.begin(), b.end());
+    }
+
+private:
+    std::array<TetrominoType, Capacity> items_{};
+    std::size_t size_{0};
+};
+
+// Bits reported by BasicGame::take_changes(); each change also bumps GameState::version.
+enum StateChange : std::uint32_t {
+    CHANGE_SPAWN = 1u << 0,
+    CHANGE_MOVE = 1u << 1, // shift, rotation or fall of the active piece
+    CHANGE_LOCK = 1u << 2,
+    CHANGE_CLEAR = 1u << 3,
+    CHANGE_LEVEL_UP = 1u << 4,
+    CHANGE_SCORE = 1u << 5,
+    CHANGE_GARBAGE = 1u << 6,
+    CHANGE_GAME_OVER = 1u << 7,
+};
+
+// What happened during a step, for effects that need more than the resulting state.
+enum class GameEventType : std::uint8_t {
+    PieceLocked,  // cells: where the piece landed; value: its TetrominoType
+    LinesCleared, // rows: board rows before they collapsed, bottom first; count: how many
+    HardDrop,     // value: rows fallen
+    LevelChanged, // value: the new level
+    GameOver,
+};
+
+struct GameEvent {
+    struct Cell {
+        std::int16_t x{};
+        std::int16_t y{};
+    };
+
+    GameEventType type{};
+    std::uint8_t count{0};
+    std::int16_t value{0};
+    std::array<Cell, 4> cells{};
+    std::array<std::int16_t, 4> rows{};
+};
+
+// Fixed-capacity ring of events owned by the game. When it is not drained a
+// new event overwrites the oldest one, so a game without listeners never
+// allocates, grows or shifts, and a late reader still sees the latest events.
+template <std::size_t Capacity>
+class EventBuffer {
+public:
+    class const_iterator {
+    public:
+        const_iterator(const EventBuffer *buffer, std::size_t index) noexcept : buffer_{buffer}, index_{index} {}
+        const GameEvent &operator*() const noexcept { return (*buffer_)[index_]; }
+        const GameEvent *operator->() const noexcept { return &(*buffer_)[index_]; }
+        const_iterator &operator++() noexcept {
+            ++index_;
+            return *this;
+        }
+        bool operator==(const const_iterator &other) const noexcept { return index_ == other.index_; }
+
+    private:
+        const EventBuffer *buffer_;
+        std::size_t index_;
+    };
+
+    static constexpr std::size_t capacity() noexcept { return Capacity; }
+    std::size_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+    // Oldest first.
+    const GameEvent &operator[](std::size_t index) const noexcept { return items_[(head_ + index) % Capacity]; }
+    const_iterator begin() const noexcept { return {this, 0}; }
+    const_iterator end() const noexcept { return {this, size_}; }
+
+    void push_back(const GameEvent &event) noexcept {
+        if (size_ == Capacity) {
+            items_[head_] = event;
+            head_ = (head_ + 1) % Capacity;
+            return;
+        }
+        items_[(head_ + size_++) % Capacity] = event;
+    }
+    void clear() noexcept {
+        head_ = 0;
+        size_ = 0;
+    }
+
+private:
+    std::array<GameEvent, Capacity> items_{};
+    std::size_t head_{0};
+    std::size_t size_{0};
+};
+
+// One hard drop that clears lines, levels up and tops out emits five events.
+using GameEvents = EventBuffer<8>;
+
+template <typename Geometry, std::size_t QueueCapacity = StandardRules::queue_size>
+struct BasicGameState {
+    std::array<std::array<int, Geometry::width>, Geometry::height> board{}; // -1 empty, GARBAGE_CELL, else TetrominoType
     Tetromino active_piece{};
-    std::deque<TetrominoType> queue{};
+    PieceQueue<QueueCapacity> queue{};
     int score{0};
     int total_lines{0};
     int level{1};
     bool game_over{false};
+    std::uint64_t version{0}; // increases with every visible change; equal versions mean equal states
 };
 
 enum class InputAction {
@@ -35,17 +243,48 @@ enum class InputAction {
     Quit
 };
 
-class Game {
+template <typename Geometry, typename Rules>
+class BasicGame {
 public:
-    Game();
+    using State = BasicGameState<Geometry, Rules::queue_size>;
+    using RowWord = typename Geometry::RowWord;
+
+    BasicGame();
+    explicit BasicGame(std::uint64_t seed); // same seed, same piece sequence
+    // Resumes a saved game; piece_position is randomizer().position() at the time of the save.
+    BasicGame(const State &state, std::uint64_t seed, std::uint64_t piece_position);
 
-    const GameState &state() const noexcept { return state_; }
+    const State &state() const noexcept { return state_; }
+    const BagRandomizer &randomizer() const noexcept { return randomizer_; }
+    const std::array<RowWord, Geometry::height> &occupancy() const noexcept { return rows_; } // bit x of row y set when filled
 
     void apply_action(InputAction action);
     bool tick(); // gravity tick; returns false on game over
-    std::chrono::milliseconds gravity_interval() const;
+
+    // One frame of frame-based play: applies `action`, then Rules::gravity(level).
+    // Any gravity of a row or more drops the piece straight to its landing row
+    // using the cached drop distance, so 20G costs the same as 1/60G. A landed
+    // piece locks after Rules::lock_delay_frames unless it falls again first.
+    // Returns false on game over.
+    bool step_frame(InputAction action = InputAction::None);
+    int drop_distance(); // rows the active piece can still fall
+    int lock_frames() const noexcept { return lock_frames_; }
+
+    // StateChange bits accumulated since the last call.
+    std::uint32_t take_changes() noexcept { return std::exchange(changes_, 0u); }
+    // Events emitted since the last call, oldest first.
+    GameEvents take_events() noexcept { return std::exchange(events_, GameEvents{}); }
+    const GameEvents &events() const noexcept { return events_; }
+    // Pushes `lines` garbage rows, open at `hole_column`, up from the floor. The
+    // active piece is lifted clear if it can be; otherwise the game is over.
+    void add_garbage(int lines, int hole_column);
+    std::chrono::milliseconds gravity_interval() const { return Rules::gravity_interval(state_.level); }
+
+    static constexpr int spawn_x() { return Geometry::width / 2 - 1; }
+    static constexpr int spawn_y() { return 0; }
 
 private:
+
     bool collides(const Tetromino &tet) const;
     void lock_piece();
     void spawn_piece();
@@ -53,9 +292,337 @@ private:
     void clear_lines();
     void place_active(Tetromino &target, Rotation new_rotation);
     void move_active(int dx, int dy);
+    void mark(std::uint32_t changes) noexcept {
+        ++state_.version;
+        changes_ |= changes;
+    }
+    void emit(GameEventType type, int value = 0) noexcept {
+        GameEvent event;
+        event.type = type;
+        event.value = static_cast<std::int16_t>(value);
+        events_.push_back(event);
+    }
 
-    GameState state_{};
-    BagRandomizer randomizer_{};
+    State state_{};
+    std::array<RowWord, Geometry::height> rows_{}; // occupancy bitboard mirroring state_.board
+    BagRandomizer randomizer_;
+    std::uint32_t gravity_accumulator_{0}; // sub-row progress, 16.16
+    int drop_distance_{-1};                 // -1 when the piece or board changed since it was computed
+    int lock_frames_{0};
+    std::uint32_t changes_{0};
+    GameEvents events_{};
 };
 
+using GameState = BasicGameState<StandardGeometry>;
+using Game = BasicGame<StandardGeometry, StandardRules>;
+using MasterGame = BasicGame<StandardGeometry, MasterRules>;
+
+template <typename Geometry, typename Rules>
+BasicGame<Geometry, Rules>::BasicGame() : BasicGame(BagRandomizer{}.seed()) {}
+
+template <typename Geometry, typename Rules>
+BasicGame<Geometry, Rules>::BasicGame(std::uint64_t seed) : randomizer_{seed} {
+    for (auto &row : state_.board) {
+        row.fill(-1);
+    }
+    state_.active_piece.position = {spawn_x(), spawn_y()};
+    refill_queue();
+    spawn_piece();
+}
+
+template <typename Geometry, typename Rules>
+BasicGame<Geometry, Rules>::BasicGame(const State &state, std::uint64_t seed, std::uint64_t piece_position)
+    : state_{state}, randomizer_{seed} {
+    for (int y = 0; y < Geometry::height; ++y) {
+        for (int x = 0; x < Geometry::width; ++x) {
+            if (state_.board[y][x] >= 0) {
+                rows_[static_cast<std::size_t>(y)] |= static_cast<RowWord>(RowWord{1} << x);
+            }
+        }
+    }
+    randomizer_.seek(piece_position);
+}
+
+template <typename Geometry, typename Rules>
+void BasicGame<Geometry, Rules>::apply_action(InputAction action) {
+    if (state_.game_over) {
+        return;
+    }
+
+    switch (action) {
+    case InputAction::MoveLeft:
+        move_active(-1, 0);
+        break;
+    case InputAction::MoveRight:
+        move_active(1, 0);
+        break;
+    case InputAction::SoftDrop:
+        move_active(0, 1);
+        state_.score += Rules::soft_drop_score;
+        mark(CHANGE_SCORE);
+        break;
+    case InputAction::HardDrop: {
+        int distance = drop_distance();
+        state_.active_piece.position.y += distance;
+        state_.score += (distance + 1) * Rules::hard_drop_score_per_row; // the starting row counts
+        mark(CHANGE_MOVE | CHANGE_SCORE);
+        emit(GameEventType::HardDrop, distance);
+        lock_piece();
+        break;
+    }
+    case InputAction::RotateCW:
+        place_active(state_.active_piece, static_cast<Rotation>((static_cast<std::size_t>(state_.active_piece.rotation) + 1) % static_cast<std::size_t>(Rotation::Count)));
+        break;
+    case InputAction::RotateCCW:
+        place_active(state_.active_piece, static_cast<Rotation>((static_cast<std::size_t>(state_.active_piece.rotation) + static_cast<std::size_t>(Rotation::Count) - 1) % static_cast<std::size_t>(Rotation::Count)));
+        break;
+    case InputAction::Quit:
+    case InputAction::None:
+        break;
+    }
+}
+
+template <typename Geometry, typename Rules>
+bool BasicGame<Geometry, Rules>::tick() {
+    if (state_.game_over) {
+        return false;
+    }
+
+    Tetromino next = state_.active_piece;
+    next.position.y += 1;
+    if (collides(next)) {
+        lock_piece();
+    } else {
+        state_.active_piece = next;
+        drop_distance_ = -1;
+        lock_frames_ = 0;
+        mark(CHANGE_MOVE);
+    }
+
+    return !state_.game_over;
+}
+
+template <typename Geometry, typename Rules>
+int BasicGame<Geometry, Rules>::drop_distance() {
+    if (drop_distance_ < 0) {
+        Tetromino test = state_.active_piece;
+        int distance = -1;
+        do {
+            ++distance;
+            test.position.y += 1;
+        } while (!collides(test));
+        drop_distance_ = distance;
+    }
+    return drop_distance_;
+}
+
+template <typename Geometry, typename Rules>
+bool BasicGame<Geometry, Rules>::step_frame(InputAction action) {
+    if (state_.game_over) {
+        return false;
+    }
+    apply_action(action);
+    if (state_.game_over) {
+        return false;
+    }
+
+    int distance = drop_distance();
+    if (distance > 0) {
+        gravity_accumulator_ += Rules::gravity(state_.level);
+        int rows = static_cast<int>(gravity_accumulator_ >> 16);
+        gravity_accumulator_ &= 0xFFFF;
+        if (rows > 0) {
+            int fall = std::min(rows, distance);
+            state_.active_piece.position.y += fall;
+            drop_distance_ = distance - fall;
+            lock_frames_ = 0;
+            mark(CHANGE_MOVE);
+        }
+    }
+    if (drop_distance_ == 0) {
+        gravity_accumulator_ = 0;
+        if (++lock_frames_ >= Rules::lock_delay_frames) {
+            lock_piece();
+        }
+    }
+    return !state_.game_over;
+}
+
+template <typename Geometry, typename Rules>
+void BasicGame<Geometry, Rules>::add_garbage(int lines, int hole_column) {
+    if (state_.game_over || lines <= 0) {
+        return;
+    }
+    lines = std::min(lines, Geometry::height);
+    hole_column = std::clamp(hole_column, 0, Geometry::width - 1);
+    for (int y = 0; y < lines; ++y) {
+        if (rows_[static_cast<std::size_t>(y)] != 0) {
+            state_.game_over = true; // the stack is pushed out of the top
+        }
+    }
+    for (int y = 0; y + lines < Geometry::height; ++y) {
+        state_.board[y] = state_.board[y + lines];
+        rows_[static_cast<std::size_t>(y)] = rows_[static_cast<std::size_t>(y + lines)];
+    }
+    auto garbage_row = static_cast<RowWord>(Geometry::full_row & ~(RowWord{1} << hole_column));
+    for (int y = Geometry::height - lines; y < Geometry::height; ++y) {
+        state_.board[y].fill(GARBAGE_CELL);
+        state_.board[y][hole_column] = -1;
+        rows_[static_cast<std::size_t>(y)] = garbage_row;
+    }
+
+    for (int lift = 0; lift <= lines && collides(state_.active_piece); ++lift) {
+        state_.active_piece.position.y -= 1;
+    }
+    if (collides(state_.active_piece)) {
+        state_.game_over = true;
+    }
+    drop_distance_ = -1;
+    mark(CHANGE_GARBAGE | (state_.game_over ? CHANGE_GAME_OVER : 0u));
+    if (state_.game_over) {
+        emit(GameEventType::GameOver);
+    }
+}
+
+template <typename Geometry, typename Rules>
+bool BasicGame<Geometry, Rules>::collides(const Tetromino &tet) const {
+    const auto &mask = tetromino_mask(tet.type, tet.rotation);
+    int left = tet.position.x + mask.min_x;
+    int top = tet.position.y + mask.min_y;
+    if (left < 0 || left + mask.width > Geometry::width || top < 0 || top + mask.height > Geometry::height) {
+        return true;
+    }
+    for (int r = 0; r < mask.height; ++r) {
+        if (rows_[static_cast<std::size_t>(top + r)] & (static_cast<RowWord>(mask.rows[static_cast<std::size_t>(r)]) << left)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename Geometry, typename Rules>
+void BasicGame<Geometry, Rules>::lock_piece() {
+    const auto &table = tetromino_shape(state_.active_piece.type);
+    const auto &cells = table[static_cast<std::size_t>(state_.active_piece.rotation)];
+    GameEvent locked;
+    locked.type = GameEventType::PieceLocked;
+    locked.value = static_cast<std::int16_t>(state_.active_piece.type);
+    for (const auto &cell : cells) {
+        int x = state_.active_piece.position.x + cell.x;
+        int y = state_.active_piece.position.y + cell.y;
+        if (y >= 0 && y < Geometry::height && x >= 0 && x < Geometry::width) {
+            state_.board[y][x] = static_cast<int>(state_.active_piece.type);
+            rows_[static_cast<std::size_t>(y)] |= static_cast<RowWord>(RowWord{1} << x);
+            locked.cells[locked.count++] = {static_cast<std::int16_t>(x), static_cast<std::int16_t>(y)};
+        }
+    }
+    events_.push_back(locked);
+    mark(CHANGE_LOCK);
+    clear_lines();
+    spawn_piece();
+}
+
+template <typename Geometry, typename Rules>
+void BasicGame<Geometry, Rules>::spawn_piece() {
+    if (state_.queue.empty()) {
+        refill_queue();
+    }
+    state_.active_piece = Tetromino{state_.queue.front(), Rotation::R0, {spawn_x(), spawn_y()}};
+    state_.queue.pop_front();
+    drop_distance_ = -1;
+    lock_frames_ = 0;
+    gravity_accumulator_ = 0;
+    while (state_.queue.size() < Rules::queue_size) {
+        state_.queue.push_back(randomizer_.next());
+    }
+
+    if (collides(state_.active_piece)) {
+        state_.game_over = true;
+    }
+    mark(CHANGE_SPAWN | (state_.game_over ? CHANGE_GAME_OVER : 0u));
+    if (state_.game_over) {
+        emit(GameEventType::GameOver);
+    }
+}
+
+template <typename Geometry, typename Rules>
+void BasicGame<Geometry, Rules>::refill_queue() {
+    while (state_.queue.size() < Rules::queue_size) {
+        state_.queue.push_back(randomizer_.next());
+    }
+}
+
+template <typename Geometry, typename Rules>
+void BasicGame<Geometry, Rules>::clear_lines() {
+    // Compact surviving rows towards the floor in a single pass.
+    GameEvent cleared;
+    cleared.type = GameEventType::LinesCleared;
+    int lines_cleared = 0;
+    int write = Geometry::height - 1;
+    for (int read = Geometry::height - 1; read >= 0; --read) {
+        if (rows_[static_cast<std::size_t>(read)] == Geometry::full_row) {
+            if (cleared.count < cleared.rows.size()) {
+                cleared.rows[cleared.count++] = static_cast<std::int16_t>(read);
+            }
+            ++lines_cleared;
+            continue;
+        }
+        if (write != read) {
+            state_.board[write] = state_.board[read];
+            rows_[static_cast<std::size_t>(write)] = rows_[static_cast<std::size_t>(read)];
+        }
+        --write;
+    }
+
+    if (lines_cleared > 0) {
+        for (; write >= 0; --write) {
+            state_.board[write].fill(-1);
+            rows_[static_cast<std::size_t>(write)] = 0;
+        }
+
+        state_.total_lines += lines_cleared;
+        state_.score += Rules::line_clear_score(lines_cleared);
+
+        int computed_level = state_.total_lines / Rules::lines_per_level + 1;
+        int previous_level = state_.level;
+        state_.level = std::min(Rules::max_level, computed_level);
+        mark(CHANGE_CLEAR | CHANGE_SCORE | (state_.level != previous_level ? CHANGE_LEVEL_UP : 0u));
+        events_.push_back(cleared);
+        if (state_.level != previous_level) {
+            emit(GameEventType::LevelChanged, state_.level);
+        }
+    }
+}
+
+template <typename Geometry, typename Rules>
+void BasicGame<Geometry, Rules>::place_active(Tetromino &target, Rotation new_rotation) {
+    Tetromino rotated = target;
+    rotated.rotation = new_rotation;
+    if (!collides(rotated)) {
+        target = rotated;
+        drop_distance_ = -1;
+        mark(CHANGE_MOVE);
+    }
+}
+
+template <typename Geometry, typename Rules>
+void BasicGame<Geometry, Rules>::move_active(int dx, int dy) {
+    Tetromino moved = state_.active_piece;
+    moved.position.x += dx;
+    moved.position.y += dy;
+    if (!collides(moved)) {
+        state_.active_piece = moved;
+        drop_distance_ = -1;
+        if (dy > 0) {
+            lock_frames_ = 0;
+        }
+        mark(CHANGE_MOVE);
+    }
+}
+
+extern template class BasicGame<StandardGeometry, StandardRules>;
+extern template class BasicGame<StandardGeometry, MasterRules>;
+
+static_assert(std::is_trivially_copyable_v<Game>, "rollback snapshots copy games as plain bytes");
+
 } // namespace cretris::core
@@ -1,6 +1,7 @@
 #include "Tetromino.h"
 
 #include <algorithm>
+#include <utility>
 
 namespace cretris::core {
 
@@ -67,29 +68,78 @@ constexpr RotationTable L_TABLE = make_table({
 constexpr std::array<RotationTable, static_cast<std::size_t>(TetrominoType::Count)> TABLES = {
     I_TABLE, O_TABLE, T_TABLE, S_TABLE, Z_TABLE, J_TABLE, L_TABLE};
 
+constexpr PieceMask make_mask(const std::array<Position, 4> &cells) {
+    PieceMask mask{cells[0].x, cells[0].y, 0, 0, {}};
+    int max_x = cells[0].x;
+    int max_y = cells[0].y;
+    for (const auto &cell : cells) {
+        mask.min_x = std::min(mask.min_x, cell.x);
+        mask.min_y = std::min(mask.min_y, cell.y);
+        max_x = std::max(max_x, cell.x);
+        max_y = std::max(max_y, cell.y);
+    }
+    mask.width = max_x - mask.min_x + 1;
+    mask.height = max_y - mask.min_y + 1;
+    for (const auto &cell : cells) {
+        mask.rows[static_cast<std::size_t>(cell.y - mask.min_y)] |= static_cast<std::uint8_t>(1u << (cell.x - mask.min_x));
+    }
+    return mask;
+}
+
+using MaskTable = std::array<std::array<PieceMask, static_cast<std::size_t>(Rotation::Count)>,
+                             static_cast<std::size_t>(TetrominoType::Count)>;
+
+constexpr MaskTable make_mask_table() {
+    MaskTable table{};
+    for (std::size_t type = 0; type < table.size(); ++type) {
+        for (std::size_t rot = 0; rot < table[type].size(); ++rot) {
+            table[type][rot] = make_mask(TABLES[type][rot]);
+        }
+    }
+    return table;
+}
+
+constexpr MaskTable MASKS = make_mask_table();
+
 } // namespace
 
 const RotationTable &tetromino_shape(TetrominoType type) {
     return TABLES[static_cast<std::size_t>(type)];
 }
 
-BagRandomizer::BagRandomizer(unsigned seed) : rng_{seed} {
-    refill();
+const PieceMask &tetromino_mask(TetrominoType type, Rotation rotation) {
+    return MASKS[static_cast<std::size_t>(type)][static_cast<std::size_t>(rotation)];
 }
 
+BagRandomizer::BagRandomizer(std::uint64_t seed) : seed_{seed} {}
+
 TetrominoType BagRandomizer::next() {
     if (index_ >= bag_.size()) {
-        refill();
+        bag_ = bag(seed_, bag_index_++);
+        index_ = 0;
     }
     return bag_[index_++];
 }
 
-void BagRandomizer::refill() {
-    for (std::size_t i = 0; i < bag_.size(); ++i) {
-        bag_[i] = static_cast<TetrominoType>(i);
+void BagRandomizer::seek(std::uint64_t piece_index) {
+    bag_index_ = piece_index / bag_.size();
+    bag_ = bag(seed_, bag_index_++);
+    index_ = static_cast<std::size_t>(piece_index % bag_.size());
+}
+
+BagRandomizer::Bag BagRandomizer::bag(std::uint64_t seed, std::uint64_t bag_index) {
+    Bag result{};
+    for (std::size_t i = 0; i < result.size(); ++i) {
+        result[i] = static_cast<TetrominoType>(i);
+    }
+    // Fisher-Yates with a multiply-shift reduction; each swap draws its own counter.
+    std::uint64_t counter = bag_index * result.size();
+    for (std::size_t i = result.size() - 1; i > 0; --i) {
+        std::uint64_t high = counter_random(seed, counter++) >> 32;
+        auto j = static_cast<std::size_t>((high * (i + 1)) >> 32);
+        std::swap(result[i], result[j]);
     }
-    std::shuffle(bag_.begin(), bag_.end(), rng_);
-    index_ = 0;
+    return result;
 }
 
 } // namespace cretris::core
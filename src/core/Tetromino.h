@@ -2,6 +2,7 @@
 
 #include <array>
 #include <cstddef>
+#include <cstdint>
 #include <random>
 
 namespace cretris::core {
@@ -9,6 +10,8 @@ namespace cretris::core {
 struct Position {
     int x{};
     int y{};
+
+    bool operator==(const Position &) const = default;
 };
 
 enum class TetrominoType : std::size_t {
@@ -34,22 +37,54 @@ struct Tetromino {
     TetrominoType type{};
     Rotation rotation{Rotation::R0};
     Position position{0, 0};
+
+    bool operator==(const Tetromino &) const = default;
 };
 
 using RotationTable = std::array<std::array<Position, 4>, static_cast<std::size_t>(Rotation::Count)>;
 
 const RotationTable &tetromino_shape(TetrominoType type);
 
+// Bounding-box bitmask of one rotation: bit i of rows[r] covers the cell at
+// (min_x + i, min_y + r) relative to the piece position.
+struct PieceMask {
+    int min_x{};
+    int min_y{};
+    int width{};
+    int height{};
+    std::array<std::uint8_t, 4> rows{};
+};
+
+const PieceMask &tetromino_mask(TetrominoType type, Rotation rotation);
+
+// Stateless counter-based generator (SplitMix64 finaliser over key + counter).
+// Any draw can be computed directly from its index, so nothing needs stepping.
+constexpr std::uint64_t counter_random(std::uint64_t key, std::uint64_t counter) {
+    std::uint64_t z = key + (counter + 1) * 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
 class BagRandomizer {
 public:
-    explicit BagRandomizer(unsigned seed = std::random_device{}());
+    using Bag = std::array<TetrominoType, static_cast<std::size_t>(TetrominoType::Count)>;
+
+    explicit BagRandomizer(std::uint64_t seed = std::random_device{}());
     TetrominoType next();
 
-private:
-    void refill();
+    // Positions the randomizer so that the following next() returns piece `piece_index` of the sequence.
+    void seek(std::uint64_t piece_index);
+    std::uint64_t position() const noexcept { return bag_index_ * bag_.size() + index_ - bag_.size(); }
+    std::uint64_t seed() const noexcept { return seed_; }
 
-    std::mt19937 rng_;
-    std::array<TetrominoType, static_cast<std::size_t>(TetrominoType::Count)> bag_{};
+    // Bag `bag_index` of `seed`, computed without generating the bags before it.
+    static Bag bag(std::uint64_t seed, std::uint64_t bag_index);
+
+private:
+    std::uint64_t seed_;
+    std::uint64_t bag_index_{0}; // index of the next bag to draw
+    Bag bag_{};
     std::size_t index_{bag_.size()};
 };
 
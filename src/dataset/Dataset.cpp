@@ -0,0 +1,243 @@
+#include "Dataset.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstring>
+
+namespace cretris::dataset {
+
+namespace {
+
+static_assert(std::endian::native == std::endian::little, "columns are mapped in host byte order");
+
+constexpr char MAGIC[8] = {'C', 'R', 'T', 'D', 'A', 'T', 'A', '1'};
+constexpr std::uint32_t VERSION = 1;
+constexpr std::size_t PAGE = 4096;
+constexpr std::uint8_t NO_PIECE = static_cast<std::uint8_t>(core::TetrominoType::Count);
+
+struct ColumnEntry {
+    std::uint32_t width;
+    std::uint32_t reserved;
+    std::uint64_t offset;
+};
+
+struct Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t column_count;
+    std::uint64_t capacity;
+    std::uint64_t count;
+    ColumnEntry columns[COLUMN_COUNT];
+};
+
+static_assert(sizeof(Header) <= PAGE, "the header fits in the first page");
+
+// Column offsets for `capacity` records; returns the file size.
+std::size_t layout(std::size_t capacity, std::array<std::size_t, COLUMN_COUNT> &offsets) {
+    std::size_t offset = PAGE;
+    for (std::size_t c = 0; c < COLUMN_COUNT; ++c) {
+        offsets[c] = offset;
+        offset += (capacity * COLUMN_WIDTHS[c] + PAGE - 1) / PAGE * PAGE;
+    }
+    return offset;
+}
+
+void write_header(std::uint8_t *base, std::size_t capacity, const std::array<std::size_t, COLUMN_COUNT> &offsets) {
+    auto *header = reinterpret_cast<Header *>(base);
+    std::memcpy(header->magic, MAGIC, sizeof(MAGIC));
+    header->version = VERSION;
+    header->column_count = COLUMN_COUNT;
+    header->capacity = capacity;
+    for (std::size_t c = 0; c < COLUMN_COUNT; ++c) {
+        header->columns[c] = ColumnEntry{COLUMN_WIDTHS[c], 0, offsets[c]};
+    }
+}
+
+void publish_count(std::uint8_t *base, std::size_t count) {
+    std::atomic_ref<std::uint64_t>{reinterpret_cast<Header *>(base)->count}.store(count, std::memory_order_release);
+}
+
+} // namespace
+
+Position Position::capture(const core::Game &game) {
+    const auto &state = game.state();
+    Position position;
+    position.board = game.occupancy();
+    position.piece = state.active_piece.type;
+    position.queue.fill(NO_PIECE);
+    std::size_t q = 0;
+    for (auto type : state.queue) {
+        if (q < position.queue.size()) {
+            position.queue[q++] = static_cast<std::uint8_t>(type);
+        }
+    }
+    position.score = state.score;
+    return position;
+}
+
+SegmentWriter::~SegmentWriter() { close(); }
+
+bool SegmentWriter::open(const std::string &path, std::size_t capacity) {
+    close();
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        return false;
+    }
+    capacity_ = std::max<std::size_t>(capacity, 1);
+    std::size_t bytes = layout(capacity_, offsets_);
+    // Allocating the blocks up front keeps the filesystem out of the page faults
+    // taken while writing; fall back to a sparse file where that is unsupported.
+    if (::posix_fallocate(fd_, 0, static_cast<off_t>(bytes)) != 0 && ::ftruncate(fd_, static_cast<off_t>(bytes)) != 0) {
+        close();
+        return false;
+    }
+    void *mapped = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (mapped == MAP_FAILED) {
+        close();
+        return false;
+    }
+    base_ = static_cast<std::uint8_t *>(mapped);
+    mapped_bytes_ = bytes;
+    write_header(base_, capacity_, offsets_);
+    publish_count(base_, 0);
+    return true;
+}
+
+bool SegmentWriter::close() {
+    if (!base_) {
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+        return false;
+    }
+
+    // Drop a game that never ended, then slide every column down so the file
+    // holds exactly the records written.
+    std::size_t count = game_start_;
+    std::array<std::size_t, COLUMN_COUNT> offsets{};
+    std::size_t bytes = layout(count, offsets);
+    for (std::size_t c = 0; c < COLUMN_COUNT; ++c) {
+        if (offsets[c] != offsets_[c]) {
+            std::memmove(base_ + offsets[c], base_ + offsets_[c], count * COLUMN_WIDTHS[c]);
+        }
+    }
+    write_header(base_, count, offsets);
+    publish_count(base_, count);
+    ::munmap(base_, mapped_bytes_);
+    bool ok = ::ftruncate(fd_, static_cast<off_t>(bytes)) == 0;
+    ok = ::close(fd_) == 0 && ok;
+
+    fd_ = -1;
+    base_ = nullptr;
+    mapped_bytes_ = 0;
+    capacity_ = 0;
+    written_ = 0;
+    game_start_ = 0;
+    return ok;
+}
+
+void SegmentWriter::begin_game(std::uint64_t seed) {
+    written_ = game_start_; // discards a game that was never ended
+    seed_ = seed;
+}
+
+bool SegmentWriter::add(const Position &position, const core::Tetromino &pose, int lines_cleared) {
+    if (written_ >= capacity_) {
+        return false;
+    }
+    std::size_t i = written_++;
+    column<ai::Bitboard>(Column::Board)[i] = position.board;
+    column<std::uint8_t>(Column::Piece)[i] = static_cast<std::uint8_t>(position.piece);
+    column<QueueTypes>(Column::Queue)[i] = position.queue;
+    column<PlacementCode>(Column::Placement)[i] =
+        PlacementCode{static_cast<std::uint8_t>(pose.rotation), static_cast<std::int8_t>(pose.position.x),
+                      static_cast<std::int8_t>(pose.position.y), static_cast<std::uint8_t>(lines_cleared)};
+    column<std::uint64_t>(Column::Seed)[i] = seed_;
+    column<std::int32_t>(Column::Score)[i] = position.score;
+    return true;
+}
+
+void SegmentWriter::end_game(int final_score, bool topped_out) {
+    auto *final_scores = column<std::int32_t>(Column::FinalScore);
+    auto *pieces_left = column<std::uint32_t>(Column::PiecesLeft);
+    auto *ended = column<std::uint8_t>(Column::ToppedOut);
+    for (std::size_t i = game_start_; i < written_; ++i) {
+        final_scores[i] = final_score;
+        pieces_left[i] = static_cast<std::uint32_t>(written_ - 1 - i);
+        ended[i] = topped_out ? 1 : 0;
+    }
+    game_start_ = written_;
+    publish_count(base_, written_);
+}
+
+SegmentReader::~SegmentReader() { close(); }
+
+bool SegmentReader::open(const std::string &path) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info {};
+    if (::fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < PAGE) {
+        ::close(fd);
+        return false;
+    }
+    length_ = static_cast<std::size_t>(info.st_size);
+    void *mapped = ::mmap(nullptr, length_, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        length_ = 0;
+        return false;
+    }
+    data_ = static_cast<const std::uint8_t *>(mapped);
+    ::madvise(mapped, length_, MADV_SEQUENTIAL);
+
+    const auto *header = reinterpret_cast<const Header *>(data_);
+    if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 || header->version != VERSION ||
+        header->column_count != COLUMN_COUNT) {
+        close();
+        return false;
+    }
+    count_ = std::atomic_ref<std::uint64_t>{const_cast<std::uint64_t &>(header->count)}.load(std::memory_order_acquire);
+    for (std::size_t c = 0; c < COLUMN_COUNT; ++c) {
+        const ColumnEntry &entry = header->columns[c];
+        if (entry.width != COLUMN_WIDTHS[c] || entry.offset % alignof(std::uint64_t) != 0 ||
+            entry.offset > length_ || count_ > (length_ - entry.offset) / entry.width) {
+            close();
+            return false;
+        }
+        offsets_[c] = entry.offset;
+    }
+    return true;
+}
+
+void SegmentReader::close() {
+    if (data_) {
+        ::munmap(const_cast<std::uint8_t *>(data_), length_);
+    }
+    data_ = nullptr;
+    length_ = 0;
+    count_ = 0;
+}
+
+SegmentReader::Record SegmentReader::record(std::size_t index) const {
+    return Record{boards()[index],
+                  static_cast<core::TetrominoType>(pieces()[index]),
+                  queues()[index],
+                  placements()[index],
+                  seeds()[index],
+                  scores()[index],
+                  final_scores()[index],
+                  pieces_left()[index],
+                  topped_out()[index] != 0};
+}
+
+} // namespace cretris::dataset
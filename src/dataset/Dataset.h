@@ -0,0 +1,171 @@
+#pragma once
+
+#include "../ai/Placement.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+namespace cretris::dataset {
+
+// Self-play positions stored column by column, one fixed-width array per
+// field, each starting on its own page:
+//
+//   header  "CRTDATA1", u32 version, u32 column count, u64 capacity, u64 count,
+//           then per column: u32 width, u32 reserved, u64 offset
+//   columns board[count], piece[count], queue[count], ...
+//
+// Integers are little-endian and columns are mapped in host layout, so a
+// reader hands out spans straight into the file.
+enum class Column : std::uint32_t {
+    Board,      // ai::Bitboard before the placement
+    Piece,      // active piece type
+    Queue,      // the visible queue, front first
+    Placement,  // pose the policy chose, and the lines it cleared
+    Seed,       // the game's seed; records of one game are contiguous
+    Score,      // score before the placement
+    FinalScore, // score when the game ended
+    PiecesLeft, // placements the game still made after this one
+    ToppedOut,  // 1 if the game ended by topping out, 0 if it hit the piece cap
+    Count,
+};
+
+constexpr std::size_t COLUMN_COUNT = static_cast<std::size_t>(Column::Count);
+
+using QueueTypes = std::array<std::uint8_t, core::QUEUE_SIZE>;
+
+struct PlacementCode {
+    std::uint8_t rotation{0};
+    std::int8_t x{0};
+    std::int8_t y{0};
+    std::uint8_t lines{0};
+};
+
+constexpr std::array<std::uint32_t, COLUMN_COUNT> COLUMN_WIDTHS = {
+    sizeof(ai::Bitboard), 1, sizeof(QueueTypes), sizeof(PlacementCode), 8, 4, 4, 4, 1,
+};
+
+static_assert(sizeof(ai::Bitboard) == 40 && sizeof(QueueTypes) == 5 && sizeof(PlacementCode) == 4,
+              "column widths are the on-disk layout");
+
+// The input half of a record: what the policy saw when the piece spawned.
+struct Position {
+    ai::Bitboard board{};
+    core::TetrominoType piece{};
+    QueueTypes queue{};
+    std::int32_t score{0};
+
+    static Position capture(const core::Game &game);
+};
+
+// One segment file, owned by one thread: records are copied straight into a
+// pre-sized shared mapping, so appends take no lock and make no system call.
+// The outcome columns of a game's records are patched in when the game ends,
+// and only then does the header's count move past them.
+class SegmentWriter {
+public:
+    SegmentWriter() = default;
+    ~SegmentWriter();
+
+    SegmentWriter(const SegmentWriter &) = delete;
+    SegmentWriter &operator=(const SegmentWriter &) = delete;
+
+    bool open(const std::string &path, std::size_t capacity);
+    // Shrinks the columns to the records written, publishes the count and unmaps.
+    bool close();
+    bool is_open() const noexcept { return base_ != nullptr; }
+
+    std::size_t size() const noexcept { return written_; }
+    std::size_t capacity() const noexcept { return capacity_; }
+    std::size_t free_records() const noexcept { return capacity_ - written_; }
+
+    void begin_game(std::uint64_t seed);
+    // Records `position` and the pose its piece locked in; false when the segment is full.
+    bool add(const Position &position, const core::Tetromino &pose, int lines_cleared);
+    void end_game(int final_score, bool topped_out);
+
+private:
+    template <typename T>
+    T *column(Column column) const noexcept {
+        return reinterpret_cast<T *>(base_ + offsets_[static_cast<std::size_t>(column)]);
+    }
+
+    int fd_{-1};
+    std::uint8_t *base_{nullptr};
+    std::size_t mapped_bytes_{0};
+    std::size_t capacity_{0};
+    std::size_t written_{0};
+    std::size_t game_start_{0};
+    std::uint64_t seed_{0};
+    std::array<std::size_t, COLUMN_COUNT> offsets_{};
+};
+
+// Read-only mapping of one segment; every accessor points into the map.
+class SegmentReader {
+public:
+    struct Record {
+        const ai::Bitboard &board;
+        core::TetrominoType piece;
+        const QueueTypes &queue;
+        const PlacementCode &placement;
+        std::uint64_t seed;
+        std::int32_t score;
+        std::int32_t final_score;
+        std::uint32_t pieces_left;
+        bool topped_out;
+    };
+
+    SegmentReader() = default;
+    ~SegmentReader();
+
+    SegmentReader(const SegmentReader &) = delete;
+    SegmentReader &operator=(const SegmentReader &) = delete;
+
+    class Iterator {
+    public:
+        Iterator(const SegmentReader *reader, std::size_t index) : reader_{reader}, index_{index} {}
+        Record operator*() const { return reader_->record(index_); }
+        Iterator &operator++() {
+            ++index_;
+            return *this;
+        }
+        bool operator==(const Iterator &) const = default;
+
+    private:
+        const SegmentReader *reader_;
+        std::size_t index_;
+    };
+
+    bool open(const std::string &path); // false if missing or malformed
+    void close();
+
+    std::size_t size() const noexcept { return count_; }
+    Record record(std::size_t index) const;
+    Iterator begin() const { return {this, 0}; }
+    Iterator end() const { return {this, count_}; }
+
+    std::span<const ai::Bitboard> boards() const { return column<ai::Bitboard>(Column::Board); }
+    std::span<const std::uint8_t> pieces() const { return column<std::uint8_t>(Column::Piece); }
+    std::span<const QueueTypes> queues() const { return column<QueueTypes>(Column::Queue); }
+    std::span<const PlacementCode> placements() const { return column<PlacementCode>(Column::Placement); }
+    std::span<const std::uint64_t> seeds() const { return column<std::uint64_t>(Column::Seed); }
+    std::span<const std::int32_t> scores() const { return column<std::int32_t>(Column::Score); }
+    std::span<const std::int32_t> final_scores() const { return column<std::int32_t>(Column::FinalScore); }
+    std::span<const std::uint32_t> pieces_left() const { return column<std::uint32_t>(Column::PiecesLeft); }
+    std::span<const std::uint8_t> topped_out() const { return column<std::uint8_t>(Column::ToppedOut); }
+
+private:
+    template <typename T>
+    std::span<const T> column(Column column) const {
+        return {reinterpret_cast<const T *>(data_ + offsets_[static_cast<std::size_t>(column)]), count_};
+    }
+
+    const std::uint8_t *data_{nullptr};
+    std::size_t length_{0};
+    std::size_t count_{0};
+    std::array<std::size_t, COLUMN_COUNT> offsets_{};
+};
+
+} // namespace cretris::dataset
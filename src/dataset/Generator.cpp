@@ -0,0 +1,173 @@
+#include "Generator.h"
+
+#include "Dataset.h"
+#include "../ai/Planner.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <numeric>
+#include <optional>
+#include <vector>
+
+namespace cretris::dataset {
+
+namespace {
+
+struct WorkerResult {
+    std::uint64_t games{0};
+    std::uint64_t records{0};
+    std::size_t segments{0};
+    bool ok{true};
+};
+
+std::string segment_path(const std::string &directory, std::size_t worker, std::size_t segment) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "part-%03zu-%05zu.crtd", worker, segment);
+    return (std::filesystem::path{directory} / name).string();
+}
+
+// The pose a lock left the piece in: where it was before the locking input,
+// dropped onto the board it landed on.
+core::Tetromino landed(const ai::Bitboard &board, core::Tetromino piece) {
+    core::Tetromino below = piece;
+    for (++below.position.y; ai::fits(board, below); ++below.position.y) {
+        piece = below;
+    }
+    return piece;
+}
+
+int play_random_inputs(core::Game &game, std::uint64_t seed, int max_pieces, SegmentWriter &writer) {
+    int pieces = 0;
+    std::uint64_t step = 0;
+    Position position = Position::capture(game);
+    while (!game.state().game_over && pieces < max_pieces) {
+        core::Tetromino before = game.state().active_piece;
+        if (++step % 4 == 0) {
+            game.tick();
+        } else {
+            auto draw = core::counter_random(seed, step);
+            game.apply_action(static_cast<core::InputAction>(draw % static_cast<std::uint64_t>(core::InputAction::Quit)));
+        }
+        if (game.take_changes() & core::CHANGE_LOCK) {
+            int lines = 0;
+            for (const auto &event : game.take_events()) {
+                lines += event.type == core::GameEventType::LinesCleared ? event.count : 0;
+            }
+            writer.add(position, landed(position.board, before), lines);
+            position = Position::capture(game);
+            ++pieces;
+        }
+    }
+    return pieces;
+}
+
+int play_placements(core::Game &game, std::uint64_t seed, const GeneratorConfig &config,
+                    std::optional<ai::Planner> &planner, std::vector<ai::Placement> &placements, SegmentWriter &writer) {
+    int pieces = 0;
+    std::uint64_t draw = 0;
+    while (!game.state().game_over && pieces < config.max_pieces) {
+        const auto &state = game.state();
+        ai::find_placements(game.occupancy(), state.active_piece, placements);
+        if (placements.empty()) {
+            break;
+        }
+        std::optional<ai::Placement> chosen;
+        auto roll = core::counter_random(seed, draw++);
+        if (planner && static_cast<double>(roll >> 11) * 0x1.0p-53 >= config.epsilon) {
+            chosen = planner->choose(game);
+        }
+        if (!chosen) {
+            chosen = placements[core::counter_random(seed, draw++) % placements.size()];
+        }
+
+        writer.add(Position::capture(game), chosen->piece, chosen->lines_cleared);
+        for (auto action : ai::plan_actions(game.occupancy(), state.active_piece, chosen->piece)) {
+            game.apply_action(action);
+        }
+        game.take_events();
+        ++pieces;
+    }
+    return pieces;
+}
+
+void run_worker(const GeneratorConfig &config, std::size_t index, std::atomic<std::uint64_t> &next_game,
+                WorkerResult &result) {
+    std::optional<ai::Planner> planner;
+    if (config.policy == Policy::Planner) {
+        planner.emplace();
+    }
+    auto capacity = std::max<std::size_t>(config.segment_records, static_cast<std::size_t>(config.max_pieces));
+    SegmentWriter writer;
+    std::vector<ai::Placement> placements;
+
+    while (true) {
+        auto game_index = next_game.fetch_add(1, std::memory_order_relaxed);
+        if (game_index >= config.games) {
+            break;
+        }
+        if (writer.free_records() < static_cast<std::size_t>(config.max_pieces)) {
+            if (writer.is_open()) {
+                result.ok = writer.close() && result.ok;
+            }
+            if (!writer.open(segment_path(config.directory, index, result.segments), capacity)) {
+                result.ok = false;
+                break;
+            }
+            ++result.segments;
+        }
+
+        auto seed = core::counter_random(config.seed, game_index);
+        core::Game game{seed};
+        writer.begin_game(seed);
+        int pieces = config.policy == Policy::RandomInputs
+                         ? play_random_inputs(game, seed, config.max_pieces, writer)
+                         : play_placements(game, seed, config, planner, placements, writer);
+        bool topped_out = pieces < config.max_pieces;
+        writer.end_game(game.state().score, topped_out);
+        result.records += static_cast<std::uint64_t>(pieces);
+        ++result.games;
+    }
+    if (writer.is_open()) {
+        result.ok = writer.close() && result.ok;
+    }
+}
+
+} // namespace
+
+std::size_t record_bytes() { return std::accumulate(COLUMN_WIDTHS.begin(), COLUMN_WIDTHS.end(), std::size_t{0}); }
+
+GeneratorStats generate(const GeneratorConfig &config) {
+    GeneratorStats stats;
+    std::error_code error;
+    std::filesystem::create_directories(config.directory, error);
+    if (error) {
+        stats.ok = false;
+        return stats;
+    }
+
+    auto started = std::chrono::steady_clock::now();
+    std::size_t threads = std::max<std::size_t>(config.threads, 1);
+    std::vector<WorkerResult> results(threads);
+    std::atomic<std::uint64_t> next_game{0};
+    std::vector<std::thread> workers;
+    for (std::size_t i = 0; i < threads; ++i) {
+        workers.emplace_back([&, i] { run_worker(config, i, next_game, results[i]); });
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    stats.elapsed = std::chrono::steady_clock::now() - started;
+
+    for (const auto &result : results) {
+        stats.games += result.games;
+        stats.records += result.records;
+        stats.segments += result.segments;
+        stats.ok = stats.ok && result.ok;
+    }
+    stats.bytes = stats.records * record_bytes();
+    return stats;
+}
+
+} // namespace cretris::dataset
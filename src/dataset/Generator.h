@@ -0,0 +1,44 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+namespace cretris::dataset {
+
+enum class Policy {
+    RandomInputs,    // random key presses with gravity every fourth step, as sim::Policy::Random
+    RandomPlacement, // a uniformly random reachable placement
+    Planner,         // ai::Planner's choice, or a random placement with probability `epsilon`
+};
+
+struct GeneratorConfig {
+    std::string directory;
+    std::uint64_t games{1000};
+    std::size_t threads{std::thread::hardware_concurrency()};
+    std::uint64_t seed{1};
+    Policy policy{Policy::Planner};
+    double epsilon{0.0};
+    int max_pieces{1000};
+    std::size_t segment_records{1u << 20}; // at least max_pieces; a game never spans two segments
+};
+
+struct GeneratorStats {
+    std::uint64_t games{0};
+    std::uint64_t records{0};
+    std::uint64_t bytes{0}; // column bytes, headers and padding excluded
+    std::size_t segments{0};
+    std::chrono::steady_clock::duration elapsed{};
+    bool ok{true};
+};
+
+// Plays `games` self-play games across `threads` workers. Each worker owns its
+// segment files, DIRECTORY/part-WWW-SSSSS.crtd, and writes them without any
+// coordination beyond claiming the next game index.
+GeneratorStats generate(const GeneratorConfig &config);
+
+std::size_t record_bytes(); // sum of the column widths
+
+} // namespace cretris::dataset
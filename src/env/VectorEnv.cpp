@@ -0,0 +1,183 @@
+#include "VectorEnv.h"
+
+#include <algorithm>
+
+namespace cretris::env {
+
+namespace {
+
+// Below this many games per thread the hand-off costs more than it saves.
+constexpr std::size_t MIN_GAMES_PER_THREAD = 256;
+
+constexpr std::int32_t ACTION_COUNT = static_cast<std::int32_t>(core::InputAction::RotateCCW) + 1;
+
+} // namespace
+
+VectorEnv::VectorEnv(const cretris_env_config &config)
+    : last_score_(config.num_envs, 0), steps_(config.num_envs, 0), episodes_(config.num_envs, 0), seed_(config.seed),
+      gravity_every_(config.gravity_every) {
+    games_.reserve(config.num_envs);
+    for (std::size_t i = 0; i < config.num_envs; ++i) {
+        games_.emplace_back(std::uint64_t{0}); // reseeded by reset_one, which also counts the episode
+        reset_one(i);
+    }
+    if (config.num_threads > 1) {
+        pool_ = std::make_unique<runtime::ThreadPool>(config.num_threads - 1);
+    }
+}
+
+void VectorEnv::reset(cretris_observation *observation) {
+    for_each_chunk([&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            reset_one(i);
+        }
+        observe_range(begin, end, observation);
+    });
+}
+
+void VectorEnv::step(const std::int32_t *actions, cretris_observation *observation, float *rewards,
+                     std::uint8_t *dones) {
+    for_each_chunk([&](std::size_t begin, std::size_t end) {
+        step_range(begin, end, actions, rewards, dones);
+        observe_range(begin, end, observation);
+    });
+}
+
+void VectorEnv::reset_one(std::size_t index) {
+    // Episode e of environment i always replays the same piece sequence for a given base seed.
+    games_[index] = core::Game{core::counter_random(seed_, (static_cast<std::uint64_t>(index) << 32) | episodes_[index])};
+    ++episodes_[index];
+    last_score_[index] = 0;
+    steps_[index] = 0;
+}
+
+void VectorEnv::step_range(std::size_t begin, std::size_t end, const std::int32_t *actions, float *rewards,
+                           std::uint8_t *dones) {
+    for (std::size_t i = begin; i < end; ++i) {
+        auto &game = games_[i];
+        std::int32_t action = actions ? actions[i] : 0;
+        if (action > 0 && action < ACTION_COUNT) {
+            game.apply_action(static_cast<core::InputAction>(action));
+        }
+        ++steps_[i];
+        if (gravity_every_ > 0 && steps_[i] % gravity_every_ == 0) {
+            game.tick();
+        }
+
+        int score = game.state().score;
+        if (rewards) {
+            rewards[i] = static_cast<float>(score - last_score_[i]);
+        }
+        last_score_[i] = score;
+
+        bool done = game.state().game_over;
+        if (dones) {
+            dones[i] = done ? 1 : 0;
+        }
+        if (done) {
+            reset_one(i);
+        }
+    }
+}
+
+void VectorEnv::observe_range(std::size_t begin, std::size_t end, cretris_observation *observation) const {
+    if (!observation) {
+        return;
+    }
+    constexpr std::size_t cells = static_cast<std::size_t>(core::BOARD_WIDTH * core::BOARD_HEIGHT);
+    for (std::size_t i = begin; i < end; ++i) {
+        const auto &game = games_[i];
+        const auto &state = game.state();
+        if (observation->board) {
+            std::uint8_t *out = observation->board + i * cells;
+            for (auto row : game.occupancy()) {
+                for (int x = 0; x < core::BOARD_WIDTH; ++x) {
+                    *out++ = static_cast<std::uint8_t>((row >> x) & 1u);
+                }
+            }
+        }
+        if (observation->piece) {
+            std::int32_t *out = observation->piece + i * 4;
+            out[0] = static_cast<std::int32_t>(state.active_piece.type);
+            out[1] = static_cast<std::int32_t>(state.active_piece.rotation);
+            out[2] = state.active_piece.position.x;
+            out[3] = state.active_piece.position.y;
+        }
+        if (observation->queue) {
+            std::int32_t *out = observation->queue + i * core::QUEUE_SIZE;
+            std::size_t q = 0;
+            for (; q < state.queue.size() && q < static_cast<std::size_t>(core::QUEUE_SIZE); ++q) {
+                out[q] = static_cast<std::int32_t>(state.queue[q]);
+            }
+            for (; q < static_cast<std::size_t>(core::QUEUE_SIZE); ++q) {
+                out[q] = -1;
+            }
+        }
+    }
+}
+
+template <typename Body>
+void VectorEnv::for_each_chunk(Body &&body) {
+    if (pool_ && games_.size() >= MIN_GAMES_PER_THREAD * 2) {
+        pool_->parallel_for(games_.size(), body);
+    } else {
+        body(0, games_.size());
+    }
+}
+
+} // namespace cretris::env
+
+extern "C" {
+
+struct cretris_env {
+    cretris::env::VectorEnv impl;
+};
+
+// Nothing may unwind into a C caller: entry points that can allocate (the
+// games, the pool's threads, the per-call task list) catch everything.
+cretris_env *cretris_env_create(const cretris_env_config *config) {
+    if (!config || config->num_envs == 0) {
+        return nullptr;
+    }
+    try {
+        return new cretris_env{cretris::env::VectorEnv{*config}};
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void cretris_env_destroy(cretris_env *env) { delete env; }
+
+uint32_t cretris_env_num_envs(const cretris_env *env) { return env ? static_cast<uint32_t>(env->impl.size()) : 0; }
+
+cretris_env_shape cretris_env_get_shape(void) {
+    return cretris_env_shape{cretris::core::BOARD_WIDTH, cretris::core::BOARD_HEIGHT, cretris::core::QUEUE_SIZE,
+                             cretris::env::ACTION_COUNT};
+}
+
+int32_t cretris_env_reset(cretris_env *env, cretris_observation *observation) {
+    if (!env) {
+        return -1;
+    }
+    try {
+        env->impl.reset(observation);
+        return 0;
+    } catch (...) {
+        return -1;
+    }
+}
+
+int32_t cretris_env_step(cretris_env *env, const int32_t *actions, cretris_observation *observation, float *rewards,
+                         uint8_t *dones) {
+    if (!env) {
+        return -1;
+    }
+    try {
+        env->impl.step(actions, observation, rewards, dones);
+        return 0;
+    } catch (...) {
+        return -1;
+    }
+}
+
+} // extern "C"
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "cretris_env.h"
+
+#include "../core/Game.h"
+#include "../runtime/ThreadPool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace cretris::env {
+
+// N games stepped in lock-step for batched training. The games sit in one
+// contiguous array; per-environment bookkeeping (seeds, score baselines, step
+// counters) is kept as parallel arrays so a step touches only what it needs.
+class VectorEnv {
+public:
+    explicit VectorEnv(const cretris_env_config &config);
+
+    std::size_t size() const noexcept { return games_.size(); }
+
+    void reset(cretris_observation *observation);
+    void step(const std::int32_t *actions, cretris_observation *observation, float *rewards, std::uint8_t *dones);
+
+    const core::Game &game(std::size_t index) const { return games_[index]; }
+
+private:
+    void reset_one(std::size_t index);
+    void step_range(std::size_t begin, std::size_t end, const std::int32_t *actions, float *rewards,
+                    std::uint8_t *dones);
+    void observe_range(std::size_t begin, std::size_t end, cretris_observation *observation) const;
+    template <typename Body>
+    void for_each_chunk(Body &&body);
+
+    std::vector<core::Game> games_;
+    std::vector<int> last_score_;
+    std::vector<std::uint32_t> steps_;
+    std::vector<std::uint64_t> episodes_;
+    std::uint64_t seed_;
+    std::uint32_t gravity_every_;
+    std::unique_ptr<runtime::ThreadPool> pool_;
+};
+
+} // namespace cretris::env
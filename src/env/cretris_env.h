@@ -0,0 +1,66 @@
+/* Batched training environment, exported with a plain C ABI.
+ *
+ * One handle owns N independent games. A step applies one action per game,
+ * advances gravity, and writes observations, rewards and done flags straight
+ * into caller-owned buffers. Finished games are reset automatically; the
+ * observation written for them is the first state of the new episode.
+ */
+#ifndef CRETRIS_ENV_H
+#define CRETRIS_ENV_H
+
+#include <stdint.h>
+
+#if defined(__GNUC__)
+#define CRETRIS_ENV_API __attribute__((visibility("default")))
+#else
+#define CRETRIS_ENV_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct cretris_env cretris_env;
+
+typedef struct cretris_env_config {
+    uint32_t num_envs;
+    uint32_t num_threads;  /* 0 or 1 steps on the calling thread */
+    uint32_t gravity_every; /* gravity tick every k steps; 0 disables gravity */
+    uint64_t seed;
+} cretris_env_config;
+
+/* Any pointer may be NULL to skip that part of the observation. */
+typedef struct cretris_observation {
+    uint8_t *board;  /* num_envs * height * width, 1 = filled, row-major from the top */
+    int32_t *piece;  /* num_envs * 4: type, rotation, x, y */
+    int32_t *queue;  /* num_envs * queue_size piece types */
+} cretris_observation;
+
+typedef struct cretris_env_shape {
+    int32_t board_width;
+    int32_t board_height;
+    int32_t queue_size;
+    int32_t num_actions;
+} cretris_env_shape;
+
+/* Returns NULL if num_envs is 0 or the games or worker threads cannot be created. */
+CRETRIS_ENV_API cretris_env *cretris_env_create(const cretris_env_config *config);
+CRETRIS_ENV_API void cretris_env_destroy(cretris_env *env);
+
+CRETRIS_ENV_API uint32_t cretris_env_num_envs(const cretris_env *env);
+CRETRIS_ENV_API cretris_env_shape cretris_env_get_shape(void);
+
+/* reset and step return 0, or -1 if env is NULL or the call ran out of memory,
+ * in which case the output buffers may be partly written. */
+CRETRIS_ENV_API int32_t cretris_env_reset(cretris_env *env, cretris_observation *observation);
+
+/* actions: num_envs values in [0, num_actions), matching InputAction None..RotateCCW.
+ * rewards: score gained this step. dones: 1 when the game ended (and was reset). */
+CRETRIS_ENV_API int32_t cretris_env_step(cretris_env *env, const int32_t *actions, cretris_observation *observation,
+                                         float *rewards, uint8_t *dones);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CRETRIS_ENV_H */
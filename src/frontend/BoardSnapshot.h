@@ -0,0 +1,48 @@
+#pragma once
+
+#include "../core/Game.h"
+
+#include <array>
+#include <cstdint>
+
+namespace cretris::frontend {
+
+// Just enough of a game to draw it small: the board with the active piece
+// stamped in, and the headline numbers. Trivially copyable for SeqlockTable.
+struct BoardSnapshot {
+    std::array<std::int8_t, core::BOARD_WIDTH * core::BOARD_HEIGHT> cells{}; // row-major, -1 empty
+    std::int32_t score{0};
+    std::int32_t lines{0};
+    std::int32_t level{1};
+    bool game_over{false};
+
+    std::int8_t at(int x, int y) const noexcept { return cells[static_cast<std::size_t>(y * core::BOARD_WIDTH + x)]; }
+
+    static BoardSnapshot capture(const core::GameState &state) noexcept {
+        BoardSnapshot snapshot;
+        for (int y = 0; y < core::BOARD_HEIGHT; ++y) {
+            for (int x = 0; x < core::BOARD_WIDTH; ++x) {
+                snapshot.cells[static_cast<std::size_t>(y * core::BOARD_WIDTH + x)] =
+                    static_cast<std::int8_t>(state.board[y][x]);
+            }
+        }
+        if (!state.game_over) {
+            const auto &piece = state.active_piece;
+            for (const auto &cell : core::tetromino_shape(piece.type)[static_cast<std::size_t>(piece.rotation)]) {
+                int x = piece.position.x + cell.x;
+                int y = piece.position.y + cell.y;
+                if (x >= 0 && x < core::BOARD_WIDTH && y >= 0 && y < core::BOARD_HEIGHT) {
+                    snapshot.cells[static_cast<std::size_t>(y * core::BOARD_WIDTH + x)] =
+                        static_cast<std::int8_t>(piece.type);
+                }
+            }
+        }
+        snapshot.score = state.score;
+        snapshot.lines = state.total_lines;
+        snapshot.level = state.level;
+        snapshot.game_over = state.game_over;
+        return snapshot;
+    }
+};
+
+} // namespace cretris::frontend
@@ -2,7 +2,10 @@
 
 #include "../core/Game.h"
 
+#include <algorithm>
 #include <chrono>
+#include <cstdint>
+#include <optional>
 
 namespace cretris::frontend {
 
@@ -15,6 +18,44 @@ public:
     virtual core::InputAction poll_input() = 0;
     virtual void shutdown() = 0;
     virtual void sleep_for(std::chrono::milliseconds duration) = 0;
+
+    // Blocks until input arrives or `timeout` passes, then behaves like
+    // poll_input(). milliseconds::max() waits indefinitely.
+    virtual core::InputAction wait_input(std::chrono::milliseconds timeout) {
+        auto action = poll_input();
+        if (action == core::InputAction::None) {
+            sleep_for(std::min(timeout, std::chrono::milliseconds{16}));
+            action = poll_input();
+        }
+        return action;
+    }
+
+    // Makes a wait_input() in progress return early. Safe to call from any thread.
+    virtual void wake() {}
+
+    // Events the game emitted since the previous call, delivered before render().
+    virtual void on_events(const core::GameEvents &events) { (void)events; }
+
+    // When the action poll_input() or wait_input() last returned arrived: the
+    // event's own timestamp where the backend has one, else when it was read.
+    virtual std::chrono::steady_clock::time_point last_input_time() const { return {}; }
+
+    struct FrameTiming {
+        std::uint64_t version{0};                          // GameState::version the frame showed
+        std::chrono::steady_clock::time_point submitted{}; // just before the present call
+        std::chrono::steady_clock::time_point returned{};  // when the present call returned
+    };
+    // The last frame render() handed to the display; version 0 before the first.
+    virtual FrameTiming last_frame() const { return {}; }
+
+    // Queues `action` as if its key had been pressed, for scripted runs.
+    virtual void inject_input(core::InputAction action) { (void)action; }
+
+    // Placement to highlight as a suggestion, or nothing to clear it.
+    virtual void set_hint(const std::optional<core::Tetromino> &hint) { (void)hint; }
+
+    // True while an effect still needs frames even though the state is unchanged.
+    virtual bool is_animating() const { return false; }
 };
 
 } // namespace cretris::frontend
@@ -1,11 +1,18 @@
 #include "NcursesFrontend.h"
 
+#include "../../sim/Simulation.h"
+
 #include <ncurses.h>
 
 #include <algorithm>
 #include <array>
+#include <limits>
 #include <thread>
 
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
 namespace cretris::frontend {
 
 namespace {
@@ -81,6 +88,9 @@ void NcursesFrontend::initialize(const core::GameState &state) {
         return;
     }
     (void)state;
+    if (::pipe2(wake_pipe_.data(), O_NONBLOCK | O_CLOEXEC) != 0) {
+        wake_pipe_ = {-1, -1};
+    }
     initscr();
     cbreak();
     noecho();
@@ -99,21 +109,35 @@ void NcursesFrontend::initialize(const core::GameState &state) {
         init_pair(7, COLOR_WHITE, -1);
     }
     initialized_ = true;
+    needs_redraw_ = true;
 }
 
 void NcursesFrontend::render(const core::GameState &state) {
     if (!initialized_) {
         return;
     }
+    if (!needs_redraw_ && state.version == last_version_) {
+        return;
+    }
+    needs_redraw_ = false;
+    last_version_ = state.version;
     erase();
     draw_board(state);
     draw_next_preview(state);
     draw_stats(state);
+    last_frame_.version = state.version;
+    last_frame_.submitted = std::chrono::steady_clock::now();
     refresh();
+    last_frame_.returned = std::chrono::steady_clock::now();
 }
 
 core::InputAction NcursesFrontend::poll_input() {
     int ch = getch();
+    if (ch != ERR) {
+        // The terminal carries no event time; ungetch'd keys read first and keep theirs.
+        last_input_time_ = injected_ ? injected_at_ : std::chrono::steady_clock::now();
+        injected_ = false;
+    }
     switch (ch) {
     case KEY_LEFT:
     case 'a':
@@ -134,22 +158,71 @@ core::InputAction NcursesFrontend::poll_input() {
     case 'x':
     case 'Q':
         return core::InputAction::Quit;
+    case KEY_RESIZE:
+        needs_redraw_ = true;
+        return core::InputAction::None;
     default:
         return core::InputAction::None;
     }
 }
 
+void NcursesFrontend::set_hint(const std::optional<core::Tetromino> &hint) {
+    if (hint != hint_) {
+        hint_ = hint;
+        needs_redraw_ = true;
+    }
+}
+
+void NcursesFrontend::inject_input(core::InputAction action) {
+    constexpr std::array<int, 8> keys = {ERR, KEY_LEFT, KEY_RIGHT, KEY_DOWN, ' ', KEY_UP, 'q', 'x'};
+    auto key = keys[static_cast<std::size_t>(action)];
+    if (initialized_ && key != ERR && ungetch(key) == OK) {
+        injected_at_ = std::chrono::steady_clock::now();
+        injected_ = true;
+    }
+}
+
 void NcursesFrontend::shutdown() {
     if (initialized_) {
         endwin();
         initialized_ = false;
     }
+    for (int &fd : wake_pipe_) {
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
 }
 
 void NcursesFrontend::sleep_for(std::chrono::milliseconds duration) {
     std::this_thread::sleep_for(duration);
 }
 
+core::InputAction NcursesFrontend::wait_input(std::chrono::milliseconds timeout) {
+    // ncurses may already hold buffered keys; only park on stdin when it does not.
+    auto action = poll_input();
+    if (action != core::InputAction::None) {
+        return action;
+    }
+    std::array<pollfd, 2> fds{pollfd{STDIN_FILENO, POLLIN, 0}, pollfd{wake_pipe_[0], POLLIN, 0}};
+    int wait_ms = timeout.count() >= std::numeric_limits<int>::max() ? -1 : static_cast<int>(std::max<std::int64_t>(0, timeout.count()));
+    ::poll(fds.data(), wake_pipe_[0] >= 0 ? 2 : 1, wait_ms);
+    if (fds[1].revents & POLLIN) {
+        char drain[64];
+        while (::read(wake_pipe_[0], drain, sizeof(drain)) > 0) {
+        }
+    }
+    return poll_input();
+}
+
+void NcursesFrontend::wake() {
+    if (wake_pipe_[1] >= 0) {
+        char byte = 1;
+        [[maybe_unused]] auto written = ::write(wake_pipe_[1], &byte, 1); // a full pipe already wakes the poll
+    }
+}
+
 void NcursesFrontend::draw_board(const core::GameState &state) {
     constexpr int offset_x = 2;
     constexpr int offset_y = 1;
@@ -172,6 +245,9 @@ void NcursesFrontend::draw_board(const core::GameState &state) {
             if (cell == -1) {
                 mvaddch(offset_y + y, offset_x + x * 2, '.');
                 mvaddch(offset_y + y, offset_x + x * 2 + 1, '.');
+            } else if (cell == core::GARBAGE_CELL) {
+                mvaddch(offset_y + y, offset_x + x * 2, '[');
+                mvaddch(offset_y + y, offset_x + x * 2 + 1, ']');
             } else {
                 short color = color_for(static_cast<core::TetrominoType>(cell));
                 attron(COLOR_PAIR(color));
@@ -182,6 +258,20 @@ void NcursesFrontend::draw_board(const core::GameState &state) {
         }
     }
 
+    if (hint_ && hint_->type == state.active_piece.type) {
+        short hint_color = color_for(hint_->type);
+        attron(COLOR_PAIR(hint_color) | A_BOLD);
+        for (const auto &cell : core::tetromino_shape(hint_->type)[static_cast<std::size_t>(hint_->rotation)]) {
+            int x = hint_->position.x + cell.x;
+            int y = hint_->position.y + cell.y;
+            if (y >= 0 && y < core::BOARD_HEIGHT && x >= 0 && x < core::BOARD_WIDTH && buffer[y][x] == -1) {
+                mvaddch(offset_y + y, offset_x + x * 2, '<');
+                mvaddch(offset_y + y, offset_x + x * 2 + 1, '>');
+            }
+        }
+        attroff(COLOR_PAIR(hint_color) | A_BOLD);
+    }
+
     const auto footprint = landing_footprint(state);
     int indicator_y = offset_y + core::BOARD_HEIGHT + 1;
     for (int x = 0; x < core::BOARD_WIDTH; ++x) {
@@ -279,4 +369,150 @@ void NcursesFrontend::draw_stats(const core::GameState &state) {
     mvprintw(y++, start_x, "X: quit");
 }
 
+void NcursesFrontend::render_dashboard(const sim::SimulationStats &stats, std::span<const core::GameState> samples) {
+    if (!initialized_) {
+        return;
+    }
+    constexpr int MINI_BOARD_WIDTH = core::BOARD_WIDTH + 2;
+    constexpr std::size_t ROTATE_EVERY = 8; // refreshes between sample rotations
+    int rows = 0;
+    int cols = 0;
+    getmaxyx(stdscr, rows, cols);
+
+    double seconds = std::chrono::duration<double>(stats.elapsed).count();
+    double interval = std::chrono::duration<double>(stats.elapsed - dashboard_elapsed_).count();
+    auto rate = [interval](std::uint64_t now, std::uint64_t before) {
+        return interval > 0.0 ? static_cast<double>(now - before) / interval : 0.0;
+    };
+
+    erase();
+    attron(A_BOLD);
+    mvprintw(0, 1, "cretris simulation");
+    attroff(A_BOLD);
+    mvprintw(0, 22, "%llu / %llu games  %6.1f s", static_cast<unsigned long long>(stats.games),
+             static_cast<unsigned long long>(stats.target_games), seconds);
+    mvprintw(1, 1, "games/s  %10.1f  avg %10.1f", rate(stats.games, dashboard_games_),
+             seconds > 0.0 ? static_cast<double>(stats.games) / seconds : 0.0);
+    mvprintw(2, 1, "pieces/s %10.1f  avg %10.1f", rate(stats.pieces, dashboard_pieces_),
+             seconds > 0.0 ? static_cast<double>(stats.pieces) / seconds : 0.0);
+    mvprintw(3, 1, "lines    %10llu  per game %6.1f", static_cast<unsigned long long>(stats.lines),
+             stats.games > 0 ? static_cast<double>(stats.lines) / static_cast<double>(stats.games) : 0.0);
+
+    // Per-worker utilisation: share of the last interval spent inside games.
+    int y = 5;
+    mvprintw(y++, 1, "Workers");
+    constexpr int BAR = 20;
+    for (std::size_t i = 0; i < stats.workers.size() && y < rows - 1; ++i) {
+        const auto &worker = stats.workers[i];
+        std::uint64_t busy_before = i < dashboard_busy_ns_.size() ? dashboard_busy_ns_[i] : 0;
+        double busy = interval > 0.0 ? static_cast<double>(worker.busy_ns - busy_before) / (interval * 1e9) : 0.0;
+        busy = std::clamp(busy, 0.0, 1.0);
+        int filled = static_cast<int>(busy * BAR + 0.5);
+        mvprintw(y, 1, "%3zu [", i);
+        attron(COLOR_PAIR(4));
+        for (int b = 0; b < BAR; ++b) {
+            addch(b < filled ? '#' : ' ');
+        }
+        attroff(COLOR_PAIR(4));
+        printw("] %3d%% %8llu games", static_cast<int>(busy * 100.0 + 0.5), static_cast<unsigned long long>(worker.games));
+        ++y;
+    }
+
+    // Score histogram over the occupied bucket range.
+    ++y;
+    std::size_t first = sim::SCORE_BUCKETS;
+    std::size_t last = 0;
+    std::uint64_t peak = 0;
+    for (std::size_t b = 0; b < sim::SCORE_BUCKETS; ++b) {
+        if (stats.score_histogram[b] > 0) {
+            first = std::min(first, b);
+            last = b;
+            peak = std::max(peak, stats.score_histogram[b]);
+        }
+    }
+    if (y < rows - 1) {
+        mvprintw(y++, 1, "Scores");
+    }
+    int histogram_width = std::max(10, std::min(cols, 80) - 40);
+    for (std::size_t b = first; b <= last && first < sim::SCORE_BUCKETS && y < rows - 1; ++b, ++y) {
+        unsigned long low = b == 0 ? 0ul : 1ul << (b - 1);
+        if (b == 0) {
+            mvprintw(y, 1, "%15s |", "0");
+        } else if (b + 1 == sim::SCORE_BUCKETS) {
+            mvprintw(y, 1, "%14lu+ |", low);
+        } else {
+            mvprintw(y, 1, "%7lu-%7lu |", low, (1ul << b) - 1);
+        }
+        int length = static_cast<int>(static_cast<double>(stats.score_histogram[b]) / static_cast<double>(peak) *
+                                      histogram_width);
+        attron(COLOR_PAIR(1));
+        for (int i = 0; i < length; ++i) {
+            addch(' ' | A_REVERSE);
+        }
+        attroff(COLOR_PAIR(1));
+        printw(" %llu", static_cast<unsigned long long>(stats.score_histogram[b]));
+    }
+
+    // As many sampled games as fit on the right, starting at a rotating worker.
+    int boards_fit = std::max(0, (cols - 60) / (MINI_BOARD_WIDTH + 1));
+    if (!samples.empty() && rows >= core::BOARD_HEIGHT + 4) {
+        std::size_t shown = std::min<std::size_t>(static_cast<std::size_t>(boards_fit), samples.size());
+        std::size_t offset = (dashboard_frames_ / ROTATE_EVERY) % samples.size();
+        for (std::size_t i = 0; i < shown; ++i) {
+            std::size_t worker = (offset + i) % samples.size();
+            int left = cols - static_cast<int>(shown - i) * (MINI_BOARD_WIDTH + 1);
+            mvprintw(1, left, "w%zu %d", worker, samples[worker].score);
+            draw_mini_board(samples[worker], 2, left);
+        }
+    }
+
+    mvprintw(rows - 1, 1, "x: stop");
+    refresh();
+    dashboard_elapsed_ = stats.elapsed;
+    dashboard_games_ = stats.games;
+    dashboard_pieces_ = stats.pieces;
+    dashboard_busy_ns_.resize(stats.workers.size());
+    for (std::size_t i = 0; i < stats.workers.size(); ++i) {
+        dashboard_busy_ns_[i] = stats.workers[i].busy_ns;
+    }
+    ++dashboard_frames_;
+}
+
+void NcursesFrontend::draw_mini_board(const core::GameState &state, int top, int left) {
+    mvaddch(top, left, ACS_ULCORNER);
+    mvaddch(top + core::BOARD_HEIGHT + 1, left, ACS_LLCORNER);
+    mvaddch(top, left + core::BOARD_WIDTH + 1, ACS_URCORNER);
+    mvaddch(top + core::BOARD_HEIGHT + 1, left + core::BOARD_WIDTH + 1, ACS_LRCORNER);
+    for (int x = 1; x <= core::BOARD_WIDTH; ++x) {
+        mvaddch(top, left + x, ACS_HLINE);
+        mvaddch(top + core::BOARD_HEIGHT + 1, left + x, ACS_HLINE);
+    }
+    auto board = state.board;
+    const auto &piece = state.active_piece;
+    for (const auto &cell : core::tetromino_shape(piece.type)[static_cast<std::size_t>(piece.rotation)]) {
+        int x = piece.position.x + cell.x;
+        int y = piece.position.y + cell.y;
+        if (!state.game_over && y >= 0 && y < core::BOARD_HEIGHT && x >= 0 && x < core::BOARD_WIDTH) {
+            board[y][x] = static_cast<int>(piece.type);
+        }
+    }
+    for (int y = 0; y < core::BOARD_HEIGHT; ++y) {
+        mvaddch(top + 1 + y, left, ACS_VLINE);
+        mvaddch(top + 1 + y, left + core::BOARD_WIDTH + 1, ACS_VLINE);
+        for (int x = 0; x < core::BOARD_WIDTH; ++x) {
+            int cell = board[y][x];
+            if (cell < 0) {
+                mvaddch(top + 1 + y, left + 1 + x, ' ');
+            } else if (cell == core::GARBAGE_CELL) {
+                mvaddch(top + 1 + y, left + 1 + x, '#');
+            } else {
+                short color = color_for(static_cast<core::TetrominoType>(cell));
+                attron(COLOR_PAIR(color));
+                mvaddch(top + 1 + y, left + 1 + x, ' ' | A_REVERSE);
+                attroff(COLOR_PAIR(color));
+            }
+        }
+    }
+}
+
 } // namespace cretris::frontend
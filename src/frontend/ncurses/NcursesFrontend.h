@@ -3,6 +3,15 @@
 #include "../Frontend.h"
 
 #include <array>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace cretris::sim {
+struct SimulationStats;
+}
 
 namespace cretris::frontend {
 
@@ -13,13 +22,39 @@ public:
     core::InputAction poll_input() override;
     void shutdown() override;
     void sleep_for(std::chrono::milliseconds duration) override;
+    core::InputAction wait_input(std::chrono::milliseconds timeout) override;
+    void wake() override;
+    std::chrono::steady_clock::time_point last_input_time() const override { return last_input_time_; }
+    FrameTiming last_frame() const override { return last_frame_; }
+    void inject_input(core::InputAction action) override;
+    void set_hint(const std::optional<core::Tetromino> &hint) override;
+
+    // Live view of a headless simulation run: throughput, per-worker
+    // utilisation, the score histogram and a few sampled games, rotating.
+    void render_dashboard(const sim::SimulationStats &stats, std::span<const core::GameState> samples);
 
 private:
     void draw_board(const core::GameState &state);
     void draw_next_preview(const core::GameState &state);
     void draw_stats(const core::GameState &state);
+    void draw_mini_board(const core::GameState &state, int top, int left);
 
     bool initialized_{false};
+    bool needs_redraw_{true}; // first frame or terminal resized
+    std::array<int, 2> wake_pipe_{-1, -1}; // written by wake(), polled beside stdin
+    std::uint64_t last_version_{0};
+    std::optional<core::Tetromino> hint_{};
+    std::chrono::steady_clock::time_point last_input_time_{};
+    std::chrono::steady_clock::time_point injected_at_{}; // stamp for an ungetch'd key not yet read
+    bool injected_{false};
+    FrameTiming last_frame_{};
+
+    // Counters as of the previous dashboard frame, for per-interval rates.
+    std::chrono::nanoseconds dashboard_elapsed_{0};
+    std::uint64_t dashboard_games_{0};
+    std::uint64_t dashboard_pieces_{0};
+    std::vector<std::uint64_t> dashboard_busy_ns_{}; // per worker
+    std::size_t dashboard_frames_{0};
 };
 
 } // namespace cretris::frontend
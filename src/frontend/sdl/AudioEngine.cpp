@@ -121,6 +121,27 @@ void AudioEngine::set_level_progress(float progress) {
     tempo_mod_.store(std::clamp(progress, 0.0f, 1.0f));
 }
 
+void AudioEngine::on_events(const core::GameEvents &events) {
+    for (const auto &event : events) {
+        switch (event.type) {
+        case core::GameEventType::HardDrop:
+            trigger_hard_drop();
+            break;
+        case core::GameEventType::LinesCleared:
+            trigger_line_clear();
+            break;
+        case core::GameEventType::LevelChanged:
+            if (core::MAX_LEVEL > 1) {
+                set_level_progress(static_cast<float>(event.value - 1) / static_cast<float>(core::MAX_LEVEL - 1));
+            }
+            break;
+        case core::GameEventType::PieceLocked:
+        case core::GameEventType::GameOver:
+            break;
+        }
+    }
+}
+
 void AudioEngine::audio_callback(void *userdata, Uint8 *stream, int len) {
     auto *self = static_cast<AudioEngine *>(userdata);
     if (!self || self->device_ == 0) {
@@ -128,8 +149,16 @@ void AudioEngine::audio_callback(void *userdata, Uint8 *stream, int len) {
         return;
     }
 
+    auto started = std::chrono::steady_clock::now();
     auto *buffer = reinterpret_cast<float *>(stream);
     int frames = len / (sizeof(float) * 2);
+    if (self->last_callback_ != std::chrono::steady_clock::time_point{} && self->obtained_.freq > 0) {
+        std::chrono::duration<double> period{static_cast<double>(frames) / self->obtained_.freq};
+        if (started - self->last_callback_ > period * 1.5) {
+            self->underruns_->inc();
+        }
+    }
+    self->last_callback_ = started;
     float line = self->line_pulse_.load();
     float drop = self->drop_pulse_.load();
     float tempo_mod = self->tempo_mod_.load();
@@ -242,6 +271,8 @@ void AudioEngine::audio_callback(void *userdata, Uint8 *stream, int len) {
 
     self->line_pulse_.store(line);
     self->drop_pulse_.store(drop);
+    self->callback_seconds_->observe(
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count());
 }
 
 } // namespace cretris::frontend
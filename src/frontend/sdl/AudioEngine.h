@@ -1,8 +1,12 @@
 #pragma once
 
+#include "../../core/Game.h"
+#include "../../metrics/Metrics.h"
+
 #include <SDL2/SDL.h>
 
 #include <atomic>
+#include <chrono>
 
 namespace cretris::frontend {
 
@@ -13,6 +17,7 @@ public:
     void trigger_line_clear();
     void trigger_hard_drop();
     void set_level_progress(float progress);
+    void on_events(const core::GameEvents &events); // drop and clear cues, tempo on level changes
 
 private:
     static void audio_callback(void *userdata, Uint8 *stream, int len);
@@ -40,6 +45,14 @@ private:
     std::atomic<float> line_pulse_{0.0f};
     std::atomic<float> drop_pulse_{0.0f};
     std::atomic<float> tempo_mod_{0.0f};
+
+    // Audio-thread only. A callback arriving more than half a buffer late means
+    // the device ran dry in between.
+    std::chrono::steady_clock::time_point last_callback_{};
+    metrics::Histogram *callback_seconds_{&metrics::registry().histogram(
+        "cretris_audio_callback_seconds", "Time spent synthesising one audio buffer.", metrics::latency_bounds())};
+    metrics::Counter *underruns_{
+        &metrics::registry().counter("cretris_audio_underruns_total", "Audio callbacks that arrived too late.")};
 };
 
 } // namespace cretris::frontend
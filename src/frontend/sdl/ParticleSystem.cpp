@@ -0,0 +1,107 @@
+#include "ParticleSystem.h"
+
+#include "../../core/Tetromino.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace cretris::frontend {
+
+namespace {
+
+constexpr float GRAVITY = 900.0f; // px/s^2
+constexpr float DRAG = 2.5f;      // velocity lost per second, exponential
+
+} // namespace
+
+ParticleSystem::ParticleSystem()
+    : x_(CAPACITY), y_(CAPACITY), vx_(CAPACITY), vy_(CAPACITY), life_(CAPACITY), inv_life_(CAPACITY),
+      size_px_(CAPACITY), color_(CAPACITY), vertices_(CAPACITY * 4), indices_(CAPACITY * 6) {
+    for (std::size_t i = 0; i < CAPACITY; ++i) {
+        int base = static_cast<int>(i * 4);
+        const int corners[6] = {0, 1, 2, 0, 2, 3};
+        for (std::size_t c = 0; c < 6; ++c) {
+            indices_[i * 6 + c] = base + corners[c];
+        }
+    }
+}
+
+float ParticleSystem::random_unit() {
+    auto draw = core::counter_random(0x9e3779b97f4a7c15ull, draws_++);
+    return static_cast<float>(draw >> 40) * 0x1.0p-23f - 1.0f;
+}
+
+void ParticleSystem::emit(std::size_t count, const Emitter &emitter) {
+    count = std::min(count, CAPACITY - size_);
+    for (std::size_t n = 0; n < count; ++n) {
+        std::size_t i = size_++;
+        x_[i] = emitter.x + emitter.w * (0.5f + 0.5f * random_unit());
+        y_[i] = emitter.y + emitter.h * (0.5f + 0.5f * random_unit());
+        vx_[i] = emitter.vx + emitter.jitter * random_unit();
+        vy_[i] = emitter.vy + emitter.jitter * random_unit();
+        float life = emitter.life * (1.0f + 0.25f * random_unit());
+        life_[i] = life;
+        inv_life_[i] = 1.0f / life;
+        size_px_[i] = emitter.size;
+        color_[i] = emitter.color;
+    }
+}
+
+void ParticleSystem::update(float seconds) {
+    float damp = std::exp(-DRAG * seconds);
+    float fall = GRAVITY * seconds;
+    float *x = x_.data();
+    float *y = y_.data();
+    float *vx = vx_.data();
+    float *vy = vy_.data();
+    float *life = life_.data();
+    for (std::size_t i = 0; i < size_; ++i) {
+        vx[i] *= damp;
+        vy[i] = (vy[i] + fall) * damp;
+        x[i] += vx[i] * seconds;
+        y[i] += vy[i] * seconds;
+        life[i] -= seconds;
+    }
+
+    // Retire expired particles by moving the last live one into their slot.
+    for (std::size_t i = 0; i < size_;) {
+        if (life[i] > 0.0f) {
+            ++i;
+            continue;
+        }
+        std::size_t last = --size_;
+        x[i] = x[last];
+        y[i] = y[last];
+        vx[i] = vx[last];
+        vy[i] = vy[last];
+        life[i] = life[last];
+        inv_life_[i] = inv_life_[last];
+        size_px_[i] = size_px_[last];
+        color_[i] = color_[last];
+    }
+}
+
+int ParticleSystem::draw(SDL_Renderer *renderer) {
+    if (size_ == 0) {
+        return 0;
+    }
+    for (std::size_t i = 0; i < size_; ++i) {
+        float half = 0.5f * size_px_[i];
+        float left = x_[i] - half;
+        float top = y_[i] - half;
+        float right = x_[i] + half;
+        float bottom = y_[i] + half;
+        SDL_Color color = color_[i];
+        color.a = static_cast<Uint8>(static_cast<float>(color.a) * std::min(1.0f, life_[i] * inv_life_[i]));
+        SDL_Vertex *quad = &vertices_[i * 4];
+        quad[0] = {{left, top}, color, {0.0f, 0.0f}};
+        quad[1] = {{right, top}, color, {0.0f, 0.0f}};
+        quad[2] = {{right, bottom}, color, {0.0f, 0.0f}};
+        quad[3] = {{left, bottom}, color, {0.0f, 0.0f}};
+    }
+    SDL_RenderGeometry(renderer, nullptr, vertices_.data(), static_cast<int>(size_ * 4), indices_.data(),
+                       static_cast<int>(size_ * 6));
+    return 1;
+}
+
+} // namespace cretris::frontend
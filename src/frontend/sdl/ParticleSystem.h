@@ -0,0 +1,67 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace cretris::frontend {
+
+// Fixed-capacity particle pool for the SDL front end. Particles are stored
+// structure-of-arrays and packed at the front, so update() is a handful of
+// straight loops over float arrays that the compiler vectorises; a dead
+// particle is replaced by the last live one. Everything is allocated up
+// front, and the whole pool draws as one SDL_RenderGeometry call.
+class ParticleSystem {
+public:
+    static constexpr std::size_t CAPACITY = 8192;
+
+    // Particles start uniformly inside the box at (x, y), size w x h, moving at
+    // (vx, vy) plus up to `jitter` in each axis, and fade out over `life`
+    // seconds, give or take a quarter.
+    struct Emitter {
+        float x{};
+        float y{};
+        float w{0.0f};
+        float h{0.0f};
+        float vx{0.0f};
+        float vy{0.0f};
+        float jitter{0.0f};
+        float life{0.5f};
+        float size{3.0f};
+        SDL_Color color{255, 255, 255, 255};
+    };
+
+    ParticleSystem();
+
+    // Adds up to `count` particles; past capacity the rest are dropped.
+    void emit(std::size_t count, const Emitter &emitter);
+    // Advances every particle by `seconds` and retires the expired ones.
+    void update(float seconds);
+    // Returns the number of draw calls issued: 0 or 1.
+    int draw(SDL_Renderer *renderer);
+    void clear() noexcept { size_ = 0; }
+
+    std::size_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+
+private:
+    float random_unit(); // in [-1, 1)
+
+    std::size_t size_{0};
+    std::uint64_t draws_{0};
+    std::vector<float> x_;
+    std::vector<float> y_;
+    std::vector<float> vx_;
+    std::vector<float> vy_;
+    std::vector<float> life_;     // seconds left
+    std::vector<float> inv_life_; // 1 / initial life, for the fade
+    std::vector<float> size_px_;
+    std::vector<SDL_Color> color_;
+
+    std::vector<SDL_Vertex> vertices_;
+    std::vector<int> indices_; // two triangles per particle, built once for the whole capacity
+};
+
+} // namespace cretris::frontend
@@ -1,15 +1,16 @@
 #include "SdlFrontend.h"
 
+#include "../../render/PixelFont.h"
+
 #include <SDL2/SDL.h>
 
 #include <algorithm>
+#include <limits>
 #include <array>
-#include <cctype>
 #include <chrono>
 #include <cmath>
 #include <initializer_list>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 namespace cretris::frontend {
@@ -25,94 +26,19 @@ constexpr int BOARD_ORIGIN_X = 140;
 constexpr int BOARD_ORIGIN_Y = 50;
 constexpr int INDICATOR_TRACK_MARGIN = 8;
 constexpr int INDICATOR_TRACK_HEIGHT = 12;
-constexpr int FONT_WIDTH = 5;
-constexpr int FONT_HEIGHT = 5;
 constexpr float PI = 3.14159265f;
 constexpr std::chrono::milliseconds LINE_FLASH_DURATION{450};
 
-struct Glyph {
-    std::array<uint8_t, FONT_HEIGHT> rows{};
-};
+using render::FONT_HEIGHT;
+using render::FONT_WIDTH;
+using render::Glyph;
+using render::glyph_for;
 
-Glyph glyph_from_strings(std::initializer_list<const char *> pattern) {
-    Glyph glyph{};
-    int row = 0;
-    for (const char *line : pattern) {
-        uint8_t bits = 0;
-        for (int col = 0; col < FONT_WIDTH && line[col] != '\0'; ++col) {
-            if (line[col] != ' ') {
-                bits |= static_cast<uint8_t>(1u << (FONT_WIDTH - 1 - col));
-            }
-        }
-        if (row < FONT_HEIGHT) {
-            glyph.rows[static_cast<std::size_t>(row)] = bits;
-        }
-        ++row;
-    }
-    return glyph;
-}
-
-const std::unordered_map<char, Glyph> &glyph_map() {
-    static const std::unordered_map<char, Glyph> map = {
-        {'A', glyph_from_strings({"  #  ", " # # ", "#####", "#   #", "#   #"})},
-        {'B', glyph_from_strings({"#### ", "#   #", "#### ", "#   #", "#### "})},
-        {'C', glyph_from_strings({" ####", "#    ", "#    ", "#    ", " ####"})},
-        {'D', glyph_from_strings({"###  ", "#  # ", "#   #", "#  # ", "###  "})},
-        {'E', glyph_from_strings({"#####", "#    ", "#### ", "#    ", "#####"})},
-        {'F', glyph_from_strings({"#####", "#    ", "#### ", "#    ", "#    "})},
-        {'G', glyph_from_strings({" ####", "#    ", "# ###", "#   #", " ####"})},
-        {'H', glyph_from_strings({"#   #", "#   #", "#####", "#   #", "#   #"})},
-        {'I', glyph_from_strings({"#####", "  #  ", "  #  ", "  #  ", "#####"})},
-        {'J', glyph_from_strings({"  ###", "   # ", "   # ", "#  # ", " ##  "})},
-        {'K', glyph_from_strings({"#   #", "#  # ", "###  ", "#  # ", "#   #"})},
-        {'L', glyph_from_strings({"#    ", "#    ", "#    ", "#    ", "#####"})},
-        {'M', glyph_from_strings({"#   #", "## ##", "# # #", "#   #", "#   #"})},
-        {'N', glyph_from_strings({"#   #", "##  #", "# # #", "#  ##", "#   #"})},
-        {'O', glyph_from_strings({" ### ", "#   #", "#   #", "#   #", " ### "})},
-        {'P', glyph_from_strings({"#### ", "#   #", "#### ", "#    ", "#    "})},
-        {'Q', glyph_from_strings({" ### ", "#   #", "#   #", "#  ##", " ####"})},
-        {'R', glyph_from_strings({"#### ", "#   #", "#### ", "#  # ", "#   #"})},
-        {'S', glyph_from_strings({" ####", "#    ", " ### ", "    #", "#### "})},
-        {'T', glyph_from_strings({"#####", "  #  ", "  #  ", "  #  ", "  #  "})},
-        {'U', glyph_from_strings({"#   #", "#   #", "#   #", "#   #", " ### "})},
-        {'V', glyph_from_strings({"#   #", "#   #", "#   #", " # # ", "  #  "})},
-        {'W', glyph_from_strings({"#   #", "#   #", "# # #", "## ##", "#   #"})},
-        {'X', glyph_from_strings({"#   #", " # # ", "  #  ", " # # ", "#   #"})},
-        {'Y', glyph_from_strings({"#   #", " # # ", "  #  ", "  #  ", "  #  "})},
-        {'Z', glyph_from_strings({"#####", "   # ", "  #  ", " #   ", "#####"})},
-        {'0', glyph_from_strings({" ### ", "#  ##", "# # #", "##  #", " ### "})},
-        {'1', glyph_from_strings({"  #  ", " ##  ", "  #  ", "  #  ", " ### "})},
-        {'2', glyph_from_strings({" ### ", "#   #", "   # ", "  #  ", "#####"})},
-        {'3', glyph_from_strings({" ### ", "    #", " ### ", "    #", " ### "})},
-        {'4', glyph_from_strings({"#   #", "#   #", "#####", "    #", "    #"})},
-        {'5', glyph_from_strings({"#####", "#    ", "#### ", "    #", "#### "})},
-        {'6', glyph_from_strings({" ####", "#    ", "#### ", "#   #", " ### "})},
-        {'7', glyph_from_strings({"#####", "    #", "   # ", "  #  ", "  #  "})},
-        {'8', glyph_from_strings({" ### ", "#   #", " ### ", "#   #", " ### "})},
-        {'9', glyph_from_strings({" ### ", "#   #", " ####", "    #", " ### "})},
-        {':', glyph_from_strings({"     ", "  #  ", "     ", "  #  ", "     "})},
-        {'-', glyph_from_strings({"     ", "     ", "#####", "     ", "     "})}
-    };
-    return map;
-}
-
-const Glyph *glyph_for(char c) {
-    if (c == ' ') {
-        return nullptr;
-    }
-    char upper = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
-    const auto &map = glyph_map();
-    auto it = map.find(upper);
-    if (it == map.end()) {
-        return nullptr;
-    }
-    return &it->second;
-}
-
-std::array<SDL_Color, static_cast<std::size_t>(core::TetrominoType::Count)> palette() {
+// Indexed by board cell: one colour per TetrominoType, then garbage rows.
+std::array<SDL_Color, core::GARBAGE_CELL + 1> palette() {
     return {SDL_Color{0, 230, 255, 255}, SDL_Color{255, 221, 0, 255}, SDL_Color{220, 0, 255, 255},
             SDL_Color{0, 232, 125, 255}, SDL_Color{255, 70, 90, 255}, SDL_Color{70, 100, 255, 255},
-            SDL_Color{255, 150, 40, 255}};
+            SDL_Color{255, 150, 40, 255}, SDL_Color{110, 115, 135, 255}};
 }
 
 struct PieceCells {
@@ -164,12 +90,77 @@ std::vector<SDL_Point> compute_ghost(const core::GameState &state) {
     return cells;
 }
 
+// Spectator wall layout: where each board sits and how large its cells are.
+constexpr float WALL_GAP_CELLS = 1.0f;    // spacing between boards, in cells
+constexpr float WALL_DETAIL_MIN_CELL = 4.0f; // below this a cell is drawn as one atlas texel
+constexpr int WALL_ATLAS_COLUMNS = 16;
+constexpr SDL_Color WALL_EMPTY{12, 14, 34, 255};
+
+struct BoardTransform {
+    float x{};
+    float y{};
+    float cell{};
+};
+
+// Picks the column count that gives the largest cells, then centres the grid.
+std::vector<BoardTransform> wall_layout(std::size_t count, int width, int height) {
+    std::vector<BoardTransform> layout;
+    if (count == 0) {
+        return layout;
+    }
+    constexpr float board_w = static_cast<float>(core::BOARD_WIDTH) + WALL_GAP_CELLS;
+    constexpr float board_h = static_cast<float>(core::BOARD_HEIGHT) + WALL_GAP_CELLS;
+    std::size_t best_columns = 1;
+    float best_cell = 0.0f;
+    for (std::size_t columns = 1; columns <= count; ++columns) {
+        std::size_t rows = (count + columns - 1) / columns;
+        float cell = std::min(static_cast<float>(width) / (static_cast<float>(columns) * board_w),
+                              static_cast<float>(height) / (static_cast<float>(rows) * board_h));
+        if (cell > best_cell) {
+            best_cell = cell;
+            best_columns = columns;
+        }
+    }
+    if (best_cell >= WALL_DETAIL_MIN_CELL) {
+        best_cell = std::floor(best_cell); // whole pixels keep cell edges crisp
+    }
+    std::size_t rows = (count + best_columns - 1) / best_columns;
+    float origin_x = (static_cast<float>(width) - static_cast<float>(best_columns) * board_w * best_cell) * 0.5f;
+    float origin_y = (static_cast<float>(height) - static_cast<float>(rows) * board_h * best_cell) * 0.5f;
+    float margin = WALL_GAP_CELLS * 0.5f * best_cell;
+    layout.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        layout.push_back({origin_x + static_cast<float>(i % best_columns) * board_w * best_cell + margin,
+                          origin_y + static_cast<float>(i / best_columns) * board_h * best_cell + margin, best_cell});
+    }
+    return layout;
+}
+
+SDL_Color dimmed(SDL_Color color, bool dim) {
+    if (!dim) {
+        return color;
+    }
+    return SDL_Color{static_cast<Uint8>(color.r / 3), static_cast<Uint8>(color.g / 3), static_cast<Uint8>(color.b / 3),
+                     color.a};
+}
+
+void push_quad(std::vector<SDL_Vertex> &vertices, std::vector<int> &indices, SDL_FRect rect, SDL_Color color,
+               SDL_FRect uv = {0.0f, 0.0f, 0.0f, 0.0f}) {
+    int base = static_cast<int>(vertices.size());
+    vertices.push_back({{rect.x, rect.y}, color, {uv.x, uv.y}});
+    vertices.push_back({{rect.x + rect.w, rect.y}, color, {uv.x + uv.w, uv.y}});
+    vertices.push_back({{rect.x + rect.w, rect.y + rect.h}, color, {uv.x + uv.w, uv.y + uv.h}});
+    vertices.push_back({{rect.x, rect.y + rect.h}, color, {uv.x, uv.y + uv.h}});
+    for (int corner : {0, 1, 2, 0, 2, 3}) {
+        indices.push_back(base + corner);
+    }
+}
+
 } // namespace
 
 void SdlFrontend::initialize(const core::GameState &state) {
     if (initialized_) {
-        last_state_ = state;
-        last_state_initialized_ = true;
+        needs_redraw_ = true;
         return;
     }
 
@@ -178,6 +169,7 @@ void SdlFrontend::initialize(const core::GameState &state) {
         return;
     }
 
+    ticks_epoch_ = std::chrono::steady_clock::now() - std::chrono::milliseconds{SDL_GetTicks()};
     SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "1");
     window_ = SDL_CreateWindow("Cretris", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, WINDOW_WIDTH, WINDOW_HEIGHT,
                                SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE);
@@ -188,6 +180,10 @@ void SdlFrontend::initialize(const core::GameState &state) {
     }
 
     renderer_ = SDL_CreateRenderer(window_, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+    if (!renderer_) {
+        // No GPU, or SDL_VIDEODRIVER=dummy: draw into the window surface on the CPU.
+        renderer_ = SDL_CreateRenderer(window_, -1, SDL_RENDERER_SOFTWARE);
+    }
     if (!renderer_) {
         SDL_Log("Renderer creation failed: %s", SDL_GetError());
         SDL_DestroyWindow(window_);
@@ -197,67 +193,106 @@ void SdlFrontend::initialize(const core::GameState &state) {
     }
     SDL_SetRenderDrawBlendMode(renderer_, SDL_BLENDMODE_BLEND);
 
-    last_state_ = state;
-    last_state_initialized_ = true;
+    needs_redraw_ = true;
     initialized_ = true;
 
     audio_ = std::make_unique<AudioEngine>();
     audio_->initialize();
+    if (core::MAX_LEVEL > 1) {
+        audio_->set_level_progress(static_cast<float>(state.level - 1) / static_cast<float>(core::MAX_LEVEL - 1));
+    }
+}
+
+bool SdlFrontend::initialize_offscreen(int width, int height) {
+    if (initialized_) {
+        needs_redraw_ = true;
+        return true;
+    }
+    surface_ = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (!surface_) {
+        SDL_Log("Surface creation failed: %s", SDL_GetError());
+        return false;
+    }
+    renderer_ = SDL_CreateSoftwareRenderer(surface_);
+    if (!renderer_) {
+        SDL_Log("Renderer creation failed: %s", SDL_GetError());
+        SDL_FreeSurface(surface_);
+        surface_ = nullptr;
+        return false;
+    }
+    SDL_SetRenderDrawBlendMode(renderer_, SDL_BLENDMODE_BLEND);
+    needs_redraw_ = true;
+    initialized_ = true;
+    return true;
 }
 
 void SdlFrontend::render(const core::GameState &state) {
     if (!initialized_ || !renderer_) {
         return;
     }
-
-    if (last_state_initialized_) {
-        int line_delta = state.total_lines - last_state_.total_lines;
-        if (line_delta > 0) {
-            line_flash_active_ = true;
-            line_flash_start_ = std::chrono::steady_clock::now();
-            line_flash_count_ = std::clamp(line_delta, 1, 4);
-            line_flash_rows_.clear();
-            for (int y = core::BOARD_HEIGHT - 1;
-                 y >= 0 && static_cast<int>(line_flash_rows_.size()) < line_flash_count_; --y) {
-                bool previous_full = true;
-                for (int x = 0; x < core::BOARD_WIDTH; ++x) {
-                    if (last_state_.board[y][x] == -1) {
-                        previous_full = false;
-                        break;
-                    }
-                }
-                if (previous_full) {
-                    line_flash_rows_.push_back(y);
-                }
-            }
-            if (line_flash_rows_.empty()) {
-                line_flash_rows_.push_back(core::BOARD_HEIGHT - 1);
-            }
-        }
+    if (state.version == last_version_ && !line_flash_active_ && particles_.empty() && !needs_redraw_) {
+        return;
+    }
+    needs_redraw_ = false;
+    if (state.version != last_version_) {
+        // Animation frames redraw an unchanged state and leave the copy alone.
+        last_version_ = state.version;
+        last_board_ = state.board;
     }
 
+    begin_frame();
+    capture_begin();
     draw_background();
     draw_board(state);
+    draw_particles();
     draw_next_queue(state);
     draw_stats(state);
     if (state.game_over) {
         draw_game_over();
     }
-    SDL_RenderPresent(renderer_);
+    capture_end();
+    last_frame_.version = state.version;
+    last_frame_.submitted = std::chrono::steady_clock::now();
+    {
+        SectionScope scope{*this, Section::Present};
+        SDL_RenderPresent(renderer_);
+    }
+    last_frame_.returned = std::chrono::steady_clock::now();
+    end_frame();
+}
 
-    if (audio_) {
-        float normalized = 0.0f;
-        if (core::MAX_LEVEL > 1) {
-            normalized = static_cast<float>(state.level - 1) / static_cast<float>(core::MAX_LEVEL - 1);
+void SdlFrontend::set_hint(const std::optional<core::Tetromino> &hint) {
+    if (hint != hint_) {
+        hint_ = hint;
+        needs_redraw_ = true;
+    }
+}
+
+void SdlFrontend::on_events(const core::GameEvents &events) {
+    bool idle = particles_.empty();
+    int drop_distance = 0;
+    for (const auto &event : events) {
+        if (event.type == core::GameEventType::HardDrop) {
+            drop_distance = event.value; // the PieceLocked that follows draws the trail
         }
-        normalized = std::clamp(normalized, 0.0f, 1.0f);
-        audio_->set_level_progress(normalized);
-        if (last_state_initialized_ && state.total_lines > last_state_.total_lines) {
-            audio_->trigger_line_clear();
+        if (event.type == core::GameEventType::PieceLocked) {
+            emit_lock(event, drop_distance);
+            drop_distance = 0;
         }
+        if (event.type == core::GameEventType::LinesCleared && event.count > 0) {
+            line_flash_active_ = true;
+            line_flash_start_ = std::chrono::steady_clock::now();
+            line_flash_count_ = event.count;
+            std::copy_n(event.rows.begin(), event.count, line_flash_rows_.begin());
+            emit_clear(event);
+        }
+    }
+    if (idle && !particles_.empty()) {
+        particles_updated_ = std::chrono::steady_clock::now();
+    }
+    if (audio_) {
+        audio_->on_events(events);
     }
-    last_state_ = state;
-    last_state_initialized_ = true;
 }
 
 core::InputAction SdlFrontend::poll_input() {
@@ -267,12 +302,17 @@ core::InputAction SdlFrontend::poll_input() {
 
     SDL_Event event;
     while (SDL_PollEvent(&event)) {
+        // SDL stamps events in whole milliseconds since SDL_Init.
+        last_input_time_ = ticks_epoch_ + std::chrono::milliseconds{event.common.timestamp};
         if (event.type == SDL_QUIT) {
             return core::InputAction::Quit;
         }
         if (event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_CLOSE) {
             return core::InputAction::Quit;
         }
+        if (event.type == SDL_WINDOWEVENT) {
+            needs_redraw_ = true;
+        }
         if (event.type == SDL_KEYDOWN && !event.key.repeat) {
             switch (event.key.keysym.sym) {
             case SDLK_LEFT:
@@ -285,9 +325,6 @@ core::InputAction SdlFrontend::poll_input() {
             case SDLK_s:
                 return core::InputAction::SoftDrop;
             case SDLK_SPACE:
-                if (audio_) {
-                    audio_->trigger_hard_drop();
-                }
                 return core::InputAction::HardDrop;
             case SDLK_UP:
             case SDLK_w:
@@ -306,26 +343,325 @@ core::InputAction SdlFrontend::poll_input() {
 }
 
 void SdlFrontend::shutdown() {
+    stop_recording();
     if (audio_) {
         audio_->shutdown();
         audio_.reset();
     }
+    if (wall_atlas_) {
+        SDL_DestroyTexture(wall_atlas_);
+        wall_atlas_ = nullptr;
+        wall_atlas_rows_ = 0;
+    }
     if (renderer_) {
         SDL_DestroyRenderer(renderer_);
         renderer_ = nullptr;
     }
+    if (surface_) {
+        SDL_FreeSurface(surface_);
+        surface_ = nullptr;
+    }
     if (window_) {
         SDL_DestroyWindow(window_);
         window_ = nullptr;
     }
     initialized_ = false;
-    last_state_initialized_ = false;
+    line_flash_active_ = false;
+    particles_.clear();
     SDL_Quit();
 }
 
 void SdlFrontend::sleep_for(std::chrono::milliseconds duration) { SDL_Delay(static_cast<Uint32>(duration.count())); }
 
+core::InputAction SdlFrontend::wait_input(std::chrono::milliseconds timeout) {
+    if (!initialized_) {
+        return Frontend::wait_input(timeout);
+    }
+    // Leaves the event queued for poll_input; -1 waits without a deadline.
+    int wait_ms = timeout.count() >= std::numeric_limits<int>::max() ? -1 : static_cast<int>(std::max<std::int64_t>(0, timeout.count()));
+    SDL_WaitEventTimeout(nullptr, wait_ms);
+    return poll_input();
+}
+
+void SdlFrontend::wake() {
+    // SDL_PushEvent is thread-safe; poll_input discards the event.
+    SDL_Event event{};
+    event.type = SDL_USEREVENT;
+    SDL_PushEvent(&event);
+}
+
+void SdlFrontend::inject_input(core::InputAction action) {
+    SDL_Keycode key = SDLK_UNKNOWN;
+    switch (action) {
+    case core::InputAction::MoveLeft:
+        key = SDLK_LEFT;
+        break;
+    case core::InputAction::MoveRight:
+        key = SDLK_RIGHT;
+        break;
+    case core::InputAction::SoftDrop:
+        key = SDLK_DOWN;
+        break;
+    case core::InputAction::HardDrop:
+        key = SDLK_SPACE;
+        break;
+    case core::InputAction::RotateCW:
+        key = SDLK_UP;
+        break;
+    case core::InputAction::RotateCCW:
+        key = SDLK_q;
+        break;
+    case core::InputAction::Quit:
+        key = SDLK_ESCAPE;
+        break;
+    case core::InputAction::None:
+        return;
+    }
+    SDL_Event event{};
+    event.type = SDL_KEYDOWN;
+    event.key.timestamp = SDL_GetTicks();
+    event.key.state = SDL_PRESSED;
+    event.key.keysym.sym = key;
+    SDL_PushEvent(&event);
+}
+
+void SdlFrontend::render_wall(std::span<const BoardSnapshot> boards) {
+    if (!initialized_ || !renderer_) {
+        return;
+    }
+    int width = 0;
+    int height = 0;
+    SDL_GetRendererOutputSize(renderer_, &width, &height);
+    auto layout = wall_layout(boards.size(), width, height);
+    float cell = layout.empty() ? 0.0f : layout.front().cell;
+    bool detailed = cell >= WALL_DETAIL_MIN_CELL;
+
+    wall_vertices_.clear();
+    wall_indices_.clear();
+    SDL_Texture *texture = nullptr;
+    auto colors = palette();
+    if (detailed) {
+        // A backdrop per board, then one quad per filled cell with a one-pixel gutter.
+        float inset = cell >= 8.0f ? 1.0f : 0.0f;
+        for (std::size_t i = 0; i < boards.size(); ++i) {
+            const auto &board = boards[i];
+            const auto &at = layout[i];
+            push_quad(wall_vertices_, wall_indices_,
+                      {at.x, at.y, cell * core::BOARD_WIDTH, cell * core::BOARD_HEIGHT}, dimmed(WALL_EMPTY, board.game_over));
+            for (int y = 0; y < core::BOARD_HEIGHT; ++y) {
+                for (int x = 0; x < core::BOARD_WIDTH; ++x) {
+                    int value = board.at(x, y);
+                    if (value < 0) {
+                        continue;
+                    }
+                    push_quad(wall_vertices_, wall_indices_,
+                              {at.x + static_cast<float>(x) * cell + inset, at.y + static_cast<float>(y) * cell + inset,
+                               cell - 2.0f * inset, cell - 2.0f * inset},
+                              dimmed(colors[static_cast<std::size_t>(value)], board.game_over));
+                }
+            }
+        }
+    } else {
+        // One texel per cell: refresh the atlas, then one textured quad per board.
+        int atlas_rows = static_cast<int>((boards.size() + WALL_ATLAS_COLUMNS - 1) / WALL_ATLAS_COLUMNS);
+        int atlas_w = WALL_ATLAS_COLUMNS * core::BOARD_WIDTH;
+        int atlas_h = atlas_rows * core::BOARD_HEIGHT;
+        if (!wall_atlas_ || wall_atlas_rows_ != atlas_rows) {
+            if (wall_atlas_) {
+                SDL_DestroyTexture(wall_atlas_);
+            }
+            wall_atlas_ = SDL_CreateTexture(renderer_, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, atlas_w,
+                                            atlas_h);
+            wall_atlas_rows_ = wall_atlas_ ? atlas_rows : 0;
+            if (wall_atlas_) {
+                SDL_SetTextureScaleMode(wall_atlas_, SDL_ScaleModeNearest);
+            }
+        }
+        if (!wall_atlas_) {
+            return;
+        }
+        auto argb = [](SDL_Color c) {
+            return (Uint32{c.a} << 24) | (Uint32{c.r} << 16) | (Uint32{c.g} << 8) | Uint32{c.b};
+        };
+        std::array<Uint32, core::GARBAGE_CELL + 1> texels{};
+        for (std::size_t i = 0; i < texels.size(); ++i) {
+            texels[i] = argb(colors[i]);
+        }
+        Uint32 empty = argb(WALL_EMPTY);
+        wall_pixels_.assign(static_cast<std::size_t>(atlas_w) * static_cast<std::size_t>(atlas_h), empty);
+        for (std::size_t i = 0; i < boards.size(); ++i) {
+            const auto &board = boards[i];
+            std::size_t left = (i % WALL_ATLAS_COLUMNS) * core::BOARD_WIDTH;
+            std::size_t top = (i / WALL_ATLAS_COLUMNS) * core::BOARD_HEIGHT;
+            for (int y = 0; y < core::BOARD_HEIGHT; ++y) {
+                Uint32 *row = wall_pixels_.data() + (top + static_cast<std::size_t>(y)) * static_cast<std::size_t>(atlas_w) + left;
+                for (int x = 0; x < core::BOARD_WIDTH; ++x) {
+                    int value = board.at(x, y);
+                    row[x] = value < 0 ? empty : texels[static_cast<std::size_t>(value)];
+                }
+            }
+            float u = static_cast<float>(left) / static_cast<float>(atlas_w);
+            float v = static_cast<float>(top) / static_cast<float>(atlas_h);
+            const auto &at = layout[i];
+            push_quad(wall_vertices_, wall_indices_, {at.x, at.y, cell * core::BOARD_WIDTH, cell * core::BOARD_HEIGHT},
+                      dimmed(SDL_Color{255, 255, 255, 255}, board.game_over),
+                      {u, v, static_cast<float>(core::BOARD_WIDTH) / static_cast<float>(atlas_w),
+                       static_cast<float>(core::BOARD_HEIGHT) / static_cast<float>(atlas_h)});
+        }
+        SDL_UpdateTexture(wall_atlas_, nullptr, wall_pixels_.data(), atlas_w * static_cast<int>(sizeof(Uint32)));
+        texture = wall_atlas_;
+    }
+
+    begin_frame();
+    SDL_SetRenderDrawColor(renderer_, 4, 4, 12, 255);
+    SDL_RenderClear(renderer_);
+    if (!wall_indices_.empty()) {
+        SDL_RenderGeometry(renderer_, texture, wall_vertices_.data(), static_cast<int>(wall_vertices_.size()),
+                           wall_indices_.data(), static_cast<int>(wall_indices_.size()));
+        ++frame_draw_calls_;
+    }
+    SDL_RenderPresent(renderer_);
+    end_frame();
+    wall_stats_ = {static_cast<int>(last_frame_draw_calls_), wall_vertices_.size(), cell, detailed};
+}
+
+bool SdlFrontend::start_recording(const std::string &path, int fps) {
+    if (!initialized_ || !renderer_ || (video_ && video_->recording())) {
+        return false;
+    }
+    int width = 0;
+    int height = 0;
+    SDL_GetRendererOutputSize(renderer_, &width, &height);
+    for (auto &target : capture_targets_) {
+        target = SDL_CreateTexture(renderer_, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, width, height);
+        if (!target) {
+            SDL_Log("Capture target creation failed: %s", SDL_GetError());
+            stop_recording();
+            return false;
+        }
+    }
+    video_ = std::make_unique<VideoRecorder>();
+    if (!video_->open(path, width, height, fps)) {
+        SDL_Log("Could not open %s for recording", path.c_str());
+        video_.reset();
+        stop_recording();
+        return false;
+    }
+    capture_current_ = 0;
+    capture_pending_ = false;
+    needs_redraw_ = true;
+    return true;
+}
+
+void SdlFrontend::stop_recording() {
+    if (video_ && video_->recording()) {
+        if (capture_pending_) {
+            read_back(capture_targets_[capture_current_ ^ 1]);
+            SDL_SetRenderTarget(renderer_, nullptr);
+        }
+        video_->close(std::chrono::steady_clock::now());
+    }
+    for (auto &target : capture_targets_) {
+        if (target) {
+            SDL_DestroyTexture(target);
+            target = nullptr;
+        }
+    }
+    capture_pending_ = false;
+}
+
+void SdlFrontend::capture_begin() {
+    if (!video_ || !video_->recording()) {
+        return;
+    }
+    SectionScope scope{*this, Section::Capture};
+    if (capture_pending_) {
+        read_back(capture_targets_[capture_current_ ^ 1]);
+    }
+    // Draws at the size recording started with, whatever the window does since.
+    SDL_SetRenderTarget(renderer_, capture_targets_[capture_current_]);
+}
+
+void SdlFrontend::capture_end() {
+    if (!video_ || !video_->recording()) {
+        return;
+    }
+    SectionScope scope{*this, Section::Capture};
+    SDL_SetRenderTarget(renderer_, nullptr);
+    SDL_RenderCopy(renderer_, capture_targets_[capture_current_], nullptr, nullptr);
+    ++frame_draw_calls_;
+    capture_pending_ = true;
+    capture_pending_shown_ = std::chrono::steady_clock::now();
+    capture_current_ ^= 1;
+}
+
+void SdlFrontend::read_back(SDL_Texture *target) {
+    capture_pending_ = false;
+    auto *pixels = video_->acquire();
+    if (!pixels) {
+        return; // the writer is behind: skip the frame rather than wait
+    }
+    SDL_SetRenderTarget(renderer_, target);
+    SDL_RenderReadPixels(renderer_, nullptr, SDL_PIXELFORMAT_ARGB8888, pixels,
+                         video_->width() * static_cast<int>(sizeof(std::uint32_t)));
+    video_->submit(capture_pending_shown_);
+}
+
+void SdlFrontend::begin_frame() {
+    frame_start_ = std::chrono::steady_clock::now();
+    frame_draw_calls_ = 0;
+    profile_ = {};
+    section_ = Section::Count;
+}
+
+void SdlFrontend::end_frame() {
+    frame_seconds_->observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - frame_start_).count());
+    draw_calls_->inc(frame_draw_calls_);
+    last_frame_draw_calls_ = frame_draw_calls_;
+    if (profiling_) {
+        last_profile_ = profile_;
+    }
+}
+
+SdlFrontend::Section SdlFrontend::enter_section(Section section) {
+    Section previous = section_;
+    if (!profiling_) {
+        return previous;
+    }
+    auto now = std::chrono::steady_clock::now();
+    if (previous != Section::Count) {
+        auto &cost = profile_[static_cast<std::size_t>(previous)];
+        cost.time += now - section_start_;
+        cost.draw_calls += frame_draw_calls_ - section_draw_calls_;
+    }
+    section_ = section;
+    section_start_ = now;
+    section_draw_calls_ = frame_draw_calls_;
+    return previous;
+}
+
+SdlFrontend::SectionScope::SectionScope(SdlFrontend &frontend, Section section)
+    : frontend_{frontend}, previous_{frontend.enter_section(section)} {}
+
+SdlFrontend::SectionScope::~SectionScope() { frontend_.enter_section(previous_); }
+
+void SdlFrontend::fill_rect(const SDL_Rect *rect) {
+    ++frame_draw_calls_;
+    SDL_RenderFillRect(renderer_, rect);
+}
+
+void SdlFrontend::draw_rect(const SDL_Rect *rect) {
+    ++frame_draw_calls_;
+    SDL_RenderDrawRect(renderer_, rect);
+}
+
+void SdlFrontend::draw_line(int x1, int y1, int x2, int y2) {
+    ++frame_draw_calls_;
+    SDL_RenderDrawLine(renderer_, x1, y1, x2, y2);
+}
+
 void SdlFrontend::draw_background() {
+    SectionScope scope{*this, Section::Background};
     SDL_Rect viewport;
     SDL_RenderGetViewport(renderer_, &viewport);
     for (int y = 0; y < viewport.h; ++y) {
@@ -333,20 +669,21 @@ void SdlFrontend::draw_background() {
         SDL_Color color{static_cast<Uint8>(5 + 20 * t), static_cast<Uint8>(10 + 40 * t), static_cast<Uint8>(35 + 120 * t),
                         255};
         SDL_SetRenderDrawColor(renderer_, color.r, color.g, color.b, color.a);
-        SDL_RenderDrawLine(renderer_, 0, y, viewport.w, y);
+        draw_line(0, y, viewport.w, y);
     }
 
     SDL_SetRenderDrawColor(renderer_, 255, 255, 255, 12);
     for (int x = 0; x < viewport.w; x += 20) {
-        SDL_RenderDrawLine(renderer_, x, 0, x, viewport.h);
+        draw_line(x, 0, x, viewport.h);
     }
     SDL_SetRenderDrawColor(renderer_, 255, 255, 255, 22);
     for (int y = 0; y < viewport.h; y += 20) {
-        SDL_RenderDrawLine(renderer_, 0, y, viewport.w, y);
+        draw_line(0, y, viewport.w, y);
     }
 }
 
 void SdlFrontend::draw_board(const core::GameState &state) {
+    SectionScope scope{*this, Section::Board};
     auto buffer = state.board;
     const auto &shape = core::tetromino_shape(state.active_piece.type);
     const auto &mask = shape[static_cast<std::size_t>(state.active_piece.rotation)];
@@ -360,22 +697,22 @@ void SdlFrontend::draw_board(const core::GameState &state) {
 
     SDL_Rect panel{BOARD_ORIGIN_X - 35, BOARD_ORIGIN_Y - 35, BOARD_WIDTH_PX + 70, BOARD_HEIGHT_PX + 70};
     SDL_SetRenderDrawColor(renderer_, 10, 10, 22, 220);
-    SDL_RenderFillRect(renderer_, &panel);
+    fill_rect(&panel);
     SDL_SetRenderDrawColor(renderer_, 255, 255, 255, 60);
-    SDL_RenderDrawRect(renderer_, &panel);
+    draw_rect(&panel);
 
     SDL_Rect board_border{BOARD_ORIGIN_X - 6, BOARD_ORIGIN_Y - 6, BOARD_WIDTH_PX + 12, BOARD_HEIGHT_PX + 12};
     SDL_SetRenderDrawColor(renderer_, 0, 0, 0, 200);
-    SDL_RenderFillRect(renderer_, &board_border);
+    fill_rect(&board_border);
     SDL_SetRenderDrawColor(renderer_, 0, 250, 220, 90);
-    SDL_RenderDrawRect(renderer_, &board_border);
+    draw_rect(&board_border);
     SDL_Rect board_inner_border{BOARD_ORIGIN_X - 2, BOARD_ORIGIN_Y - 2, BOARD_WIDTH_PX + 4, BOARD_HEIGHT_PX + 4};
     SDL_SetRenderDrawColor(renderer_, 255, 255, 255, 40);
-    SDL_RenderDrawRect(renderer_, &board_inner_border);
+    draw_rect(&board_inner_border);
 
     SDL_Rect playfield{BOARD_ORIGIN_X, BOARD_ORIGIN_Y, BOARD_WIDTH_PX, BOARD_HEIGHT_PX};
     SDL_SetRenderDrawColor(renderer_, 5, 10, 25, 255);
-    SDL_RenderFillRect(renderer_, &playfield);
+    fill_rect(&playfield);
 
     auto colors = palette();
     for (int y = 0; y < core::BOARD_HEIGHT; ++y) {
@@ -383,21 +720,21 @@ void SdlFrontend::draw_board(const core::GameState &state) {
             SDL_Rect shadow{BOARD_ORIGIN_X + x * TILE_SIZE + 4, BOARD_ORIGIN_Y + y * TILE_SIZE + 4, TILE_SIZE - 2,
                             TILE_SIZE - 2};
             SDL_SetRenderDrawColor(renderer_, 0, 0, 0, 70);
-            SDL_RenderFillRect(renderer_, &shadow);
+            fill_rect(&shadow);
 
             int cell = buffer[y][x];
             SDL_Rect rect{BOARD_ORIGIN_X + x * TILE_SIZE, BOARD_ORIGIN_Y + y * TILE_SIZE, TILE_SIZE - 4, TILE_SIZE - 4};
             if (cell == -1) {
                 SDL_SetRenderDrawColor(renderer_, 255, 255, 255, 12);
-                SDL_RenderDrawRect(renderer_, &rect);
+                draw_rect(&rect);
             } else {
                 const auto &color = colors[static_cast<std::size_t>(cell)];
                 SDL_SetRenderDrawColor(renderer_, color.r, color.g, color.b, 255);
-                SDL_RenderFillRect(renderer_, &rect);
+                fill_rect(&rect);
                 SDL_SetRenderDrawColor(renderer_, 255, 255, 255, 60);
                 SDL_Rect highlight = rect;
                 highlight.h /= 3;
-                SDL_RenderFillRect(renderer_, &highlight);
+                fill_rect(&highlight);
             }
         }
     }
@@ -410,22 +747,37 @@ void SdlFrontend::draw_board(const core::GameState &state) {
     for (const auto &cell : ghost) {
         SDL_Rect rect{BOARD_ORIGIN_X + cell.x * TILE_SIZE, BOARD_ORIGIN_Y + cell.y * TILE_SIZE, TILE_SIZE - 4,
                       TILE_SIZE - 4};
-        SDL_RenderDrawRect(renderer_, &rect);
+        draw_rect(&rect);
         if (cell.x >= 0 && cell.x < core::BOARD_WIDTH) {
             landing[static_cast<std::size_t>(cell.x)] = true;
         }
     }
 
+    if (hint_ && hint_->type == state.active_piece.type) {
+        // Suggested placement: a doubled outline, so it reads apart from the ghost.
+        SDL_SetRenderDrawColor(renderer_, 255, 215, 90, 200);
+        for (const auto &cell : compute_cells(*hint_).cells) {
+            if (cell.y < 0 || cell.y >= core::BOARD_HEIGHT) {
+                continue;
+            }
+            SDL_Rect outer{BOARD_ORIGIN_X + cell.x * TILE_SIZE - 1, BOARD_ORIGIN_Y + cell.y * TILE_SIZE - 1,
+                           TILE_SIZE - 2, TILE_SIZE - 2};
+            SDL_Rect inner{outer.x + 3, outer.y + 3, outer.w - 6, outer.h - 6};
+            draw_rect(&outer);
+            draw_rect(&inner);
+        }
+    }
+
     SDL_Rect indicator_track{BOARD_ORIGIN_X, BOARD_ORIGIN_Y + BOARD_HEIGHT_PX + INDICATOR_TRACK_MARGIN, BOARD_WIDTH_PX,
                              INDICATOR_TRACK_HEIGHT};
     SDL_SetRenderDrawColor(renderer_, 8, 8, 30, 240);
-    SDL_RenderFillRect(renderer_, &indicator_track);
+    fill_rect(&indicator_track);
     SDL_SetRenderDrawColor(renderer_, 0, 255, 230, 80);
-    SDL_RenderDrawRect(renderer_, &indicator_track);
+    draw_rect(&indicator_track);
     SDL_SetRenderDrawColor(renderer_, 255, 255, 255, 35);
     for (int x = 0; x < core::BOARD_WIDTH; ++x) {
         SDL_Rect notch{BOARD_ORIGIN_X + x * TILE_SIZE + TILE_SIZE / 2 - 1, indicator_track.y + indicator_track.h - 4, 2, 3};
-        SDL_RenderFillRect(renderer_, &notch);
+        fill_rect(&notch);
     }
     SDL_SetRenderDrawColor(renderer_, ghost_color.r, ghost_color.g, ghost_color.b, 220);
     for (int x = 0; x < core::BOARD_WIDTH; ++x) {
@@ -433,7 +785,7 @@ void SdlFrontend::draw_board(const core::GameState &state) {
             continue;
         }
         SDL_Rect rect{BOARD_ORIGIN_X + x * TILE_SIZE + 2, indicator_track.y + 2, TILE_SIZE - 6, indicator_track.h - 4};
-        SDL_RenderFillRect(renderer_, &rect);
+        fill_rect(&rect);
     }
 
     if (line_flash_active_) {
@@ -450,34 +802,113 @@ void SdlFrontend::draw_board(const core::GameState &state) {
 
             SDL_Rect flash_overlay{BOARD_ORIGIN_X, BOARD_ORIGIN_Y, BOARD_WIDTH_PX, BOARD_HEIGHT_PX};
             SDL_SetRenderDrawColor(renderer_, 255, 255, 255, static_cast<Uint8>(140 * intensity));
-            SDL_RenderFillRect(renderer_, &flash_overlay);
+            fill_rect(&flash_overlay);
 
-            for (int row : line_flash_rows_) {
+            for (int i = 0; i < line_flash_count_; ++i) {
+                int row = line_flash_rows_[static_cast<std::size_t>(i)];
                 int row_y = BOARD_ORIGIN_Y + row * TILE_SIZE;
                 SDL_Rect band{BOARD_ORIGIN_X - 4, row_y - 2, BOARD_WIDTH_PX + 8, TILE_SIZE + 4};
                 SDL_SetRenderDrawColor(renderer_, 255, 210, 120, static_cast<Uint8>(200 * intensity));
-                SDL_RenderFillRect(renderer_, &band);
+                fill_rect(&band);
                 SDL_SetRenderDrawColor(renderer_, 255, 255, 255, static_cast<Uint8>(220 * intensity));
-                SDL_RenderDrawRect(renderer_, &band);
+                draw_rect(&band);
             }
 
             SDL_Rect glow{BOARD_ORIGIN_X - 10, BOARD_ORIGIN_Y - 10, BOARD_WIDTH_PX + 20, BOARD_HEIGHT_PX + 20};
             SDL_SetRenderDrawColor(renderer_, 0, 255, 230, static_cast<Uint8>(190 * intensity));
-            SDL_RenderDrawRect(renderer_, &glow);
+            draw_rect(&glow);
+        }
+    }
+}
+
+void SdlFrontend::emit_lock(const core::GameEvent &locked, int drop_distance) {
+    auto color = palette()[static_cast<std::size_t>(locked.value)];
+    for (std::size_t i = 0; i < locked.count; ++i) {
+        const auto &cell = locked.cells[i];
+        // The piece's colour stays on the board until the next frame draws it.
+        last_board_[static_cast<std::size_t>(cell.y)][static_cast<std::size_t>(cell.x)] = locked.value;
+        float left = static_cast<float>(BOARD_ORIGIN_X + cell.x * TILE_SIZE);
+        float top = static_cast<float>(BOARD_ORIGIN_Y + cell.y * TILE_SIZE);
+
+        ParticleSystem::Emitter dust;
+        dust.x = left;
+        dust.y = top + TILE_SIZE - 6;
+        dust.w = TILE_SIZE - 4;
+        dust.h = 2.0f;
+        dust.vy = -60.0f;
+        dust.jitter = 80.0f;
+        dust.life = 0.35f;
+        dust.color = SDL_Color{static_cast<Uint8>(128 + color.r / 2), static_cast<Uint8>(128 + color.g / 2),
+                               static_cast<Uint8>(128 + color.b / 2), 200};
+        particles_.emit(3, dust);
+
+        if (drop_distance > 0) {
+            // A streak through the rows the piece fell past.
+            ParticleSystem::Emitter trail;
+            trail.x = left + 2.0f;
+            trail.y = top - static_cast<float>(drop_distance * TILE_SIZE);
+            trail.w = TILE_SIZE - 8;
+            trail.h = static_cast<float>(drop_distance * TILE_SIZE);
+            trail.vy = -40.0f;
+            trail.jitter = 25.0f;
+            trail.life = 0.3f;
+            trail.size = 2.0f;
+            trail.color = SDL_Color{color.r, color.g, color.b, 150};
+            particles_.emit(static_cast<std::size_t>(std::min(drop_distance, 20) * 3), trail);
+        }
+    }
+}
+
+void SdlFrontend::emit_clear(const core::GameEvent &cleared) {
+    auto colors = palette();
+    // Bigger clears throw more sparks, in the colours of the blocks they clear.
+    auto per_cell = static_cast<std::size_t>(10 + 4 * cleared.count);
+    for (std::size_t i = 0; i < cleared.count; ++i) {
+        int row = cleared.rows[i];
+        if (row < 0 || row >= core::BOARD_HEIGHT) {
+            continue;
+        }
+        for (int x = 0; x < core::BOARD_WIDTH; ++x) {
+            int cell = last_board_[static_cast<std::size_t>(row)][static_cast<std::size_t>(x)];
+            ParticleSystem::Emitter sparks;
+            sparks.x = static_cast<float>(BOARD_ORIGIN_X + x * TILE_SIZE);
+            sparks.y = static_cast<float>(BOARD_ORIGIN_Y + row * TILE_SIZE);
+            sparks.w = TILE_SIZE - 4;
+            sparks.h = TILE_SIZE - 4;
+            sparks.vy = -180.0f;
+            sparks.jitter = 260.0f;
+            sparks.life = 0.7f;
+            sparks.size = 4.0f;
+            sparks.color = cell >= 0 ? colors[static_cast<std::size_t>(cell)] : SDL_Color{255, 255, 255, 255};
+            particles_.emit(per_cell, sparks);
         }
     }
 }
 
+void SdlFrontend::draw_particles() {
+    SectionScope scope{*this, Section::Particles};
+    if (particles_.empty()) {
+        return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    // A stalled frame should not teleport the particles.
+    float seconds = std::min(std::chrono::duration<float>(now - particles_updated_).count(), 0.05f);
+    particles_updated_ = now;
+    particles_.update(seconds);
+    frame_draw_calls_ += static_cast<std::uint64_t>(particles_.draw(renderer_));
+}
+
 void SdlFrontend::draw_next_queue(const core::GameState &state) {
+    SectionScope scope{*this, Section::NextQueue};
     auto colors = palette();
     int block_size = TILE_SIZE - 6;
     int box_x = BOARD_ORIGIN_X + BOARD_WIDTH_PX + 60;
     int box_y = BOARD_ORIGIN_Y;
     SDL_Rect backdrop{box_x - 20, box_y - 20, 220, 220};
     SDL_SetRenderDrawColor(renderer_, 8, 8, 25, 200);
-    SDL_RenderFillRect(renderer_, &backdrop);
+    fill_rect(&backdrop);
     SDL_SetRenderDrawColor(renderer_, 255, 255, 255, 50);
-    SDL_RenderDrawRect(renderer_, &backdrop);
+    draw_rect(&backdrop);
 
     render_text("NEXT", box_x, box_y - 10, 3, SDL_Color{255, 255, 255, 255});
 
@@ -498,7 +929,7 @@ void SdlFrontend::draw_next_queue(const core::GameState &state) {
         int height = max_y - min_y + 1;
         SDL_SetRenderDrawColor(renderer_, 255, 255, 255, 18);
         SDL_Rect frame{box_x, offset_y, 180, 120};
-        SDL_RenderDrawRect(renderer_, &frame);
+        draw_rect(&frame);
 
         int local_origin_x = box_x + (frame.w - width * block_size) / 2;
         int local_origin_y = offset_y + (frame.h - height * block_size) / 2;
@@ -509,12 +940,13 @@ void SdlFrontend::draw_next_queue(const core::GameState &state) {
             int py = (cell.y - min_y) * block_size;
             SDL_Rect rect{local_origin_x + px, local_origin_y + py, block_size - 4, block_size - 4};
             SDL_SetRenderDrawColor(renderer_, color.r, color.g, color.b, 255);
-            SDL_RenderFillRect(renderer_, &rect);
+            fill_rect(&rect);
         }
     }
 }
 
 void SdlFrontend::draw_stats(const core::GameState &state) {
+    SectionScope scope{*this, Section::Stats};
     int text_x = BOARD_ORIGIN_X;
     int text_y = BOARD_ORIGIN_Y + BOARD_HEIGHT_PX + INDICATOR_TRACK_MARGIN + INDICATOR_TRACK_HEIGHT + 14;
     int value_offset = 26;
@@ -557,22 +989,24 @@ void SdlFrontend::draw_stats(const core::GameState &state) {
     }
     SDL_Rect bar{progress_x, progress_y + 40, 180, 14};
     SDL_SetRenderDrawColor(renderer_, 255, 255, 255, 40);
-    SDL_RenderDrawRect(renderer_, &bar);
+    draw_rect(&bar);
     SDL_Rect fill = bar;
     fill.w = static_cast<int>(bar.w * progress);
     SDL_SetRenderDrawColor(renderer_, 0, 230, 180, 180);
-    SDL_RenderFillRect(renderer_, &fill);
+    fill_rect(&fill);
 }
 
 void SdlFrontend::draw_game_over() {
+    SectionScope scope{*this, Section::GameOver};
     SDL_Rect overlay{BOARD_ORIGIN_X, BOARD_ORIGIN_Y + BOARD_HEIGHT_PX / 2 - 80, BOARD_WIDTH_PX, 160};
     SDL_SetRenderDrawColor(renderer_, 0, 0, 0, 180);
-    SDL_RenderFillRect(renderer_, &overlay);
+    fill_rect(&overlay);
     render_text("GAME OVER", overlay.x + 30, overlay.y + 30, 4, SDL_Color{255, 90, 110, 255});
     render_text("PRESS X TO EXIT", overlay.x + 30, overlay.y + 90, 2, SDL_Color{255, 255, 255, 255});
 }
 
 void SdlFrontend::render_text(const std::string &text, int x, int y, int scale, SDL_Color color) {
+    SectionScope scope{*this, Section::Text};
     int cursor_x = x;
     int cursor_y = y;
     for (char ch : text) {
@@ -596,7 +1030,7 @@ void SdlFrontend::render_text(const std::string &text, int x, int y, int scale,
             for (int col = 0; col < FONT_WIDTH; ++col) {
                 if ((bits >> (FONT_WIDTH - 1 - col)) & 0x1) {
                     SDL_Rect pixel{cursor_x + col * scale, cursor_y + row * scale, scale, scale};
-                    SDL_RenderFillRect(renderer_, &pixel);
+                    fill_rect(&pixel);
                 }
             }
         }
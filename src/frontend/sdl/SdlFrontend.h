@@ -1,13 +1,20 @@
 #pragma once
 
+#include "../../metrics/Metrics.h"
+#include "../BoardSnapshot.h"
 #include "../Frontend.h"
 #include "AudioEngine.h"
+#include "ParticleSystem.h"
+#include "VideoRecorder.h"
 
 #include <SDL2/SDL.h>
 
 #include <array>
 #include <chrono>
+#include <cstdint>
 #include <memory>
+#include <optional>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -19,31 +26,151 @@ public:
     ~SdlFrontend() override = default;
 
     void initialize(const core::GameState &state) override;
+    // Draws into a width x height ARGB surface with SDL's software renderer
+    // instead: no window, display or audio device. Returns false on failure.
+    bool initialize_offscreen(int width, int height);
+    const SDL_Surface *offscreen_surface() const noexcept { return surface_; }
     void render(const core::GameState &state) override;
     core::InputAction poll_input() override;
     void shutdown() override;
     void sleep_for(std::chrono::milliseconds duration) override;
+    core::InputAction wait_input(std::chrono::milliseconds timeout) override;
+    void wake() override;
+    std::chrono::steady_clock::time_point last_input_time() const override { return last_input_time_; }
+    FrameTiming last_frame() const override { return last_frame_; }
+    void inject_input(core::InputAction action) override;
+    bool is_animating() const override { return line_flash_active_ || !particles_.empty(); }
+    void on_events(const core::GameEvents &events) override;
+    void set_hint(const std::optional<core::Tetromino> &hint) override;
+
+    // Spectator wall: every board in one grid scaled to the window, submitted
+    // as a single SDL_RenderGeometry batch. Tiles smaller than a few pixels
+    // switch to one texel per cell from a shared atlas.
+    void render_wall(std::span<const BoardSnapshot> boards);
+
+    struct WallStats {
+        int draw_calls{0};
+        std::size_t vertices{0};
+        float cell_size{0.0f};
+        bool detailed{false};
+    };
+    const WallStats &wall_stats() const noexcept { return wall_stats_; }
+
+    std::uint64_t last_frame_draw_calls() const noexcept { return last_frame_draw_calls_; }
+    std::size_t particles() const noexcept { return particles_.size(); }
+
+    // Records every frame to a Y4M file at `fps` until shutdown. Frames are
+    // drawn into one of two target textures and copied to the window; each
+    // frame reads back the texture drawn the frame before, which the GPU has
+    // long finished, and hands it to the recorder's writer thread.
+    bool start_recording(const std::string &path, int fps = 30);
+    VideoRecorder::Stats recording_stats() const { return video_ ? video_->stats() : VideoRecorder::Stats{}; }
+
+    // Where the last frame's time and draw calls went. render_text is its own
+    // section, so the sections that call it are charged without their text.
+    enum class Section : std::uint8_t {
+        Background,
+        Board,
+        Particles,
+        NextQueue,
+        Stats,
+        Text,
+        GameOver,
+        Capture,
+        Present,
+        Count
+    };
+    struct SectionCost {
+        std::chrono::nanoseconds time{};
+        std::uint64_t draw_calls{0};
+    };
+    using FrameProfile = std::array<SectionCost, static_cast<std::size_t>(Section::Count)>;
+    // Off by default: every section boundary reads the clock, which costs
+    // more than some of the sections do.
+    void set_profiling(bool enabled) noexcept { profiling_ = enabled; }
+    const FrameProfile &last_frame_profile() const noexcept { return last_profile_; }
 
 private:
     void draw_background();
     void draw_board(const core::GameState &state);
     void draw_next_queue(const core::GameState &state);
     void draw_stats(const core::GameState &state);
+    void draw_particles();
+    void emit_lock(const core::GameEvent &locked, int drop_distance);
+    void emit_clear(const core::GameEvent &cleared);
     void draw_game_over();
     void render_text(const std::string &text, int x, int y, int scale, SDL_Color color);
+    void begin_frame();
+    void end_frame();
+    void capture_begin();
+    void capture_end();
+    void read_back(SDL_Texture *target);
+    void stop_recording();
+
+    // Every draw call goes through these so a frame's calls can be counted.
+    void fill_rect(const SDL_Rect *rect);
+    void draw_rect(const SDL_Rect *rect);
+    void draw_line(int x1, int y1, int x2, int y2);
 
-    core::GameState last_state_{};
-    bool last_state_initialized_{false};
+    // Charges time and draw calls to one section while alive, then returns to
+    // the enclosing one. Does nothing unless profiling.
+    class SectionScope {
+    public:
+        SectionScope(SdlFrontend &frontend, Section section);
+        ~SectionScope();
+
+    private:
+        SdlFrontend &frontend_;
+        Section previous_;
+    };
+    Section enter_section(Section section);
+
+    std::uint64_t last_version_{0};
+    bool needs_redraw_{true}; // first frame, or window exposed or resized since the last one
     std::chrono::steady_clock::time_point line_flash_start_{};
     bool line_flash_active_{false};
     int line_flash_count_{0};
-    std::vector<int> line_flash_rows_{};
+    std::array<int, 4> line_flash_rows_{};
+    std::optional<core::Tetromino> hint_{};
+    ParticleSystem particles_{};
+    std::chrono::steady_clock::time_point particles_updated_{};
+    decltype(core::GameState::board) last_board_{}; // as of the last drawn version, so cleared rows keep their colours
+    std::chrono::steady_clock::time_point ticks_epoch_{}; // steady_clock time of SDL_GetTicks() == 0
+    std::chrono::steady_clock::time_point last_input_time_{};
+    FrameTiming last_frame_{};
 
     SDL_Window *window_{nullptr};
     SDL_Renderer *renderer_{nullptr};
+    SDL_Surface *surface_{nullptr}; // offscreen target, when there is no window
     bool initialized_{false};
 
     std::unique_ptr<AudioEngine> audio_;
+
+    std::unique_ptr<VideoRecorder> video_;
+    std::array<SDL_Texture *, 2> capture_targets_{};
+    std::size_t capture_current_{0}; // target this frame draws into
+    bool capture_pending_{false};    // the other target holds a frame not yet read back
+    std::chrono::steady_clock::time_point capture_pending_shown_{};
+
+    std::vector<SDL_Vertex> wall_vertices_{};
+    std::vector<int> wall_indices_{};
+    std::vector<Uint32> wall_pixels_{};
+    SDL_Texture *wall_atlas_{nullptr};
+    int wall_atlas_rows_{0};
+    WallStats wall_stats_{};
+
+    std::chrono::steady_clock::time_point frame_start_{};
+    std::uint64_t frame_draw_calls_{0};
+    std::uint64_t last_frame_draw_calls_{0};
+    bool profiling_{false};
+    Section section_{Section::Count}; // Count: outside every section
+    std::chrono::steady_clock::time_point section_start_{};
+    std::uint64_t section_draw_calls_{0};
+    FrameProfile profile_{};
+    FrameProfile last_profile_{};
+    metrics::Histogram *frame_seconds_{&metrics::registry().histogram(
+        "cretris_frame_seconds", "Time to build and present one SDL frame.", metrics::latency_bounds())};
+    metrics::Counter *draw_calls_{&metrics::registry().counter("cretris_draw_calls_total", "SDL draw calls issued.")};
 };
 
 } // namespace cretris::frontend
@@ -0,0 +1,203 @@
+#include "VideoRecorder.h"
+
+#include <algorithm>
+
+namespace cretris::frontend {
+
+namespace {
+
+// BT.601 limited range, the Y4M default.
+void argb_to_i420(const std::uint32_t *pixels, int width, int height, std::uint8_t *luma, std::uint8_t *cb,
+                  std::uint8_t *cr) {
+    for (int y = 0; y < height; ++y) {
+        const std::uint32_t *row = pixels + static_cast<std::size_t>(y) * static_cast<std::size_t>(width);
+        std::uint8_t *out = luma + static_cast<std::size_t>(y) * static_cast<std::size_t>(width);
+        for (int x = 0; x < width; ++x) {
+            int r = static_cast<int>((row[x] >> 16) & 0xff);
+            int g = static_cast<int>((row[x] >> 8) & 0xff);
+            int b = static_cast<int>(row[x] & 0xff);
+            out[x] = static_cast<std::uint8_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+        }
+    }
+    // Chroma from the average of each 2x2 block (C420jpeg siting); odd edges reuse the last pixel.
+    int chroma_w = (width + 1) / 2;
+    int chroma_h = (height + 1) / 2;
+    for (int cy = 0; cy < chroma_h; ++cy) {
+        const std::uint32_t *top = pixels + static_cast<std::size_t>(2 * cy) * static_cast<std::size_t>(width);
+        const std::uint32_t *bottom =
+            pixels + static_cast<std::size_t>(std::min(2 * cy + 1, height - 1)) * static_cast<std::size_t>(width);
+        for (int cx = 0; cx < chroma_w; ++cx) {
+            int left = 2 * cx;
+            int right = std::min(left + 1, width - 1);
+            int r = 0;
+            int g = 0;
+            int b = 0;
+            for (std::uint32_t p : {top[left], top[right], bottom[left], bottom[right]}) {
+                r += static_cast<int>((p >> 16) & 0xff);
+                g += static_cast<int>((p >> 8) & 0xff);
+                b += static_cast<int>(p & 0xff);
+            }
+            r = (r + 2) / 4;
+            g = (g + 2) / 4;
+            b = (b + 2) / 4;
+            auto at = static_cast<std::size_t>(cy) * static_cast<std::size_t>(chroma_w) + static_cast<std::size_t>(cx);
+            cb[at] = static_cast<std::uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+            cr[at] = static_cast<std::uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+        }
+    }
+}
+
+} // namespace
+
+VideoRecorder::~VideoRecorder() { close(clock::now()); }
+
+bool VideoRecorder::open(const std::string &path, int width, int height, int fps) {
+    if (file_ || width <= 0 || height <= 0 || fps <= 0) {
+        return false;
+    }
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) {
+        return false;
+    }
+    std::setvbuf(file_, nullptr, _IOFBF, 1 << 20);
+    if (std::fprintf(file_, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", width, height, fps) < 0) {
+        std::fclose(file_);
+        file_ = nullptr;
+        return false;
+    }
+    width_ = width;
+    height_ = height;
+    period_ = std::chrono::duration_cast<clock::duration>(std::chrono::seconds{1}) / fps;
+
+    auto pixels = static_cast<std::size_t>(width) * static_cast<std::size_t>(height);
+    auto chroma = static_cast<std::size_t>((width + 1) / 2) * static_cast<std::size_t>((height + 1) / 2);
+    frames_.resize(BUFFERS);
+    for (std::uint32_t i = 0; i < BUFFERS; ++i) {
+        frames_[i].pixels.assign(pixels, 0);
+        free_.try_push(i);
+    }
+    planes_.resize(pixels + 2 * chroma);
+    writer_ = std::thread{[this] { run(); }};
+    return true;
+}
+
+std::uint32_t *VideoRecorder::acquire() {
+    if (!file_) {
+        return nullptr;
+    }
+    if (acquired_ == BUFFERS) {
+        auto index = free_.try_pop();
+        if (!index) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            dropped_total_->inc();
+            return nullptr;
+        }
+        acquired_ = *index;
+    }
+    return frames_[acquired_].pixels.data();
+}
+
+void VideoRecorder::submit(clock::time_point shown) {
+    if (acquired_ == BUFFERS) {
+        return;
+    }
+    frames_[acquired_].shown = shown;
+    ready_.try_push(acquired_); // never full: it has a slot for every buffer
+    acquired_ = BUFFERS;
+    captured_.fetch_add(1, std::memory_order_relaxed);
+    submitted_.fetch_add(1, std::memory_order_release);
+    submitted_.notify_one();
+}
+
+void VideoRecorder::close(clock::time_point end) {
+    if (!file_) {
+        return;
+    }
+    end_ = end;
+    stopping_.store(true, std::memory_order_release);
+    submitted_.fetch_add(1, std::memory_order_release);
+    submitted_.notify_one();
+    writer_.join();
+    if (std::fclose(file_) != 0) {
+        failed_.store(true, std::memory_order_relaxed);
+    }
+    file_ = nullptr;
+}
+
+VideoRecorder::Stats VideoRecorder::stats() const {
+    Stats stats;
+    stats.captured = captured_.load(std::memory_order_relaxed);
+    stats.dropped = dropped_.load(std::memory_order_relaxed);
+    stats.coalesced = coalesced_.load(std::memory_order_relaxed);
+    stats.written = written_.load(std::memory_order_relaxed);
+    stats.repeated = repeated_.load(std::memory_order_relaxed);
+    stats.failed = failed_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void VideoRecorder::run() {
+    auto take = [this](std::uint32_t index) {
+        if (current_ == BUFFERS) {
+            next_due_ = frames_[index].shown;
+        } else {
+            advance(frames_[index].shown);
+            if (!current_written_) {
+                coalesced_.fetch_add(1, std::memory_order_relaxed);
+            }
+            free_.try_push(current_);
+        }
+        current_ = index;
+        current_written_ = false;
+    };
+
+    for (;;) {
+        auto seen = submitted_.load(std::memory_order_acquire);
+        if (auto index = ready_.try_pop()) {
+            take(*index);
+            continue;
+        }
+        if (stopping_.load(std::memory_order_acquire)) {
+            while (auto index = ready_.try_pop()) {
+                take(*index);
+            }
+            break;
+        }
+        submitted_.wait(seen, std::memory_order_acquire);
+    }
+
+    advance(end_);
+    if (current_ != BUFFERS && !current_written_) {
+        write_frame(frames_[current_]); // the last frame appears at least once
+    }
+    std::fflush(file_);
+}
+
+void VideoRecorder::advance(clock::time_point until) {
+    while (current_ != BUFFERS && next_due_ < until && !failed_.load(std::memory_order_relaxed)) {
+        write_frame(frames_[current_]);
+        next_due_ += period_;
+    }
+}
+
+void VideoRecorder::write_frame(const Frame &frame) {
+    auto pixels = static_cast<std::size_t>(width_) * static_cast<std::size_t>(height_);
+    auto chroma = (planes_.size() - pixels) / 2;
+    if (current_written_) {
+        repeated_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        // Converted once; repeats write the same planes again.
+        argb_to_i420(frame.pixels.data(), width_, height_, planes_.data(), planes_.data() + pixels,
+                     planes_.data() + pixels + chroma);
+        current_written_ = true;
+    }
+    static constexpr char HEADER[] = "FRAME\n";
+    if (std::fwrite(HEADER, 1, sizeof(HEADER) - 1, file_) != sizeof(HEADER) - 1 ||
+        std::fwrite(planes_.data(), 1, planes_.size(), file_) != planes_.size()) {
+        failed_.store(true, std::memory_order_relaxed);
+        return;
+    }
+    written_.fetch_add(1, std::memory_order_relaxed);
+    written_total_->inc();
+}
+
+} // namespace cretris::frontend
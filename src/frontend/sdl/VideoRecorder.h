@@ -0,0 +1,104 @@
+#pragma once
+
+#include "../../metrics/Metrics.h"
+#include "../../runtime/SpscRing.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace cretris::frontend {
+
+// Writes frames to an uncompressed Y4M (4:2:0) file on its own thread. The
+// render thread borrows a buffer from a small pool, fills it with ARGB pixels
+// and submits it; buffers travel to the writer and back over two SpscRings,
+// so neither side waits on the other. When every buffer is still queued the
+// frame is dropped and counted rather than holding up the game.
+//
+// The video runs at a fixed rate, but the game only renders when something
+// changed: each video frame shows the latest frame submitted before it, so a
+// still screen repeats and frames closer together than the period coalesce.
+class VideoRecorder {
+public:
+    using clock = std::chrono::steady_clock;
+
+    struct Stats {
+        std::uint64_t captured{0};  // frames submitted
+        std::uint64_t dropped{0};   // frames skipped because the writer was behind
+        std::uint64_t coalesced{0}; // captured frames replaced before their video frame came up
+        std::uint64_t written{0};   // video frames in the file, repeats included
+        std::uint64_t repeated{0};
+        bool failed{false}; // a write failed; the file stops there
+    };
+
+    VideoRecorder() = default;
+    ~VideoRecorder();
+
+    VideoRecorder(const VideoRecorder &) = delete;
+    VideoRecorder &operator=(const VideoRecorder &) = delete;
+
+    bool open(const std::string &path, int width, int height, int fps);
+    bool recording() const noexcept { return file_ != nullptr; }
+    int width() const noexcept { return width_; }
+    int height() const noexcept { return height_; }
+
+    // Render thread. A width x height ARGB buffer (pitch width * 4) for the
+    // next frame, or nullptr if the writer still holds every buffer, in which
+    // case the frame counts as dropped. Pair a non-null result with submit().
+    std::uint32_t *acquire();
+    void submit(clock::time_point shown);
+
+    // Repeats the last frame up to `end`, then flushes and joins the writer.
+    void close(clock::time_point end);
+    Stats stats() const;
+
+private:
+    static constexpr std::uint32_t BUFFERS = 4;
+
+    struct Frame {
+        std::vector<std::uint32_t> pixels;
+        clock::time_point shown{};
+    };
+
+    void run();
+    void advance(clock::time_point until); // writes video frames due before `until`
+    void write_frame(const Frame &frame);
+
+    std::FILE *file_{nullptr};
+    int width_{0};
+    int height_{0};
+    clock::duration period_{};
+
+    std::vector<Frame> frames_;
+    runtime::SpscRing<std::uint32_t> free_{BUFFERS};  // writer to render thread
+    runtime::SpscRing<std::uint32_t> ready_{BUFFERS}; // render thread to writer
+    std::uint32_t acquired_{BUFFERS};                 // render thread only; BUFFERS when none
+    std::atomic<std::uint64_t> submitted_{0};         // bumped with every submit, for the writer to wait on
+    std::atomic<bool> stopping_{false};
+    clock::time_point end_{};
+    std::thread writer_;
+
+    // Writer thread only, until joined.
+    std::uint32_t current_{BUFFERS}; // latest frame, held back until its video frame comes up
+    bool current_written_{false};
+    clock::time_point next_due_{};
+    std::vector<std::uint8_t> planes_;
+
+    std::atomic<std::uint64_t> captured_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+    std::atomic<std::uint64_t> coalesced_{0};
+    std::atomic<std::uint64_t> written_{0};
+    std::atomic<std::uint64_t> repeated_{0};
+    std::atomic<bool> failed_{false};
+
+    metrics::Counter *written_total_{&metrics::registry().counter(
+        "cretris_video_frames_written_total", "Video frames written by --record-video, repeats included.")};
+    metrics::Counter *dropped_total_{&metrics::registry().counter(
+        "cretris_video_frames_dropped_total", "Frames --record-video skipped because its writer was behind.")};
+};
+
+} // namespace cretris::frontend
@@ -1,22 +1,421 @@
+#include "ai/HintEngine.h"
+#include "ai/Planner.h"
 #include "core/Game.h"
 #include "frontend/ncurses/NcursesFrontend.h"
 #include "frontend/sdl/SdlFrontend.h"
+#include "metrics/Exporter.h"
+#include "metrics/GameMetrics.h"
+#include "metrics/InputLatency.h"
+#include "replay/ReplayArchive.h"
+#include "runtime/Scheduler.h"
+#include "runtime/SeqlockTable.h"
+#include "server/RemoteSession.h"
+#include "server/SessionServer.h"
+#include "sim/Simulation.h"
+#include "store/ResultsStore.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <csignal>
+#include <cstdio>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+namespace {
+
+cretris::server::SessionServer *active_server = nullptr;
+
+void handle_stop_signal(int) {
+    if (active_server) {
+        active_server->request_stop();
+    }
+}
+
+int run_server(cretris::server::ServerConfig config) {
+    cretris::server::SessionServer server{std::move(config)};
+    active_server = &server;
+    std::signal(SIGINT, handle_stop_signal);
+    std::signal(SIGTERM, handle_stop_signal);
+    int status = server.run();
+    active_server = nullptr;
+    return status;
+}
+
+int run_remote(cretris::frontend::Frontend &frontend, const std::string &socket_path) {
+    cretris::server::RemoteSession session;
+    if (!session.connect(socket_path)) {
+        std::cerr << "Could not connect to " << socket_path << "\n";
+        return 1;
+    }
+
+    // The decoder's state is a zero-filled placeholder until the first keyframe
+    // arrives, so the front end only starts once the session is synced.
+    bool initialized = false;
+    while (session.poll()) {
+        if (!initialized) {
+            if (!session.synced()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds{1});
+                continue;
+            }
+            frontend.initialize(session.state());
+            initialized = true;
+        }
+        auto action = frontend.poll_input();
+        if (action == cretris::core::InputAction::Quit) {
+            break;
+        }
+        session.send_action(action);
+        frontend.on_events(session.take_events());
+        if (session.synced()) {
+            frontend.render(session.state());
+        }
+        frontend.sleep_for(std::chrono::milliseconds{16});
+    }
+    if (!initialized) {
+        std::cerr << "Disconnected from " << socket_path << " before the first frame\n";
+        return 1;
+    }
+    frontend.shutdown();
+    return 0;
+}
+
+using WallTable = cretris::runtime::SeqlockTable<cretris::frontend::BoardSnapshot>;
+
+// Plays boards first, first + stride, ... with planner bots at a watchable pace,
+// restarting each game a couple of seconds after it tops out.
+void drive_wall_bots(WallTable &table, std::size_t first, std::size_t stride, const std::atomic<bool> &stop) {
+    constexpr auto STEP = std::chrono::milliseconds{50};
+    constexpr int INPUTS_PER_TICK = 4;
+    constexpr int GAME_OVER_STEPS = 40;
+
+    struct Bot {
+        std::size_t slot;
+        cretris::core::Game game;
+        std::vector<cretris::core::InputAction> plan{};
+        std::size_t next{0};
+        int steps{0};
+        int game_over_steps{0};
+    };
+    auto seed = static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    std::vector<Bot> bots;
+    for (std::size_t slot = first; slot < table.size(); slot += stride) {
+        bots.push_back(Bot{slot, cretris::core::Game{seed + slot}});
+        table.publish(slot, cretris::frontend::BoardSnapshot::capture(bots.back().game.state()));
+    }
+
+    cretris::ai::Planner planner;
+    auto deadline = std::chrono::steady_clock::now();
+    while (!stop.load(std::memory_order_relaxed)) {
+        for (auto &bot : bots) {
+            if (bot.game.state().game_over) {
+                if (++bot.game_over_steps < GAME_OVER_STEPS) {
+                    continue;
+                }
+                seed += table.size();
+                bot = Bot{bot.slot, cretris::core::Game{seed + bot.slot}};
+            } else {
+                if (bot.next >= bot.plan.size()) {
+                    bot.plan = planner.plan(bot.game);
+                    bot.next = 0;
+                }
+                if (bot.next < bot.plan.size()) {
+                    bot.game.apply_action(bot.plan[bot.next++]);
+                }
+                if (++bot.steps % INPUTS_PER_TICK == 0) {
+                    bot.game.tick();
+                    bot.plan.clear(); // gravity may have moved the piece off the planned path
+                }
+            }
+            bot.game.take_events();
+            table.publish(bot.slot, cretris::frontend::BoardSnapshot::capture(bot.game.state()));
+        }
+        deadline += STEP;
+        std::this_thread::sleep_until(deadline);
+    }
+}
+
+int run_wall(std::size_t boards) {
+    WallTable table{boards};
+    std::atomic<bool> stop{false};
+    std::size_t threads = std::clamp<std::size_t>(std::thread::hardware_concurrency(), 1, std::max<std::size_t>(boards, 1));
+    std::vector<std::thread> bots;
+    for (std::size_t t = 0; t < threads; ++t) {
+        bots.emplace_back([&table, &stop, t, threads] { drive_wall_bots(table, t, threads, stop); });
+    }
+
+    cretris::frontend::SdlFrontend frontend;
+    frontend.initialize(cretris::core::GameState{});
+    std::vector<cretris::frontend::BoardSnapshot> snapshots(boards);
+    using clock = std::chrono::steady_clock;
+    auto started = clock::now();
+    std::uint64_t frames = 0;
+    std::chrono::nanoseconds build_time{0};
+    while (frontend.poll_input() != cretris::core::InputAction::Quit) {
+        auto frame_start = clock::now();
+        for (std::size_t i = 0; i < boards; ++i) {
+            table.read(i, snapshots[i]);
+        }
+        frontend.render_wall(snapshots);
+        build_time += clock::now() - frame_start;
+        ++frames;
+        std::this_thread::sleep_until(frame_start + std::chrono::microseconds{16667});
+    }
+    const auto &stats = frontend.wall_stats();
+    frontend.shutdown();
+    stop = true;
+    for (auto &bot : bots) {
+        bot.join();
+    }
+
+    double seconds = std::chrono::duration<double>(clock::now() - started).count();
+    std::printf("%zu boards: %llu frames, %.1f fps, %.2f ms per frame submitted, %d draw call(s), %zu vertices, %s\n",
+                boards, static_cast<unsigned long long>(frames), frames / std::max(seconds, 1e-9),
+                frames ? std::chrono::duration<double, std::milli>(build_time).count() / static_cast<double>(frames) : 0.0,
+                stats.draw_calls, stats.vertices, stats.detailed ? "cell quads" : "atlas texels");
+    return 0;
+}
+
+// Runs a headless batch, with the ncurses dashboard when stdout is a terminal.
+int run_simulation(cretris::sim::SimulationConfig config) {
+    constexpr auto REFRESH = std::chrono::milliseconds{250};
+    cretris::sim::Simulation simulation{config};
+    bool dashboard = ::isatty(STDOUT_FILENO) != 0;
+    cretris::frontend::NcursesFrontend frontend;
+    std::vector<cretris::core::GameState> samples(simulation.workers());
+    if (dashboard) {
+        frontend.initialize(cretris::core::GameState{});
+    }
+    simulation.start();
+    while (!simulation.finished()) {
+        if (dashboard) {
+            if (frontend.wait_input(REFRESH) == cretris::core::InputAction::Quit) {
+                simulation.stop();
+            }
+            for (std::size_t i = 0; i < samples.size(); ++i) {
+                simulation.sample(i, samples[i]);
+            }
+            frontend.render_dashboard(simulation.stats(), samples);
+        } else {
+            std::this_thread::sleep_for(REFRESH);
+        }
+    }
+    simulation.join();
+    if (dashboard) {
+        frontend.shutdown();
+    }
+
+    auto stats = simulation.stats();
+    double seconds = std::max(std::chrono::duration<double>(stats.elapsed).count(), 1e-9);
+    std::printf("%llu games on %zu workers in %.2f s: %.1f games/s, %.1f pieces/s, %.2f lines per game\n",
+                static_cast<unsigned long long>(stats.games), stats.workers.size(), seconds,
+                static_cast<double>(stats.games) / seconds, static_cast<double>(stats.pieces) / seconds,
+                stats.games ? static_cast<double>(stats.lines) / static_cast<double>(stats.games) : 0.0);
+    return 0;
+}
+
+void save_result(const std::string &path, const cretris::core::Game &game, std::chrono::milliseconds duration,
+                 std::uint32_t replay_archive, std::uint64_t replay_offset) {
+    cretris::store::ResultsStore results;
+    if (!results.open(path)) {
+        std::cerr << "Could not open results store " << path << "\n";
+        return;
+    }
+    cretris::store::ResultRecord record;
+    record.seed = game.randomizer().seed();
+    record.score = game.state().score;
+    record.lines = game.state().total_lines;
+    record.level = game.state().level;
+    record.duration_ms = static_cast<std::uint32_t>(duration.count());
+    record.replay_archive = replay_archive;
+    record.replay_offset = replay_offset;
+    record.finished_at_ms = static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch())
+            .count());
+    results.append(record);
+
+    std::cout << "High scores:\n";
+    int rank = 1;
+    for (const auto &best : results.top(5)) {
+        std::printf("%2d. %8d  %4d lines  level %2d\n", rank++, best.score, best.lines, best.level);
+    }
+}
+
+// The local game's behaviour, one coroutine each, driven by main's loop.
+using cretris::runtime::Scheduler;
+using cretris::runtime::Signal;
+using cretris::runtime::Task;
+
+struct PlayerInput {
+    cretris::core::InputAction action{cretris::core::InputAction::None};
+    Scheduler::clock::time_point arrived{}; // Frontend::last_input_time()
+};
+
+Task play_inputs(Signal<PlayerInput> &input, cretris::core::Game &game, cretris::replay::ReplayRecorder &recorder,
+                 cretris::metrics::Counter &inputs, cretris::metrics::InputLatency *latency, bool &running) {
+    for (;;) {
+        auto [action, arrived] = co_await input;
+        if (action == cretris::core::InputAction::Quit) {
+            running = false;
+            co_return;
+        }
+        auto before = game.state().version;
+        game.apply_action(action);
+        recorder.record_action(action, game);
+        inputs.inc();
+        if (latency) {
+            latency->applied(action, arrived, before, game.state().version);
+        }
+    }
+}
+
+// Presses the keys the planner would, one every 37 ms, then quits, so a
+// latency run needs no player (nor a display, with SDL_VIDEODRIVER=dummy).
+Task script_inputs(Scheduler &scheduler, cretris::frontend::Frontend &frontend, const cretris::core::Game &game,
+                   std::size_t count) {
+    cretris::ai::Planner planner;
+    std::size_t sent = 0;
+    while (sent < count && !game.state().game_over) {
+        auto actions = planner.plan(game);
+        // A player hard-drops instead of soft-dropping straight down first.
+        while (actions.size() >= 2 && actions[actions.size() - 2] == cretris::core::InputAction::SoftDrop) {
+            actions.erase(actions.end() - 2);
+        }
+        for (auto action : actions) {
+            co_await scheduler.sleep_for(std::chrono::milliseconds{37});
+            frontend.inject_input(action);
+            if (++sent == count) {
+                break;
+            }
+        }
+        co_await scheduler.sleep_for(std::chrono::milliseconds{37}); // let the drop land before planning again
+    }
+    co_await scheduler.sleep_for(std::chrono::milliseconds{100});
+    frontend.inject_input(cretris::core::InputAction::Quit);
+}
+
+Task apply_gravity(Scheduler &scheduler, cretris::core::Game &game, cretris::replay::ReplayRecorder &recorder) {
+    for (auto last_tick = Scheduler::clock::now();;) {
+        co_await scheduler.sleep_until(last_tick + game.gravity_interval());
+        if (game.state().game_over) {
+            co_return;
+        }
+        game.tick();
+        recorder.record_tick(game);
+        last_tick = Scheduler::clock::now();
+    }
+}
+
+// Keeps frames coming while the front end plays an effect.
+Task animate(Scheduler &scheduler, const cretris::frontend::Frontend &frontend, bool &animating) {
+    while (frontend.is_animating()) {
+        co_await scheduler.next_frame();
+    }
+    animating = false;
+}
+
+void refresh_hint(cretris::ai::HintEngine &hints, cretris::frontend::Frontend &frontend,
+                  const cretris::core::Game &game) {
+    hints.update(game);
+    auto hint = hints.best();
+    frontend.set_hint(hint ? std::optional{hint->piece} : std::nullopt);
+}
+
+// Restarts the rollouts as soon as the game moves...
+Task follow_hints(Signal<std::uint64_t> &changed, cretris::ai::HintEngine &hints,
+                  cretris::frontend::Frontend &frontend, const cretris::core::Game &game) {
+    for (;;) {
+        co_await changed;
+        refresh_hint(hints, frontend, game);
+    }
+}
+
+// ...and picks up their progress once a frame while they refine.
+Task refine_hints(Scheduler &scheduler, Signal<std::uint64_t> &changed, cretris::ai::HintEngine &hints,
+                  cretris::frontend::Frontend &frontend, const cretris::core::Game &game) {
+    for (;;) {
+        refresh_hint(hints, frontend, game);
+        if (hints.refining()) {
+            co_await scheduler.next_frame();
+        } else {
+            co_await changed;
+        }
+    }
+}
+
+} // namespace
 
 int main(int argc, char **argv) {
     std::string frontend_name = "sdl";
+    bool server_mode = false;
+    std::string connect_path;
+    std::string record_path;
+    std::string results_path;
+    std::string video_path;
+    std::size_t wall_boards = 0;
+    std::string metrics_target;
+    std::uint64_t simulate_games = 0;
+    bool show_hint = false;
+    bool measure_latency = false;
+    std::size_t scripted_inputs = 0;
+    cretris::sim::SimulationConfig simulation_config;
+    cretris::server::ServerConfig server_config;
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
         if (arg == "--ncurses") {
             frontend_name = "ncurses";
         } else if (arg == "--sdl") {
             frontend_name = "sdl";
+        } else if (arg == "--server") {
+            server_mode = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                server_config.socket_path = argv[++i];
+            }
+        } else if (arg == "--connect") {
+            connect_path = server_config.socket_path;
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                connect_path = argv[++i];
+            }
+        } else if (arg == "--latency") {
+            measure_latency = true;
+        } else if (arg == "--latency-script" && i + 1 < argc) {
+            measure_latency = true;
+            scripted_inputs = static_cast<std::size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--hint") {
+            show_hint = true;
+        } else if (arg == "--record" && i + 1 < argc) {
+            record_path = argv[++i];
+        } else if (arg == "--record-video" && i + 1 < argc) {
+            video_path = argv[++i];
+        } else if (arg == "--results" && i + 1 < argc) {
+            results_path = argv[++i];
+        } else if (arg == "--metrics" && i + 1 < argc) {
+            metrics_target = argv[++i];
+        } else if (arg == "--wall" && i + 1 < argc) {
+            wall_boards = static_cast<std::size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--simulate" && i + 1 < argc) {
+            simulate_games = std::stoull(argv[++i]);
+        } else if (arg == "--planner") {
+            simulation_config.policy = cretris::sim::Policy::Planner;
+        } else if (arg == "--workers" && i + 1 < argc) {
+            server_config.worker_count = static_cast<std::size_t>(std::stoul(argv[++i]));
+            simulation_config.threads = server_config.worker_count;
         } else if (arg == "--help" || arg == "-h") {
-            std::cout << "Usage: " << argv[0] << " [--sdl|--ncurses]\n";
+            std::cout << "Usage: " << argv[0] << " [--sdl|--ncurses] [--hint] [--record ARCHIVE] [--results STORE]\n";
+            std::cout << "       " << argv[0] << " [--sdl] --record-video FILE.y4m\n";
+            std::cout << "       " << argv[0] << " --server [SOCKET_PATH] [--workers N]\n";
+            std::cout << "       " << argv[0] << " [--sdl|--ncurses] --connect [SOCKET_PATH]\n";
+            std::cout << "       " << argv[0] << " --wall N\n";
+            std::cout << "       " << argv[0] << " --simulate GAMES [--workers N] [--planner]\n";
+            std::cout << "       " << argv[0] << " [--sdl|--ncurses] --latency | --latency-script INPUTS\n";
+            std::cout << "Any mode also accepts --metrics FILE|unix:SOCKET_PATH (Prometheus text format).\n";
             return 0;
         } else {
             std::cerr << "Unknown option: " << arg << "\n";
@@ -25,42 +424,171 @@ int main(int argc, char **argv) {
         }
     }
 
+    cretris::metrics::registry()
+        .gauge("cretris_start_time_seconds", "Unix time the process started.")
+        .set(std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count());
+    std::optional<cretris::metrics::Exporter> exporter;
+    if (!metrics_target.empty()) {
+        exporter.emplace(cretris::metrics::registry(), metrics_target);
+        if (!exporter->start()) {
+            return 1;
+        }
+    }
+
+    if (server_mode) {
+        return run_server(std::move(server_config));
+    }
+    if (wall_boards > 0) {
+        return run_wall(wall_boards);
+    }
+    if (simulate_games > 0) {
+        simulation_config.games = simulate_games;
+        return run_simulation(simulation_config);
+    }
+
     std::unique_ptr<cretris::frontend::Frontend> frontend;
+    cretris::frontend::SdlFrontend *sdl = nullptr;
     if (frontend_name == "ncurses") {
         frontend = std::make_unique<cretris::frontend::NcursesFrontend>();
     } else {
-        frontend = std::make_unique<cretris::frontend::SdlFrontend>();
+        auto owned = std::make_unique<cretris::frontend::SdlFrontend>();
+        sdl = owned.get();
+        frontend = std::move(owned);
+    }
+    if (!video_path.empty() && !sdl) {
+        std::cerr << "--record-video needs the SDL front end\n";
+        return 1;
+    }
+
+    if (!connect_path.empty()) {
+        return run_remote(*frontend, connect_path);
     }
 
     cretris::core::Game game;
+    cretris::replay::ReplayRecorder recorder{game.randomizer().seed()};
     frontend->initialize(game.state());
+    if (!video_path.empty() && !sdl->start_recording(video_path)) {
+        frontend->shutdown();
+        std::cerr << "Could not record video to " << video_path << "\n";
+        return 1;
+    }
+    std::unique_ptr<cretris::ai::HintEngine> hints;
+    if (show_hint) {
+        hints = std::make_unique<cretris::ai::HintEngine>();
+    }
 
-    using clock = std::chrono::steady_clock;
-    auto last_tick = clock::now();
-    auto gravity = game.gravity_interval();
+    auto &metrics = cretris::metrics::registry();
+    cretris::metrics::GameMetrics game_metrics{metrics};
+    auto &inputs = metrics.counter("cretris_inputs_total", "Player inputs applied.");
+    auto &score = metrics.gauge("cretris_score", "Score of the local game.");
+    auto &level = metrics.gauge("cretris_level", "Level of the local game.");
+    game_metrics.game_started();
+    level.set(game.state().level);
+
+    using clock = Scheduler::clock;
+    auto started = clock::now();
+    auto finished = started;
 
+    Scheduler::Options scheduling;
+    scheduling.wake = [&frontend] { frontend->wake(); };
+    Scheduler scheduler{scheduling};
+    Signal<PlayerInput> input{scheduler};
+    Signal<std::uint64_t> changed{scheduler};
     bool running = true;
+    bool animating = false;
+    std::optional<cretris::metrics::InputLatency> latency;
+    if (measure_latency) {
+        latency.emplace(metrics);
+    }
+    scheduler.spawn(play_inputs(input, game, recorder, inputs, latency ? &*latency : nullptr, running));
+    if (scripted_inputs > 0) {
+        scheduler.spawn(script_inputs(scheduler, *frontend, game, scripted_inputs));
+    }
+    scheduler.spawn(apply_gravity(scheduler, game, recorder));
+    if (hints) {
+        scheduler.spawn(follow_hints(changed, *hints, *frontend, game));
+        scheduler.spawn(refine_hints(scheduler, changed, *hints, *frontend, game));
+    }
+    scheduler.run_due();
+
+    auto drawn_version = game.state().version;
     while (running) {
-        auto action = frontend->poll_input();
-        if (action == cretris::core::InputAction::Quit) {
+        // Sleep until input arrives or the earliest timer or frame some task waits on.
+        auto timeout = std::chrono::milliseconds::max();
+        auto now = clock::now();
+        auto wake = scheduler.next_wake();
+        if (wake <= now) {
+            timeout = std::chrono::milliseconds{0};
+        } else if (wake != clock::time_point::max()) {
+            timeout = std::chrono::ceil<std::chrono::milliseconds>(wake - now);
+        }
+
+        auto action = frontend->wait_input(timeout);
+        if (action != cretris::core::InputAction::None) {
+            input.publish(PlayerInput{action, frontend->last_input_time()});
+        }
+        scheduler.run_due();
+        if (!running) {
             break;
         }
-        game.apply_action(action);
 
-        auto now = clock::now();
-        gravity = game.gravity_interval();
-        if (now - last_tick >= gravity) {
-            if (!game.tick()) {
-                // allow player to quit after game over
-            }
-            last_tick = now;
-            gravity = game.gravity_interval();
+        if (!game.state().game_over) {
+            finished = clock::now();
         }
 
+        auto events = game.take_events();
+        if (!events.empty()) {
+            game_metrics.record(events);
+            score.set(game.state().score);
+            level.set(game.state().level);
+        }
+        frontend->on_events(events);
+        if (!animating && frontend->is_animating()) {
+            animating = true;
+            scheduler.spawn(animate(scheduler, *frontend, animating));
+        }
+        if (game.state().version != drawn_version) {
+            drawn_version = game.state().version;
+            changed.publish(drawn_version);
+        }
+        scheduler.run_due();
         frontend->render(game.state());
-        frontend->sleep_for(std::chrono::milliseconds{16});
+        if (latency) {
+            auto frame = frontend->last_frame();
+            latency->presented(frame.version, frame.submitted, frame.returned);
+        }
     }
 
     frontend->shutdown();
+    if (latency) {
+        std::cout << latency->report();
+    }
+    if (!video_path.empty()) {
+        auto video = sdl->recording_stats();
+        std::cout << "video: " << video.written << " frames written (" << video.repeated << " repeats), "
+                  << video.captured << " captured, " << video.coalesced << " coalesced, " << video.dropped
+                  << " dropped\n";
+        if (video.failed) {
+            std::cerr << "Writing " << video_path << " failed; the video is truncated\n";
+        }
+    }
+
+    std::uint32_t replay_archive = 0;
+    std::uint64_t replay_offset = cretris::store::NO_REPLAY;
+    if (!record_path.empty()) {
+        // Appends, so every game recorded to the same path stays addressable.
+        cretris::replay::ArchiveWriter writer;
+        bool opened = writer.open(record_path);
+        replay_archive = writer.id();
+        replay_offset = writer.next_offset();
+        if (!opened || !writer.add(recorder.replay()) || !writer.finish()) {
+            std::cerr << "Could not write replay to " << record_path << "\n";
+            return 1;
+        }
+    }
+    if (!results_path.empty()) {
+        save_result(results_path, game, std::chrono::duration_cast<std::chrono::milliseconds>(finished - started),
+                    replay_archive, replay_offset);
+    }
     return 0;
 }
@@ -0,0 +1,160 @@
+#include "Exporter.h"
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+namespace cretris::metrics {
+
+namespace {
+
+constexpr std::string_view UNIX_PREFIX = "unix:";
+
+bool write_all(int fd, const char *data, std::size_t size) {
+    while (size > 0) {
+        ssize_t written = ::send(fd, data, size, MSG_NOSIGNAL);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+} // namespace
+
+Exporter::Exporter(Registry &registry, std::string target, std::chrono::milliseconds interval)
+    : registry_{registry}, target_{std::move(target)}, interval_{interval} {
+    if (target_.starts_with(UNIX_PREFIX)) {
+        socket_path_ = target_.substr(UNIX_PREFIX.size());
+    }
+}
+
+Exporter::~Exporter() { stop(); }
+
+bool Exporter::start() {
+    wake_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd_ < 0) {
+        std::perror("eventfd");
+        return false;
+    }
+    if (!socket_path_.empty()) {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (socket_path_.size() >= sizeof(address.sun_path)) {
+            std::fprintf(stderr, "Socket path too long: %s\n", socket_path_.c_str());
+            return false;
+        }
+        std::memcpy(address.sun_path, socket_path_.c_str(), socket_path_.size() + 1);
+        listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        ::unlink(socket_path_.c_str());
+        if (listen_fd_ < 0 || ::bind(listen_fd_, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 ||
+            ::listen(listen_fd_, 16) != 0) {
+            std::perror("metrics socket");
+            return false;
+        }
+    } else if (!write_file()) {
+        std::fprintf(stderr, "Could not write metrics to %s\n", target_.c_str());
+        return false;
+    }
+    thread_ = std::thread{[this] { run(); }};
+    return true;
+}
+
+void Exporter::stop() {
+    if (thread_.joinable()) {
+        std::uint64_t one = 1;
+        ssize_t ignored = ::write(wake_fd_, &one, sizeof(one));
+        (void)ignored;
+        thread_.join();
+        if (socket_path_.empty()) {
+            write_file();
+        }
+    }
+    if (listen_fd_ >= 0) {
+        ::close(listen_fd_);
+        ::unlink(socket_path_.c_str());
+        listen_fd_ = -1;
+    }
+    if (wake_fd_ >= 0) {
+        ::close(wake_fd_);
+        wake_fd_ = -1;
+    }
+}
+
+void Exporter::run() {
+    using clock = std::chrono::steady_clock;
+    auto next_write = clock::now() + interval_;
+    while (true) {
+        std::array<pollfd, 2> fds{pollfd{wake_fd_, POLLIN, 0}, pollfd{listen_fd_, POLLIN, 0}};
+        int timeout = -1;
+        if (socket_path_.empty()) {
+            auto remaining = std::chrono::ceil<std::chrono::milliseconds>(next_write - clock::now());
+            timeout = static_cast<int>(std::max<std::int64_t>(0, remaining.count()));
+        }
+        int ready = ::poll(fds.data(), listen_fd_ >= 0 ? 2 : 1, timeout);
+        if (ready < 0 && errno != EINTR) {
+            return;
+        }
+        if (fds[0].revents & POLLIN) {
+            return;
+        }
+        if (listen_fd_ >= 0 && (fds[1].revents & POLLIN)) {
+            int client;
+            while ((client = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC)) >= 0) {
+                serve_client(client);
+                ::close(client);
+            }
+        }
+        if (socket_path_.empty() && clock::now() >= next_write) {
+            write_file();
+            next_write += interval_;
+        }
+    }
+}
+
+bool Exporter::write_file() const {
+    std::string temporary = target_ + ".tmp";
+    std::FILE *file = std::fopen(temporary.c_str(), "w");
+    if (!file) {
+        return false;
+    }
+    auto text = registry_.prometheus_text();
+    bool ok = std::fwrite(text.data(), 1, text.size(), file) == text.size();
+    ok = std::fclose(file) == 0 && ok;
+    return ok && std::rename(temporary.c_str(), target_.c_str()) == 0;
+}
+
+void Exporter::serve_client(int fd) const {
+    // The request itself is irrelevant; read what has arrived so the close is clean.
+    timeval timeout{0, 100000};
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    std::array<char, 1024> request{};
+    ssize_t ignored = ::recv(fd, request.data(), request.size(), 0);
+    (void)ignored;
+
+    auto body = registry_.prometheus_text();
+    char header[128];
+    int length = std::snprintf(header, sizeof(header),
+                               "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: %zu\r\n\r\n",
+                               body.size());
+    if (write_all(fd, header, static_cast<std::size_t>(length))) {
+        write_all(fd, body.data(), body.size());
+    }
+}
+
+} // namespace cretris::metrics
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Metrics.h"
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+namespace cretris::metrics {
+
+// Publishes a registry in Prometheus text format from a background thread.
+// A plain path is rewritten every interval (via a temporary file and rename,
+// for node_exporter's textfile collector); "unix:PATH" listens on a Unix
+// socket and answers each connection with a minimal HTTP response, e.g.
+// `curl --unix-socket PATH http://localhost/metrics`.
+class Exporter {
+public:
+    Exporter(Registry &registry, std::string target, std::chrono::milliseconds interval = std::chrono::seconds{10});
+    ~Exporter();
+
+    Exporter(const Exporter &) = delete;
+    Exporter &operator=(const Exporter &) = delete;
+
+    bool start(); // false if the socket or file cannot be set up
+    void stop();  // writes the file one last time
+
+private:
+    void run();
+    bool write_file() const;
+    void serve_client(int fd) const;
+
+    Registry &registry_;
+    std::string target_;
+    std::string socket_path_; // set for unix: targets
+    std::chrono::milliseconds interval_;
+    std::thread thread_;
+    int listen_fd_{-1};
+    int wake_fd_{-1};
+};
+
+} // namespace cretris::metrics
@@ -0,0 +1,44 @@
+#include "GameMetrics.h"
+
+#include <string>
+
+namespace cretris::metrics {
+
+GameMetrics::GameMetrics(Registry &registry)
+    : games_{&registry.counter("cretris_games_started_total", "Games started.")},
+      pieces_{&registry.counter("cretris_pieces_locked_total", "Pieces locked into the board.")},
+      hard_drops_{&registry.counter("cretris_hard_drops_total", "Hard drops.")},
+      hard_drop_rows_{&registry.counter("cretris_hard_drop_rows_total", "Rows fallen by hard drops.")},
+      game_overs_{&registry.counter("cretris_game_overs_total", "Games that topped out.")} {
+    for (int lines = 1; lines < static_cast<int>(clears_.size()); ++lines) {
+        std::string labels = "lines=\"" + std::to_string(lines) + "\"";
+        clears_[static_cast<std::size_t>(lines)] =
+            &registry.counter("cretris_line_clears_total", "Line clears, by rows cleared at once.", labels);
+    }
+}
+
+void GameMetrics::record(const core::GameEvents &events) noexcept {
+    for (const auto &event : events) {
+        switch (event.type) {
+        case core::GameEventType::PieceLocked:
+            pieces_->inc();
+            break;
+        case core::GameEventType::LinesCleared:
+            if (event.count > 0 && event.count < clears_.size()) {
+                clears_[event.count]->inc();
+            }
+            break;
+        case core::GameEventType::HardDrop:
+            hard_drops_->inc();
+            hard_drop_rows_->inc(static_cast<std::uint64_t>(event.value));
+            break;
+        case core::GameEventType::GameOver:
+            game_overs_->inc();
+            break;
+        case core::GameEventType::LevelChanged:
+            break;
+        }
+    }
+}
+
+} // namespace cretris::metrics
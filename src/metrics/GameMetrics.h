@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Metrics.h"
+
+#include "../core/Game.h"
+
+#include <array>
+
+namespace cretris::metrics {
+
+// Game counters fed from core::GameEvents: pieces, line clears by size, hard
+// drops and game overs, shared by every game recorded into the same registry.
+class GameMetrics {
+public:
+    explicit GameMetrics(Registry &registry = metrics::registry());
+
+    void record(const core::GameEvents &events) noexcept;
+    void game_started() noexcept { games_->inc(); }
+
+private:
+    Counter *games_;
+    Counter *pieces_;
+    std::array<Counter *, 5> clears_{}; // index = lines cleared at once; 0 unused
+    Counter *hard_drops_;
+    Counter *hard_drop_rows_;
+    Counter *game_overs_;
+};
+
+} // namespace cretris::metrics
@@ -0,0 +1,118 @@
+#include "InputLatency.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace cretris::metrics {
+
+namespace {
+
+constexpr std::array<const char *, 7> ACTION_NAMES = {"none",      "move_left", "move_right", "soft_drop",
+                                                      "hard_drop", "rotate_cw", "rotate_ccw"};
+
+double milliseconds(InputLatency::clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+float percentile(std::vector<float> samples, double fraction) {
+    if (samples.empty()) {
+        return 0.0f;
+    }
+    auto rank = static_cast<std::size_t>(fraction * static_cast<double>(samples.size() - 1) + 0.5);
+    std::nth_element(samples.begin(), samples.begin() + static_cast<std::ptrdiff_t>(rank), samples.end());
+    return samples[rank];
+}
+
+} // namespace
+
+InputLatency::InputLatency(Registry &registry) {
+    for (std::size_t a = 1; a < ACTIONS; ++a) {
+        std::string labels = std::string{"action=\""} + ACTION_NAMES[a] + "\"";
+        actions_[a].submit = &registry.histogram("cretris_input_to_submit_seconds",
+                                                 "Input arrival to the present call of the first frame showing it.",
+                                                 latency_bounds(), labels);
+        actions_[a].present = &registry.histogram("cretris_input_to_present_seconds",
+                                                  "Input arrival to that present call returning.",
+                                                  latency_bounds(), labels);
+        actions_[a].unchanged =
+            &registry.counter("cretris_inputs_unchanged_total", "Inputs that left the game state as it was.", labels);
+    }
+}
+
+void InputLatency::applied(core::InputAction action, clock::time_point arrived, std::uint64_t before,
+                           std::uint64_t after) {
+    auto index = static_cast<std::size_t>(action);
+    if (index == 0 || index >= ACTIONS) {
+        return;
+    }
+    if (after == before) {
+        actions_[index].unchanged->inc();
+        return;
+    }
+    pending_.push_back(Pending{action, arrived, after});
+}
+
+void InputLatency::presented(std::uint64_t version, clock::time_point submitted, clock::time_point returned) {
+    while (!pending_.empty() && pending_.front().version <= version) {
+        const auto &input = pending_.front();
+        auto &action = actions_[static_cast<std::size_t>(input.action)];
+        // Coarse event clocks can stamp an input a hair after it was read.
+        auto to_submit = std::max(submitted - input.arrived, clock::duration::zero());
+        auto to_return = std::max(returned - input.arrived, clock::duration::zero());
+        action.submit->observe(std::chrono::duration<double>(to_submit).count());
+        action.present->observe(std::chrono::duration<double>(to_return).count());
+        action.submit_ms.push_back(static_cast<float>(milliseconds(to_submit)));
+        action.present_ms.push_back(static_cast<float>(milliseconds(to_return)));
+        pending_.pop_front();
+    }
+}
+
+std::string InputLatency::report() const {
+    std::string out;
+    char line[160];
+    std::snprintf(line, sizeof(line), "%-11s %7s %9s  %24s    %24s\n", "input", "frames", "unchanged",
+                  "ms to present: p50 p99 max", "to its return: p50 p99 max");
+    out += line;
+    for (std::size_t a = 1; a < ACTIONS; ++a) {
+        const auto &action = actions_[a];
+        std::snprintf(line, sizeof(line), "%-11s %7zu %9llu  %6.2f %6.2f %8.2f    %6.2f %6.2f %8.2f\n", ACTION_NAMES[a],
+                      action.present_ms.size(), static_cast<unsigned long long>(action.unchanged->value()),
+                      percentile(action.submit_ms, 0.5), percentile(action.submit_ms, 0.99),
+                      action.submit_ms.empty() ? 0.0f : *std::max_element(action.submit_ms.begin(), action.submit_ms.end()),
+                      percentile(action.present_ms, 0.5), percentile(action.present_ms, 0.99),
+                      action.present_ms.empty() ? 0.0f
+                                                : *std::max_element(action.present_ms.begin(), action.present_ms.end()));
+        out += line;
+    }
+
+    // One histogram over every action, in the Prometheus buckets.
+    Histogram::Snapshot total;
+    for (std::size_t a = 1; a < ACTIONS; ++a) {
+        auto snapshot = actions_[a].present->snapshot();
+        if (total.counts.empty()) {
+            total = snapshot;
+            continue;
+        }
+        for (std::size_t b = 0; b < snapshot.counts.size(); ++b) {
+            total.counts[b] += snapshot.counts[b];
+        }
+        total.count += snapshot.count;
+    }
+    out += "input to present return, all inputs:\n";
+    std::uint64_t peak = std::max<std::uint64_t>(1, *std::max_element(total.counts.begin(), total.counts.end()));
+    for (std::size_t b = 0; b < total.counts.size(); ++b) {
+        if (b < total.bounds.size()) {
+            std::snprintf(line, sizeof(line), "  <= %8.2f ms %7llu ", total.bounds[b] * 1e3,
+                          static_cast<unsigned long long>(total.counts[b]));
+        } else {
+            std::snprintf(line, sizeof(line), "   > %8.2f ms %7llu ", total.bounds.back() * 1e3,
+                          static_cast<unsigned long long>(total.counts[b]));
+        }
+        out += line;
+        out.append(static_cast<std::size_t>(40 * total.counts[b] / peak), '#');
+        out += '\n';
+    }
+    return out;
+}
+
+} // namespace cretris::metrics
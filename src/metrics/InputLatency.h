@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Metrics.h"
+
+#include "../core/Game.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace cretris::metrics {
+
+// Input-to-photon latency, per input action. An input is stamped when it
+// arrived (the SDL event timestamp, or when getch returned it), tagged with
+// the GameState::version its apply_action produced, and closed by the first
+// frame of that version or later that the front end hands to the display.
+// Two stages are kept: up to the present call (what the loop controls) and
+// up to its return, which includes any vsync wait.
+class InputLatency {
+public:
+    using clock = std::chrono::steady_clock;
+
+    explicit InputLatency(Registry &registry = metrics::registry());
+
+    // `before` and `after` are the state versions around apply_action; an
+    // input that changed nothing has no frame to wait for and is only counted.
+    void applied(core::InputAction action, clock::time_point arrived, std::uint64_t before, std::uint64_t after);
+    void presented(std::uint64_t version, clock::time_point submitted, clock::time_point returned);
+
+    std::size_t pending() const noexcept { return pending_.size(); }
+    // Per action: percentiles of both stages and a histogram of the second.
+    std::string report() const;
+
+private:
+    static constexpr std::size_t ACTIONS = static_cast<std::size_t>(core::InputAction::Quit);
+
+    struct Pending {
+        core::InputAction action;
+        clock::time_point arrived;
+        std::uint64_t version;
+    };
+
+    struct Action {
+        Histogram *submit{nullptr};
+        Histogram *present{nullptr};
+        Counter *unchanged{nullptr};
+        std::vector<float> submit_ms{};
+        std::vector<float> present_ms{};
+    };
+
+    std::deque<Pending> pending_;
+    std::array<Action, ACTIONS> actions_{};
+};
+
+} // namespace cretris::metrics
@@ -0,0 +1,189 @@
+#include "Metrics.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+
+namespace cretris::metrics {
+
+namespace {
+
+void append_value(std::string &out, double value) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+    out += buffer;
+}
+
+void append_value(std::string &out, std::uint64_t value) {
+    char buffer[24];
+    std::snprintf(buffer, sizeof(buffer), "%" PRIu64, value);
+    out += buffer;
+}
+
+// name{labels,extra} with either part optional.
+void append_series(std::string &out, std::string_view name, std::string_view suffix, std::string_view labels,
+                   std::string_view extra = {}) {
+    out += name;
+    out += suffix;
+    if (!labels.empty() || !extra.empty()) {
+        out += '{';
+        out += labels;
+        if (!labels.empty() && !extra.empty()) {
+            out += ',';
+        }
+        out += extra;
+        out += '}';
+    }
+    out += ' ';
+}
+
+} // namespace
+
+std::size_t assign_shard() noexcept {
+    static std::atomic<std::size_t> next{0};
+    return std::min(next.fetch_add(1, std::memory_order_relaxed), SHARED_SHARD);
+}
+
+std::uint64_t Counter::value() const noexcept {
+    std::uint64_t total = 0;
+    for (const auto &shard : shards_) {
+        total += shard.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+void Gauge::add(double delta) noexcept {
+    auto bits = bits_.load(std::memory_order_relaxed);
+    while (!bits_.compare_exchange_weak(bits, std::bit_cast<std::uint64_t>(std::bit_cast<double>(bits) + delta),
+                                        std::memory_order_relaxed)) {
+    }
+}
+
+Histogram::Histogram(const std::vector<double> &bounds) {
+    bound_count_ = std::min(bounds.size(), MAX_BOUNDS);
+    std::copy_n(bounds.begin(), bound_count_, bounds_.begin());
+}
+
+Histogram::Snapshot Histogram::snapshot() const {
+    Snapshot snapshot;
+    snapshot.bounds.assign(bounds_.begin(), bounds_.begin() + static_cast<std::ptrdiff_t>(bound_count_));
+    snapshot.counts.assign(bound_count_ + 1, 0);
+    for (const auto &shard : shards_) {
+        for (std::size_t b = 0; b <= bound_count_; ++b) {
+            snapshot.counts[b] += shard.buckets[b].load(std::memory_order_relaxed);
+        }
+        snapshot.sum += static_cast<double>(shard.sum.load(std::memory_order_relaxed)) / SUM_SCALE;
+    }
+    for (auto count : snapshot.counts) {
+        snapshot.count += count;
+    }
+    return snapshot;
+}
+
+std::vector<double> latency_bounds() {
+    return {0.00005, 0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.0167, 0.025, 0.05, 0.1, 0.25, 1.0};
+}
+
+Registry::Entry &Registry::entry(std::string_view name, std::string_view help, Type type, std::string_view labels) {
+    Family *family = nullptr;
+    for (auto &candidate : families_) {
+        if (candidate.name == name) {
+            family = &candidate;
+            break;
+        }
+    }
+    if (!family) {
+        family = &families_.emplace_back(Family{std::string{name}, std::string{help}, type, {}});
+    }
+    for (auto &existing : family->entries) {
+        if (existing.labels == labels) {
+            return existing;
+        }
+    }
+    return family->entries.emplace_back(Entry{std::string{labels}, nullptr, nullptr, nullptr});
+}
+
+Counter &Registry::counter(std::string_view name, std::string_view help, std::string_view labels) {
+    std::lock_guard lock{mutex_};
+    auto &found = entry(name, help, Type::Counter, labels);
+    if (!found.counter) {
+        found.counter = std::make_unique<Counter>();
+    }
+    return *found.counter;
+}
+
+Gauge &Registry::gauge(std::string_view name, std::string_view help, std::string_view labels) {
+    std::lock_guard lock{mutex_};
+    auto &found = entry(name, help, Type::Gauge, labels);
+    if (!found.gauge) {
+        found.gauge = std::make_unique<Gauge>();
+    }
+    return *found.gauge;
+}
+
+Histogram &Registry::histogram(std::string_view name, std::string_view help, const std::vector<double> &bounds,
+                               std::string_view labels) {
+    std::lock_guard lock{mutex_};
+    auto &found = entry(name, help, Type::Histogram, labels);
+    if (!found.histogram) {
+        found.histogram = std::make_unique<Histogram>(bounds);
+    }
+    return *found.histogram;
+}
+
+std::string Registry::prometheus_text() const {
+    std::string out;
+    std::lock_guard lock{mutex_};
+    for (const auto &family : families_) {
+        out += "# HELP ";
+        out += family.name;
+        out += ' ';
+        out += family.help;
+        out += "\n# TYPE ";
+        out += family.name;
+        out += family.type == Type::Counter ? " counter\n" : family.type == Type::Gauge ? " gauge\n" : " histogram\n";
+        for (const auto &entry : family.entries) {
+            if (entry.counter) {
+                append_series(out, family.name, {}, entry.labels);
+                append_value(out, entry.counter->value());
+                out += '\n';
+            } else if (entry.gauge) {
+                append_series(out, family.name, {}, entry.labels);
+                append_value(out, entry.gauge->value());
+                out += '\n';
+            } else if (entry.histogram) {
+                auto snapshot = entry.histogram->snapshot();
+                std::uint64_t cumulative = 0;
+                for (std::size_t b = 0; b < snapshot.counts.size(); ++b) {
+                    cumulative += snapshot.counts[b];
+                    std::string le = "le=\"";
+                    if (b < snapshot.bounds.size()) {
+                        char bound[32];
+                        std::snprintf(bound, sizeof(bound), "%g", snapshot.bounds[b]);
+                        le += bound;
+                    } else {
+                        le += "+Inf";
+                    }
+                    le += '"';
+                    append_series(out, family.name, "_bucket", entry.labels, le);
+                    append_value(out, cumulative);
+                    out += '\n';
+                }
+                append_series(out, family.name, "_sum", entry.labels);
+                append_value(out, snapshot.sum);
+                out += '\n';
+                append_series(out, family.name, "_count", entry.labels);
+                append_value(out, snapshot.count);
+                out += '\n';
+            }
+        }
+    }
+    return out;
+}
+
+Registry &registry() {
+    static Registry instance;
+    return instance;
+}
+
+} // namespace cretris::metrics
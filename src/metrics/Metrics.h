@@ -0,0 +1,149 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cretris::metrics {
+
+// Every metric keeps SHARDS cache-line-sized copies that reads sum up. The
+// first SHARDS - 1 threads to record anything each own one outright and update
+// it with a plain relaxed load and store; any later thread shares the last one
+// through atomic read-modify-writes.
+constexpr std::size_t SHARDS = 16;
+constexpr std::size_t SHARED_SHARD = SHARDS - 1;
+
+std::size_t assign_shard() noexcept;
+
+inline std::size_t shard_index() noexcept {
+    // Constant-initialised so the hot path is a plain TLS load, no init guard.
+    constinit thread_local std::size_t index = SHARDS;
+    if (index == SHARDS) [[unlikely]] {
+        index = assign_shard();
+    }
+    return index;
+}
+
+inline void bump(std::atomic<std::uint64_t> &value, std::uint64_t by, std::size_t shard) noexcept {
+    if (shard != SHARED_SHARD) [[likely]] {
+        value.store(value.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    } else {
+        value.fetch_add(by, std::memory_order_relaxed);
+    }
+}
+
+class Counter {
+public:
+    void inc(std::uint64_t by = 1) noexcept {
+        auto shard = shard_index();
+        bump(shards_[shard].value, by, shard);
+    }
+    std::uint64_t value() const noexcept;
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<std::uint64_t> value{0};
+    };
+    std::array<Shard, SHARDS> shards_{};
+};
+
+// Last written value wins; a double stored as its bit pattern.
+class Gauge {
+public:
+    void set(double value) noexcept { bits_.store(std::bit_cast<std::uint64_t>(value), std::memory_order_relaxed); }
+    void add(double delta) noexcept;
+    double value() const noexcept { return std::bit_cast<double>(bits_.load(std::memory_order_relaxed)); }
+
+private:
+    std::atomic<std::uint64_t> bits_{0};
+};
+
+// Fixed upper bounds (at most MAX_BOUNDS, ascending) plus the implicit +Inf
+// bucket. Values must be non-negative: the sum is kept as an integer count of
+// 1e-9 units so it can be bumped like the bucket counts.
+class Histogram {
+public:
+    static constexpr std::size_t MAX_BOUNDS = 15;
+    static constexpr double SUM_SCALE = 1e9;
+
+    explicit Histogram(const std::vector<double> &bounds);
+
+    void observe(double value) noexcept {
+        std::size_t bucket = 0;
+        while (bucket < bound_count_ && value > bounds_[bucket]) {
+            ++bucket;
+        }
+        auto index = shard_index();
+        auto &shard = shards_[index];
+        bump(shard.buckets[bucket], 1, index);
+        bump(shard.sum, static_cast<std::uint64_t>(value * SUM_SCALE), index);
+    }
+
+    struct Snapshot {
+        std::vector<double> bounds{};
+        std::vector<std::uint64_t> counts{}; // per bucket, not cumulative; last is +Inf
+        std::uint64_t count{0};
+        double sum{0.0};
+    };
+    Snapshot snapshot() const;
+
+private:
+    struct alignas(64) Shard {
+        std::array<std::atomic<std::uint64_t>, MAX_BOUNDS + 1> buckets{};
+        std::atomic<std::uint64_t> sum{0};
+    };
+    std::array<double, MAX_BOUNDS> bounds_{};
+    std::size_t bound_count_{0};
+    std::array<Shard, SHARDS> shards_{};
+};
+
+// Bounds for durations in seconds, 50 µs to 1 s.
+std::vector<double> latency_bounds();
+
+// Named metrics in Prometheus' data model. Registering the same name and
+// labels again returns the existing metric, so call sites can look metrics up
+// once and keep the reference; references stay valid for the registry's life.
+class Registry {
+public:
+    // `labels` is the inside of the braces, e.g. `lines="2"`; empty for none.
+    Counter &counter(std::string_view name, std::string_view help, std::string_view labels = {});
+    Gauge &gauge(std::string_view name, std::string_view help, std::string_view labels = {});
+    Histogram &histogram(std::string_view name, std::string_view help, const std::vector<double> &bounds,
+                         std::string_view labels = {});
+
+    // Text exposition format 0.0.4.
+    std::string prometheus_text() const;
+
+private:
+    enum class Type { Counter, Gauge, Histogram };
+    struct Entry {
+        std::string labels;
+        std::unique_ptr<Counter> counter;
+        std::unique_ptr<Gauge> gauge;
+        std::unique_ptr<Histogram> histogram;
+    };
+    struct Family {
+        std::string name;
+        std::string help;
+        Type type;
+        std::deque<Entry> entries;
+    };
+
+    Entry &entry(std::string_view name, std::string_view help, Type type, std::string_view labels);
+
+    mutable std::mutex mutex_;
+    std::deque<Family> families_;
+};
+
+// The process-wide registry every subsystem records into.
+Registry &registry();
+
+} // namespace cretris::metrics
@@ -0,0 +1,71 @@
+#include "Framebuffer.h"
+
+#include <algorithm>
+
+namespace cretris::render {
+
+namespace {
+
+void fill_span(std::uint32_t *dst, int count, std::uint32_t pixel) { std::fill_n(dst, count, pixel); }
+
+// Blends two channels per multiply: red and blue sit in the even bytes,
+// green and alpha in the odd ones, each with eight bits of headroom. The
+// weights sum to 256, so dividing by 256 keeps white white and opaque opaque.
+void blend_span(std::uint32_t *dst, int count, Color color) {
+    const std::uint32_t weight = color.a + (color.a >> 7u); // 0..256
+    const std::uint32_t inverse = 256 - weight;
+    const std::uint32_t src = pack(Color{color.r, color.g, color.b, 255});
+    const std::uint32_t src_rb = (src & 0x00ff00ffu) * weight;
+    const std::uint32_t src_ga = ((src >> 8) & 0x00ff00ffu) * weight;
+    for (int i = 0; i < count; ++i) {
+        std::uint32_t d = dst[i];
+        std::uint32_t rb = ((d & 0x00ff00ffu) * inverse + src_rb) >> 8;
+        std::uint32_t ga = ((d >> 8) & 0x00ff00ffu) * inverse + src_ga;
+        dst[i] = (rb & 0x00ff00ffu) | (ga & 0xff00ff00u);
+    }
+}
+
+} // namespace
+
+Framebuffer::Framebuffer(int width, int height)
+    : width_{std::max(width, 0)}, height_{std::max(height, 0)}, pixels_(offset(0, height_)) {}
+
+void Framebuffer::clear(Color color) { std::fill(pixels_.begin(), pixels_.end(), pack(color)); }
+
+void Framebuffer::fill_rect(int x, int y, int w, int h, Color color) {
+    int x0 = std::max(x, 0);
+    int y0 = std::max(y, 0);
+    int x1 = std::min(x + w, width_);
+    int y1 = std::min(y + h, height_);
+    if (x0 >= x1 || y0 >= y1 || color.a == 0) {
+        return;
+    }
+    if (color.a == 255) {
+        const std::uint32_t pixel = pack(color);
+        for (int row = y0; row < y1; ++row) {
+            fill_span(pixels_.data() + offset(x0, row), x1 - x0, pixel);
+        }
+        return;
+    }
+    for (int row = y0; row < y1; ++row) {
+        blend_span(pixels_.data() + offset(x0, row), x1 - x0, color);
+    }
+}
+
+void Framebuffer::outline_rect(int x, int y, int w, int h, Color color) {
+    if (w <= 0 || h <= 0) {
+        return;
+    }
+    fill_rect(x, y, w, 1, color);
+    if (h > 1) {
+        fill_rect(x, y + h - 1, w, 1, color);
+    }
+    if (h > 2) {
+        fill_rect(x, y + 1, 1, h - 2, color);
+        if (w > 1) {
+            fill_rect(x + w - 1, y + 1, 1, h - 2, color);
+        }
+    }
+}
+
+} // namespace cretris::render
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace cretris::render {
+
+static_assert(std::endian::native == std::endian::little, "pixels are packed as little-endian RGBA words");
+
+struct Color {
+    std::uint8_t r{0};
+    std::uint8_t g{0};
+    std::uint8_t b{0};
+    std::uint8_t a{255};
+};
+
+// One pixel as it sits in memory: R, G, B, A bytes, i.e. r in the low byte.
+constexpr std::uint32_t pack(Color c) {
+    return std::uint32_t{c.r} | std::uint32_t{c.g} << 8 | std::uint32_t{c.b} << 16 | std::uint32_t{c.a} << 24;
+}
+
+// Row-major RGBA8 pixels with no padding between rows. Everything is drawn
+// as clipped horizontal spans: opaque spans are plain word fills and
+// translucent ones a branch-free blend loop, both of which the compiler
+// turns into SIMD stores and arithmetic.
+class Framebuffer {
+public:
+    Framebuffer() = default;
+    Framebuffer(int width, int height);
+
+    int width() const noexcept { return width_; }
+    int height() const noexcept { return height_; }
+    const std::vector<std::uint32_t> &pixels() const noexcept { return pixels_; }
+    const std::uint32_t *row(int y) const noexcept { return pixels_.data() + offset(0, y); }
+    std::uint32_t *row(int y) noexcept { return pixels_.data() + offset(0, y); }
+
+    void clear(Color color);
+    // Source-over; an alpha of 255 overwrites, 0 leaves the pixels alone.
+    void fill_rect(int x, int y, int w, int h, Color color);
+    void outline_rect(int x, int y, int w, int h, Color color); // one pixel wide, inside the rect
+
+private:
+    std::size_t offset(int x, int y) const noexcept {
+        return static_cast<std::size_t>(y) * static_cast<std::size_t>(width_) + static_cast<std::size_t>(x);
+    }
+
+    int width_{0};
+    int height_{0};
+    std::vector<std::uint32_t> pixels_;
+};
+
+} // namespace cretris::render
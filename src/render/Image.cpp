@@ -0,0 +1,323 @@
+#include "Image.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdio>
+#include <cstring>
+#include <string_view>
+#include <utility>
+
+namespace cretris::render {
+
+namespace {
+
+constexpr std::array<std::uint8_t, 8> PNG_SIGNATURE = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+constexpr std::size_t MAX_DISTANCE = 32768;
+constexpr std::size_t MAX_MATCH = 258;
+
+// Deflate length and distance codes: first value and extra bits of each (RFC 1951, 3.2.5).
+constexpr std::array<std::uint16_t, 29> LENGTH_BASE = {3,  4,  5,  6,  7,  8,  9,  10,  11,  13,  15,  17,  19,  23, 27,
+                                                       31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+constexpr std::array<std::uint8_t, 29> LENGTH_EXTRA = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                                       2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+constexpr std::array<std::uint16_t, 30> DISTANCE_BASE = {1,    2,    3,    4,    5,    7,     9,     13,    17,  25,
+                                                         33,   49,   65,   97,   129,  193,   257,   385,   513, 769,
+                                                         1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+constexpr std::array<std::uint8_t, 30> DISTANCE_EXTRA = {0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+                                                         6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+std::uint32_t crc32(const std::uint8_t *data, std::size_t size) {
+    static const auto table = [] {
+        std::array<std::uint32_t, 256> table{};
+        for (std::uint32_t i = 0; i < table.size(); ++i) {
+            std::uint32_t c = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                c = (c & 1u) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            }
+            table[i] = c;
+        }
+        return table;
+    }();
+    std::uint32_t crc = 0xffffffffu;
+    for (std::size_t i = 0; i < size; ++i) {
+        crc = table[(crc ^ data[i]) & 0xffu] ^ (crc >> 8);
+    }
+    return crc ^ 0xffffffffu;
+}
+
+std::uint32_t adler32(std::span<const std::uint8_t> data) {
+    constexpr std::uint32_t MOD = 65521;
+    constexpr std::size_t BLOCK = 5552; // the most bytes before b can overflow
+    std::uint32_t a = 1;
+    std::uint32_t b = 0;
+    for (std::size_t begin = 0; begin < data.size(); begin += BLOCK) {
+        std::size_t end = std::min(data.size(), begin + BLOCK);
+        for (std::size_t i = begin; i < end; ++i) {
+            a += data[i];
+            b += a;
+        }
+        a %= MOD;
+        b %= MOD;
+    }
+    return b << 16 | a;
+}
+
+void put_u16(std::vector<std::uint8_t> &out, std::uint32_t value) {
+    out.push_back(static_cast<std::uint8_t>(value >> 8));
+    out.push_back(static_cast<std::uint8_t>(value));
+}
+
+void put_u32(std::vector<std::uint8_t> &out, std::uint32_t value) {
+    put_u16(out, value >> 16);
+    put_u16(out, value & 0xffffu);
+}
+
+void put_chunk(std::vector<std::uint8_t> &out, std::string_view type, std::span<const std::uint8_t> data) {
+    put_u32(out, static_cast<std::uint32_t>(data.size()));
+    const std::size_t start = out.size();
+    out.insert(out.end(), type.begin(), type.end());
+    out.insert(out.end(), data.begin(), data.end());
+    put_u32(out, crc32(out.data() + start, out.size() - start));
+}
+
+// Deflate packs values least significant bit first, Huffman codes included,
+// though those are defined most significant bit first; reversed() flips one.
+constexpr std::uint32_t reversed(std::uint32_t code, int length) {
+    std::uint32_t result = 0;
+    for (int i = 0; i < length; ++i) {
+        result = result << 1 | ((code >> i) & 1u);
+    }
+    return result;
+}
+
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<std::uint8_t> &out) : out_{out} {}
+
+    void put(std::uint32_t bits, int count) {
+        buffer_ |= std::uint64_t{bits} << count_;
+        count_ += count;
+        while (count_ >= 8) {
+            out_.push_back(static_cast<std::uint8_t>(buffer_));
+            buffer_ >>= 8;
+            count_ -= 8;
+        }
+    }
+
+    void flush() {
+        if (count_ > 0) {
+            out_.push_back(static_cast<std::uint8_t>(buffer_));
+        }
+        buffer_ = 0;
+        count_ = 0;
+    }
+
+private:
+    std::vector<std::uint8_t> &out_;
+    std::uint64_t buffer_{0};
+    int count_{0};
+};
+
+struct Code {
+    std::uint16_t bits{0}; // already reversed
+    std::uint8_t length{0};
+};
+
+// Fixed literal/length code (RFC 1951, 3.2.6).
+constexpr std::array<Code, 288> FIXED_CODES = [] {
+    std::array<Code, 288> codes{};
+    for (std::uint32_t symbol = 0; symbol < codes.size(); ++symbol) {
+        auto [code, length] = symbol < 144   ? std::pair{0x30 + symbol, 8}
+                              : symbol < 256 ? std::pair{0x190 + symbol - 144, 9}
+                              : symbol < 280 ? std::pair{symbol - 256, 7}
+                                             : std::pair{0xc0 + symbol - 280, 8};
+        codes[symbol] = Code{static_cast<std::uint16_t>(reversed(code, length)), static_cast<std::uint8_t>(length)};
+    }
+    return codes;
+}();
+
+void put_symbol(BitWriter &bits, int symbol) {
+    const Code &code = FIXED_CODES[static_cast<std::size_t>(symbol)];
+    bits.put(code.bits, code.length);
+}
+
+// Bytes from `a` and `b` that agree, up to `limit`, compared a word at a time.
+std::size_t match_length(const std::uint8_t *a, const std::uint8_t *b, std::size_t limit) {
+    std::size_t length = 0;
+    while (length + 8 <= limit) {
+        std::uint64_t x;
+        std::uint64_t y;
+        std::memcpy(&x, a + length, 8);
+        std::memcpy(&y, b + length, 8);
+        if (x != y) {
+            return length + static_cast<std::size_t>(std::countr_zero(x ^ y) / 8);
+        }
+        length += 8;
+    }
+    while (length < limit && a[length] == b[length]) {
+        ++length;
+    }
+    return length;
+}
+
+void put_match(BitWriter &bits, std::size_t length, std::size_t distance) {
+    auto code = static_cast<std::size_t>(
+        std::upper_bound(LENGTH_BASE.begin(), LENGTH_BASE.end(), length) - LENGTH_BASE.begin() - 1);
+    put_symbol(bits, 257 + static_cast<int>(code));
+    bits.put(static_cast<std::uint32_t>(length - LENGTH_BASE[code]), LENGTH_EXTRA[code]);
+    code = static_cast<std::size_t>(
+        std::upper_bound(DISTANCE_BASE.begin(), DISTANCE_BASE.end(), distance) - DISTANCE_BASE.begin() - 1);
+    bits.put(reversed(static_cast<std::uint32_t>(code), 5), 5);
+    bits.put(static_cast<std::uint32_t>(distance - DISTANCE_BASE[code]), DISTANCE_EXTRA[code]);
+}
+
+// A zlib stream holding one fixed-Huffman block. At each position the longer
+// of the matches one pixel back and one row back is taken, if it is at least
+// three bytes; anything else is a literal.
+std::vector<std::uint8_t> zlib_compress(std::span<const std::uint8_t> data, std::size_t pixel, std::size_t row) {
+    std::vector<std::uint8_t> out{0x78, 0x01};
+    out.reserve(data.size() / 8 + 64);
+    BitWriter bits{out};
+    bits.put(1, 1); // final block
+    bits.put(1, 2); // fixed Huffman codes
+
+    const std::array<std::size_t, 2> distances = {pixel, row <= MAX_DISTANCE ? row : 0};
+    std::size_t i = 0;
+    while (i < data.size()) {
+        const std::size_t limit = std::min(MAX_MATCH, data.size() - i);
+        std::size_t best = 0;
+        std::size_t best_distance = 0;
+        for (std::size_t distance : distances) {
+            if (distance == 0 || distance > i) {
+                continue;
+            }
+            std::size_t length = match_length(data.data() + i, data.data() + i - distance, limit);
+            if (length > best) {
+                best = length;
+                best_distance = distance;
+            }
+        }
+        if (best >= 3) {
+            put_match(bits, best, best_distance);
+            i += best;
+        } else {
+            put_symbol(bits, data[i]);
+            ++i;
+        }
+    }
+    put_symbol(bits, 256); // end of block
+    bits.flush();
+    put_u32(out, adler32(data));
+    return out;
+}
+
+// PNG scanlines: a filter byte (none) followed by RGB triples.
+std::vector<std::uint8_t> scanlines(const Framebuffer &image) {
+    const auto width = static_cast<std::size_t>(image.width());
+    std::vector<std::uint8_t> raw((1 + 3 * width) * static_cast<std::size_t>(image.height()));
+    std::uint8_t *out = raw.data();
+    for (int y = 0; y < image.height(); ++y) {
+        *out++ = 0;
+        const std::uint32_t *row = image.row(y);
+        for (std::size_t x = 0; x < width; ++x) {
+            out[0] = static_cast<std::uint8_t>(row[x]);
+            out[1] = static_cast<std::uint8_t>(row[x] >> 8);
+            out[2] = static_cast<std::uint8_t>(row[x] >> 16);
+            out += 3;
+        }
+    }
+    return raw;
+}
+
+std::vector<std::uint8_t> compress(const Framebuffer &image) {
+    return zlib_compress(scanlines(image), 3, 1 + 3 * static_cast<std::size_t>(image.width()));
+}
+
+void put_header(std::vector<std::uint8_t> &out, const Framebuffer &image) {
+    out.assign(PNG_SIGNATURE.begin(), PNG_SIGNATURE.end());
+    std::vector<std::uint8_t> ihdr;
+    put_u32(ihdr, static_cast<std::uint32_t>(image.width()));
+    put_u32(ihdr, static_cast<std::uint32_t>(image.height()));
+    ihdr.insert(ihdr.end(), {8, 2, 0, 0, 0}); // 8-bit RGB, deflate, no filter method, no interlace
+    put_chunk(out, "IHDR", ihdr);
+}
+
+} // namespace
+
+std::vector<std::uint8_t> encode_png(const Framebuffer &image) {
+    std::vector<std::uint8_t> out;
+    put_header(out, image);
+    put_chunk(out, "IDAT", compress(image));
+    put_chunk(out, "IEND", {});
+    return out;
+}
+
+std::vector<std::uint8_t> encode_apng(std::span<const Framebuffer> frames, int delay_ms) {
+    if (frames.empty()) {
+        return {};
+    }
+    const Framebuffer &first = frames.front();
+    std::vector<std::uint8_t> out;
+    put_header(out, first);
+
+    std::vector<std::uint8_t> chunk;
+    put_u32(chunk, static_cast<std::uint32_t>(frames.size()));
+    put_u32(chunk, 0); // loop forever
+    put_chunk(out, "acTL", chunk);
+
+    std::uint32_t sequence = 0;
+    for (const Framebuffer &frame : frames) {
+        if (frame.width() != first.width() || frame.height() != first.height()) {
+            return {};
+        }
+        chunk.clear();
+        put_u32(chunk, sequence++);
+        put_u32(chunk, static_cast<std::uint32_t>(frame.width()));
+        put_u32(chunk, static_cast<std::uint32_t>(frame.height()));
+        put_u32(chunk, 0); // x offset
+        put_u32(chunk, 0); // y offset
+        put_u16(chunk, static_cast<std::uint32_t>(std::clamp(delay_ms, 0, 65535)));
+        put_u16(chunk, 1000);
+        chunk.insert(chunk.end(), {0, 0}); // no disposal, replace
+        put_chunk(out, "fcTL", chunk);
+
+        if (&frame == &first) {
+            put_chunk(out, "IDAT", compress(frame));
+        } else {
+            chunk.clear();
+            put_u32(chunk, sequence++);
+            auto data = compress(frame);
+            chunk.insert(chunk.end(), data.begin(), data.end());
+            put_chunk(out, "fdAT", chunk);
+        }
+    }
+    put_chunk(out, "IEND", {});
+    return out;
+}
+
+std::vector<std::uint8_t> encode_ppm(const Framebuffer &image) {
+    char header[32];
+    int length = std::snprintf(header, sizeof(header), "P6\n%d %d\n255\n", image.width(), image.height());
+    std::vector<std::uint8_t> out(static_cast<std::size_t>(length) + 3 * image.pixels().size());
+    std::copy(header, header + length, out.begin());
+    std::uint8_t *rgb = out.data() + length;
+    for (std::uint32_t pixel : image.pixels()) {
+        rgb[0] = static_cast<std::uint8_t>(pixel);
+        rgb[1] = static_cast<std::uint8_t>(pixel >> 8);
+        rgb[2] = static_cast<std::uint8_t>(pixel >> 16);
+        rgb += 3;
+    }
+    return out;
+}
+
+bool write_file(const std::string &path, std::span<const std::uint8_t> bytes) {
+    std::FILE *file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    bool ok = std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+    return std::fclose(file) == 0 && ok;
+}
+
+} // namespace cretris::render
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Framebuffer.h"
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace cretris::render {
+
+// Image files from framebuffers, with no codec library. Alpha is dropped:
+// rendered states are opaque.
+//
+// PNG data is compressed with a single fixed-Huffman deflate block whose
+// only matches are the pixel to the left and the one above. On flat-shaded
+// boards that is nearly all of them, so files come out close to what zlib
+// would make at a fraction of the time.
+std::vector<std::uint8_t> encode_png(const Framebuffer &image);
+
+// Animated PNG (APNG) that loops forever, showing each frame for `delay_ms`.
+// Viewers without APNG support show the first frame. Every frame must be the
+// size of the first.
+std::vector<std::uint8_t> encode_apng(std::span<const Framebuffer> frames, int delay_ms);
+
+// Binary PPM (P6).
+std::vector<std::uint8_t> encode_ppm(const Framebuffer &image);
+
+bool write_file(const std::string &path, std::span<const std::uint8_t> bytes);
+
+} // namespace cretris::render
@@ -0,0 +1,86 @@
+#include "PixelFont.h"
+
+#include <utility>
+
+namespace cretris::render {
+
+namespace {
+
+constexpr Glyph glyph(const char *const (&pattern)[FONT_HEIGHT]) {
+    Glyph glyph{};
+    for (int row = 0; row < FONT_HEIGHT; ++row) {
+        std::uint8_t bits = 0;
+        for (int col = 0; col < FONT_WIDTH && pattern[row][col] != '\0'; ++col) {
+            if (pattern[row][col] != ' ') {
+                bits |= static_cast<std::uint8_t>(1u << (FONT_WIDTH - 1 - col));
+            }
+        }
+        glyph.rows[static_cast<std::size_t>(row)] = bits;
+    }
+    return glyph;
+}
+
+constexpr std::pair<char, Glyph> GLYPHS[] = {
+    {'A', glyph({"  #  ", " # # ", "#####", "#   #", "#   #"})},
+    {'B', glyph({"#### ", "#   #", "#### ", "#   #", "#### "})},
+    {'C', glyph({" ####", "#    ", "#    ", "#    ", " ####"})},
+    {'D', glyph({"###  ", "#  # ", "#   #", "#  # ", "###  "})},
+    {'E', glyph({"#####", "#    ", "#### ", "#    ", "#####"})},
+    {'F', glyph({"#####", "#    ", "#### ", "#    ", "#    "})},
+    {'G', glyph({" ####", "#    ", "# ###", "#   #", " ####"})},
+    {'H', glyph({"#   #", "#   #", "#####", "#   #", "#   #"})},
+    {'I', glyph({"#####", "  #  ", "  #  ", "  #  ", "#####"})},
+    {'J', glyph({"  ###", "   # ", "   # ", "#  # ", " ##  "})},
+    {'K', glyph({"#   #", "#  # ", "###  ", "#  # ", "#   #"})},
+    {'L', glyph({"#    ", "#    ", "#    ", "#    ", "#####"})},
+    {'M', glyph({"#   #", "## ##", "# # #", "#   #", "#   #"})},
+    {'N', glyph({"#   #", "##  #", "# # #", "#  ##", "#   #"})},
+    {'O', glyph({" ### ", "#   #", "#   #", "#   #", " ### "})},
+    {'P', glyph({"#### ", "#   #", "#### ", "#    ", "#    "})},
+    {'Q', glyph({" ### ", "#   #", "#   #", "#  ##", " ####"})},
+    {'R', glyph({"#### ", "#   #", "#### ", "#  # ", "#   #"})},
+    {'S', glyph({" ####", "#    ", " ### ", "    #", "#### "})},
+    {'T', glyph({"#####", "  #  ", "  #  ", "  #  ", "  #  "})},
+    {'U', glyph({"#   #", "#   #", "#   #", "#   #", " ### "})},
+    {'V', glyph({"#   #", "#   #", "#   #", " # # ", "  #  "})},
+    {'W', glyph({"#   #", "#   #", "# # #", "## ##", "#   #"})},
+    {'X', glyph({"#   #", " # # ", "  #  ", " # # ", "#   #"})},
+    {'Y', glyph({"#   #", " # # ", "  #  ", "  #  ", "  #  "})},
+    {'Z', glyph({"#####", "   # ", "  #  ", " #   ", "#####"})},
+    {'0', glyph({" ### ", "#  ##", "# # #", "##  #", " ### "})},
+    {'1', glyph({"  #  ", " ##  ", "  #  ", "  #  ", " ### "})},
+    {'2', glyph({" ### ", "#   #", "   # ", "  #  ", "#####"})},
+    {'3', glyph({" ### ", "    #", " ### ", "    #", " ### "})},
+    {'4', glyph({"#   #", "#   #", "#####", "    #", "    #"})},
+    {'5', glyph({"#####", "#    ", "#### ", "    #", "#### "})},
+    {'6', glyph({" ####", "#    ", "#### ", "#   #", " ### "})},
+    {'7', glyph({"#####", "    #", "   # ", "  #  ", "  #  "})},
+    {'8', glyph({" ### ", "#   #", " ### ", "#   #", " ### "})},
+    {'9', glyph({" ### ", "#   #", " ####", "    #", " ### "})},
+    {':', glyph({"     ", "  #  ", "     ", "  #  ", "     "})},
+    {'-', glyph({"     ", "     ", "#####", "     ", "     "})},
+};
+
+// One slot per 7-bit character, so a lookup is an index rather than a hash.
+struct Table {
+    std::array<const Glyph *, 128> glyphs{};
+
+    Table() {
+        for (const auto &[c, glyph] : GLYPHS) {
+            glyphs[static_cast<std::size_t>(c)] = &glyph;
+            if (c >= 'A' && c <= 'Z') {
+                glyphs[static_cast<std::size_t>(c - 'A' + 'a')] = &glyph;
+            }
+        }
+    }
+};
+
+} // namespace
+
+const Glyph *glyph_for(char c) {
+    static const Table table;
+    auto index = static_cast<unsigned char>(c);
+    return index < table.glyphs.size() ? table.glyphs[index] : nullptr;
+}
+
+} // namespace cretris::render
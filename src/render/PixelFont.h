@@ -0,0 +1,21 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace cretris::render {
+
+// The 5x5 bitmap font shared by the SDL front end and the software renderer:
+// upper-case letters (lower case maps onto them), digits, ':' and '-'.
+constexpr int FONT_WIDTH = 5;
+constexpr int FONT_HEIGHT = 5;
+
+struct Glyph {
+    std::array<std::uint8_t, FONT_HEIGHT> rows{}; // bit FONT_WIDTH - 1 is the leftmost column
+};
+
+// nullptr for a space or a character the font lacks; either way the caller
+// advances by one cell.
+const Glyph *glyph_for(char c);
+
+} // namespace cretris::render
@@ -0,0 +1,216 @@
+#include "StateRenderer.h"
+
+#include "PixelFont.h"
+
+#include <algorithm>
+#include <array>
+#include <string>
+#include <utility>
+
+namespace cretris::render {
+
+namespace {
+
+constexpr int QUEUE_SHOWN = 3;
+constexpr int STATS_DIGITS = 7; // the panel is wide enough for a seven-digit score
+
+// Indexed by board cell, as in the SDL front end.
+constexpr std::array<Color, core::GARBAGE_CELL + 1> PALETTE = {
+    Color{0, 230, 255, 255}, Color{255, 221, 0, 255}, Color{220, 0, 255, 255},  Color{0, 232, 125, 255},
+    Color{255, 70, 90, 255}, Color{70, 100, 255, 255}, Color{255, 150, 40, 255}, Color{110, 115, 135, 255}};
+
+constexpr Color PLAYFIELD{5, 10, 25, 255};
+constexpr Color BORDER{0, 250, 220, 90};
+constexpr Color GRID{255, 255, 255, 12};
+constexpr Color LABEL{0, 250, 220, 255};
+constexpr Color VALUE{255, 255, 255, 255};
+constexpr Color GAME_OVER{255, 70, 90, 255};
+
+Color with_alpha(Color color, std::uint8_t alpha) {
+    color.a = alpha;
+    return color;
+}
+
+bool fits(const core::GameState &state, const core::Tetromino &piece) {
+    const auto &mask = core::tetromino_shape(piece.type)[static_cast<std::size_t>(piece.rotation)];
+    for (const auto &cell : mask) {
+        int x = piece.position.x + cell.x;
+        int y = piece.position.y + cell.y;
+        if (x < 0 || x >= core::BOARD_WIDTH || y >= core::BOARD_HEIGHT) {
+            return false;
+        }
+        if (y >= 0 && state.board[y][x] != -1) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int text_width(int chars, int scale) { return chars * (FONT_WIDTH + 1) * scale - scale; }
+
+} // namespace
+
+StateRenderer::StateRenderer(int cell_size) : cell_{std::clamp(cell_size, 2, 64)} {
+    margin_ = cell_;
+    text_scale_ = std::max(1, cell_ / 4);
+    queue_cell_ = std::max(1, cell_ / 2);
+    board_x_ = margin_;
+    board_y_ = margin_;
+    panel_x_ = board_x_ + core::BOARD_WIDTH * cell_ + margin_;
+    panel_width_ = std::max(text_width(STATS_DIGITS, text_scale_), 4 * queue_cell_);
+
+    const int line = (FONT_HEIGHT + 1) * text_scale_;
+    queue_y_ = board_y_ + line + text_scale_;
+    stats_y_ = queue_y_ + QUEUE_SHOWN * 3 * queue_cell_ + margin_;
+    const int panel_bottom = stats_y_ + 3 * (2 * line + 2 * text_scale_);
+
+    width_ = panel_x_ + panel_width_ + margin_;
+    height_ = std::max(board_y_ + core::BOARD_HEIGHT * cell_, panel_bottom) + margin_;
+}
+
+void StateRenderer::draw(const core::GameState &state, Framebuffer &target) const {
+    draw_background(target);
+    draw_board(state, target);
+    draw_queue(state, target);
+    draw_stats(state, target);
+}
+
+void StateRenderer::draw_background(Framebuffer &target) const {
+    const int height = std::max(target.height(), 1);
+    for (int y = 0; y < target.height(); ++y) {
+        int t = y * 256 / height;
+        Color color{static_cast<std::uint8_t>(5 + 20 * t / 256), static_cast<std::uint8_t>(10 + 40 * t / 256),
+                    static_cast<std::uint8_t>(35 + 120 * t / 256), 255};
+        target.fill_rect(0, y, target.width(), 1, color);
+    }
+}
+
+void StateRenderer::draw_board(const core::GameState &state, Framebuffer &target) const {
+    const int board_w = core::BOARD_WIDTH * cell_;
+    const int board_h = core::BOARD_HEIGHT * cell_;
+    target.outline_rect(board_x_ - 1, board_y_ - 1, board_w + 2, board_h + 2, BORDER);
+    target.fill_rect(board_x_, board_y_, board_w, board_h, PLAYFIELD);
+    if (cell_ >= 6) {
+        for (int x = 1; x < core::BOARD_WIDTH; ++x) {
+            target.fill_rect(board_x_ + x * cell_, board_y_, 1, board_h, GRID);
+        }
+        for (int y = 1; y < core::BOARD_HEIGHT; ++y) {
+            target.fill_rect(board_x_, board_y_ + y * cell_, board_w, 1, GRID);
+        }
+    }
+
+    for (int y = 0; y < core::BOARD_HEIGHT; ++y) {
+        for (int x = 0; x < core::BOARD_WIDTH; ++x) {
+            int cell = state.board[y][x];
+            if (cell >= 0 && cell < static_cast<int>(PALETTE.size())) {
+                draw_block(target, board_x_ + x * cell_, board_y_ + y * cell_, cell_,
+                           PALETTE[static_cast<std::size_t>(cell)]);
+            }
+        }
+    }
+
+    if (state.game_over) {
+        target.fill_rect(board_x_, board_y_, board_w, board_h, Color{0, 0, 0, 160});
+        constexpr std::string_view text = "GAME OVER";
+        const int chars = static_cast<int>(text.size());
+        const int scale = std::max(1, std::min(text_scale_, board_w / ((FONT_WIDTH + 1) * chars)));
+        draw_text(target, board_x_ + (board_w - text_width(chars, scale)) / 2,
+                  board_y_ + (board_h - FONT_HEIGHT * scale) / 2, scale, GAME_OVER, text);
+        return;
+    }
+
+    const auto &piece = state.active_piece;
+    const Color color = PALETTE[static_cast<std::size_t>(piece.type)];
+    const auto &mask = core::tetromino_shape(piece.type)[static_cast<std::size_t>(piece.rotation)];
+    auto ghost = piece;
+    while (fits(state, core::Tetromino{ghost.type, ghost.rotation, {ghost.position.x, ghost.position.y + 1}})) {
+        ++ghost.position.y;
+    }
+    for (const auto &cell : mask) {
+        int x = board_x_ + (ghost.position.x + cell.x) * cell_;
+        int y = ghost.position.y + cell.y;
+        if (y < 0) {
+            continue;
+        }
+        if (cell_ >= 4) {
+            target.outline_rect(x, board_y_ + y * cell_, cell_ - 1, cell_ - 1, with_alpha(color, 140));
+        } else {
+            target.fill_rect(x, board_y_ + y * cell_, cell_, cell_, with_alpha(color, 80));
+        }
+    }
+    for (const auto &cell : mask) {
+        int y = piece.position.y + cell.y;
+        if (y >= 0) {
+            draw_block(target, board_x_ + (piece.position.x + cell.x) * cell_, board_y_ + y * cell_, cell_, color);
+        }
+    }
+}
+
+// A one-pixel gutter once blocks are big enough to show it, and a lit top
+// edge and shaded bottom edge once they are big enough for those too.
+void StateRenderer::draw_block(Framebuffer &target, int x, int y, int size, Color color) const {
+    const int inner = size >= 4 ? size - 1 : size;
+    target.fill_rect(x, y, inner, inner, color);
+    if (size >= 6) {
+        const int edge = std::max(1, size / 5);
+        target.fill_rect(x, y, inner, edge, Color{255, 255, 255, 70});
+        target.fill_rect(x, y + inner - edge, inner, edge, Color{0, 0, 0, 60});
+    }
+}
+
+void StateRenderer::draw_queue(const core::GameState &state, Framebuffer &target) const {
+    draw_text(target, panel_x_, board_y_, text_scale_, LABEL, "NEXT");
+    const int shown = std::min(QUEUE_SHOWN, static_cast<int>(state.queue.size()));
+    for (int i = 0; i < shown; ++i) {
+        auto type = state.queue[static_cast<std::size_t>(i)];
+        const auto &mask = core::tetromino_mask(type, core::Rotation::R0);
+        const int x = panel_x_ + (4 - mask.width) * queue_cell_ / 2;
+        const int y = queue_y_ + i * 3 * queue_cell_ + (2 - mask.height) * queue_cell_ / 2;
+        const Color color = PALETTE[static_cast<std::size_t>(type)];
+        for (int row = 0; row < mask.height; ++row) {
+            for (int col = 0; col < mask.width; ++col) {
+                if ((mask.rows[static_cast<std::size_t>(row)] >> col) & 1u) {
+                    draw_block(target, x + col * queue_cell_, y + row * queue_cell_, queue_cell_, color);
+                }
+            }
+        }
+    }
+}
+
+void StateRenderer::draw_stats(const core::GameState &state, Framebuffer &target) const {
+    const int line = (FONT_HEIGHT + 1) * text_scale_;
+    const std::array<std::pair<std::string_view, int>, 3> stats = {
+        {{"SCORE", state.score}, {"LINES", state.total_lines}, {"LEVEL", state.level}}};
+    int y = stats_y_;
+    for (const auto &[label, value] : stats) {
+        draw_text(target, panel_x_, y, text_scale_, LABEL, label);
+        draw_text(target, panel_x_, y + line, text_scale_, VALUE, std::to_string(value));
+        y += 2 * line + 2 * text_scale_;
+    }
+}
+
+// Each run of set bits in a glyph row is one span.
+void StateRenderer::draw_text(Framebuffer &target, int x, int y, int scale, Color color, std::string_view text) const {
+    for (char c : text) {
+        if (const Glyph *glyph = glyph_for(c)) {
+            for (int row = 0; row < FONT_HEIGHT; ++row) {
+                const unsigned bits = glyph->rows[static_cast<std::size_t>(row)];
+                int col = 0;
+                while (col < FONT_WIDTH) {
+                    if (!((bits >> (FONT_WIDTH - 1 - col)) & 1u)) {
+                        ++col;
+                        continue;
+                    }
+                    int start = col;
+                    while (col < FONT_WIDTH && ((bits >> (FONT_WIDTH - 1 - col)) & 1u)) {
+                        ++col;
+                    }
+                    target.fill_rect(x + start * scale, y + row * scale, (col - start) * scale, scale, color);
+                }
+            }
+        }
+        x += (FONT_WIDTH + 1) * scale;
+    }
+}
+
+} // namespace cretris::render
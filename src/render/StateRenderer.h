@@ -0,0 +1,49 @@
+#pragma once
+
+#include "../core/Game.h"
+#include "Framebuffer.h"
+
+#include <string_view>
+
+namespace cretris::render {
+
+// Draws a GameState without a window or video driver: the board with its
+// ghost and active piece, the next queue, and score, lines and level in the
+// 5x5 pixel font. Layout scales with the cell size, so one renderer makes
+// both postage-stamp thumbnails and full-size stills. Holds no per-frame
+// state; one instance per thread can draw any number of games.
+class StateRenderer {
+public:
+    explicit StateRenderer(int cell_size = 8);
+
+    int cell_size() const noexcept { return cell_; }
+    int width() const noexcept { return width_; }
+    int height() const noexcept { return height_; }
+    Framebuffer make_framebuffer() const { return Framebuffer{width_, height_}; }
+
+    // Overwrites every pixel of `target`, which should be width() x height().
+    void draw(const core::GameState &state, Framebuffer &target) const;
+
+private:
+    void draw_background(Framebuffer &target) const;
+    void draw_board(const core::GameState &state, Framebuffer &target) const;
+    void draw_block(Framebuffer &target, int x, int y, int size, Color color) const;
+    void draw_queue(const core::GameState &state, Framebuffer &target) const;
+    void draw_stats(const core::GameState &state, Framebuffer &target) const;
+    void draw_text(Framebuffer &target, int x, int y, int scale, Color color, std::string_view text) const;
+
+    int cell_;
+    int margin_;
+    int text_scale_;
+    int board_x_;
+    int board_y_;
+    int panel_x_;
+    int panel_width_;
+    int queue_cell_;
+    int queue_y_;
+    int stats_y_;
+    int width_;
+    int height_;
+};
+
+} // namespace cretris::render
@@ -0,0 +1,201 @@
+#include "Replay.h"
+
+#include "../stream/DeltaStream.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace cretris::replay {
+
+namespace {
+
+void put_u32(std::vector<std::uint8_t> &out, std::uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8) {
+        out.push_back(static_cast<std::uint8_t>(value >> shift));
+    }
+}
+
+std::uint32_t get_u32(const std::uint8_t *data) {
+    return static_cast<std::uint32_t>(data[0]) | static_cast<std::uint32_t>(data[1]) << 8 |
+           static_cast<std::uint32_t>(data[2]) << 16 | static_cast<std::uint32_t>(data[3]) << 24;
+}
+
+bool same_state(const core::GameState &a, const core::GameState &b) {
+    return a.board == b.board && a.active_piece.type == b.active_piece.type &&
+           a.active_piece.rotation == b.active_piece.rotation &&
+           a.active_piece.position.x == b.active_piece.position.x &&
+           a.active_piece.position.y == b.active_piece.position.y && a.queue == b.queue && a.score == b.score &&
+           a.total_lines == b.total_lines && a.level == b.level && a.game_over == b.game_over;
+}
+
+} // namespace
+
+KeyframeEntry ReplayView::keyframe(std::size_t index) const {
+    const std::uint8_t *entry = keyframes + index * KEYFRAME_ENTRY_SIZE;
+    return KeyframeEntry{get_u32(entry), get_u32(entry + 4)};
+}
+
+ReplayView Replay::view() const {
+    return ReplayView{seed,
+                      final_score,
+                      final_lines,
+                      inputs.data(),
+                      inputs.size(),
+                      keyframes.data(),
+                      keyframes.size() / KEYFRAME_ENTRY_SIZE,
+                      keyframe_data.data(),
+                      keyframe_data.size()};
+}
+
+ReplayRecorder::ReplayRecorder(std::uint64_t seed, int keyframe_interval)
+    : keyframe_interval_{std::max(1, keyframe_interval)} {
+    replay_.seed = seed;
+}
+
+void ReplayRecorder::record_action(core::InputAction action, const core::Game &game) {
+    if (action != core::InputAction::None && action != core::InputAction::Quit) {
+        record(static_cast<std::uint8_t>(action), game);
+    }
+}
+
+void ReplayRecorder::record_tick(const core::Game &game) { record(TICK_EVENT, game); }
+
+void ReplayRecorder::record(std::uint8_t event, const core::Game &game) {
+    if (finished_) {
+        return;
+    }
+    const auto &state = game.state();
+    replay_.inputs.push_back(event);
+    replay_.final_score = state.score;
+    replay_.final_lines = state.total_lines;
+    finished_ = state.game_over;
+
+    std::uint64_t piece = game.randomizer().position();
+    if (piece - last_keyframe_piece_ < static_cast<std::uint64_t>(keyframe_interval_) || finished_) {
+        return;
+    }
+    last_keyframe_piece_ = piece;
+    put_u32(replay_.keyframes, static_cast<std::uint32_t>(replay_.inputs.size()));
+    put_u32(replay_.keyframes, static_cast<std::uint32_t>(replay_.keyframe_data.size()));
+    for (std::uint64_t value = piece;; value >>= 7) {
+        if (value < 0x80) {
+            replay_.keyframe_data.push_back(static_cast<std::uint8_t>(value));
+            break;
+        }
+        replay_.keyframe_data.push_back(static_cast<std::uint8_t>(value | 0x80));
+    }
+    stream::DeltaEncoder::encode_keyframe(state, replay_.keyframe_data);
+}
+
+std::optional<core::Game> load_keyframe(const ReplayView &replay, std::size_t index) {
+    if (index >= replay.keyframe_count) {
+        return std::nullopt;
+    }
+    std::size_t begin = replay.keyframe(index).data_offset;
+    std::size_t end = index + 1 < replay.keyframe_count ? replay.keyframe(index + 1).data_offset
+                                                         : replay.keyframe_data_size;
+    if (begin >= end || end > replay.keyframe_data_size) {
+        return std::nullopt;
+    }
+
+    std::uint64_t piece = 0;
+    std::size_t offset = begin;
+    for (int shift = 0; offset < end && shift < 64; shift += 7) {
+        std::uint8_t byte = replay.keyframe_data[offset++];
+        piece |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            break;
+        }
+    }
+    stream::DeltaDecoder decoder;
+    if (!decoder.decode(replay.keyframe_data + offset, end - offset) || !decoder.synced()) {
+        return std::nullopt;
+    }
+    return core::Game{decoder.state(), replay.seed, piece};
+}
+
+void apply_event(core::Game &game, std::uint8_t event) {
+    if (event == TICK_EVENT) {
+        game.tick();
+    } else if (event < static_cast<std::uint8_t>(core::InputAction::Quit)) {
+        game.apply_action(static_cast<core::InputAction>(event));
+    }
+}
+
+ReplayPlayer::ReplayPlayer(const ReplayView &replay) : replay_{replay}, game_{replay.seed} {}
+
+bool ReplayPlayer::seek(std::size_t input_index) {
+    input_index = std::min(input_index, replay_.input_count);
+
+    // Last keyframe at or before the target; the seed itself when there is none.
+    std::size_t low = 0;
+    std::size_t high = replay_.keyframe_count;
+    while (low < high) {
+        std::size_t mid = (low + high) / 2;
+        if (replay_.keyframe(mid).input_index <= input_index) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    bool resume_here = input_index >= position_ &&
+                       (low == 0 || replay_.keyframe(low - 1).input_index <= position_);
+    if (!resume_here) {
+        if (low == 0) {
+            game_ = core::Game{replay_.seed};
+            position_ = 0;
+        } else {
+            auto restored = load_keyframe(replay_, low - 1);
+            if (!restored) {
+                return false;
+            }
+            game_ = *restored;
+            position_ = replay_.keyframe(low - 1).input_index;
+        }
+    }
+    while (position_ < input_index) {
+        step();
+    }
+    return true;
+}
+
+bool ReplayPlayer::step() {
+    if (position_ >= replay_.input_count) {
+        return false;
+    }
+    apply_event(game_, replay_.inputs[position_++]);
+    return true;
+}
+
+void ReplayPlayer::run_to_end() {
+    while (step()) {
+    }
+}
+
+VerifyResult verify(const ReplayView &replay) {
+    VerifyResult result;
+    core::Game game{replay.seed};
+    std::size_t next_keyframe = 0;
+    for (std::size_t i = 0; i <= replay.input_count; ++i) {
+        while (next_keyframe < replay.keyframe_count && replay.keyframe(next_keyframe).input_index <= i) {
+            auto stored = load_keyframe(replay, next_keyframe);
+            if (replay.keyframe(next_keyframe).input_index != i || !stored ||
+                stored->randomizer().position() != game.randomizer().position() ||
+                !same_state(stored->state(), game.state())) {
+                ++result.bad_keyframes;
+            }
+            ++next_keyframe;
+        }
+        if (i < replay.input_count) {
+            apply_event(game, replay.inputs[i]);
+        }
+    }
+    result.bad_keyframes += replay.keyframe_count - next_keyframe;
+    result.score = game.state().score;
+    result.lines = game.state().total_lines;
+    result.ok = result.bad_keyframes == 0 && result.score == replay.final_score && result.lines == replay.final_lines;
+    return result;
+}
+
+} // namespace cretris::replay
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "../core/Game.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace cretris::replay {
+
+// A replay is the game's seed plus every input, one byte per event: an
+// InputAction value, or TICK_EVENT for a gravity tick. Every keyframe_interval
+// pieces the recorder also stores a keyframe, the randomizer position followed
+// by a stream::DeltaEncoder keyframe of the state, so a player can seek to any
+// event by restoring the nearest keyframe and replaying at most one interval.
+constexpr std::uint8_t TICK_EVENT = 0x80;
+
+struct KeyframeEntry {
+    std::uint32_t input_index{0}; // the keyframe holds the state after this many events
+    std::uint32_t data_offset{0}; // into keyframe data
+};
+
+// Non-owning view; points into a Replay or into a mapped archive.
+struct ReplayView {
+    std::uint64_t seed{0};
+    std::int32_t final_score{0};
+    std::int32_t final_lines{0};
+    const std::uint8_t *inputs{nullptr};
+    std::size_t input_count{0};
+    const std::uint8_t *keyframes{nullptr}; // keyframe_count packed little-endian KeyframeEntry records
+    std::size_t keyframe_count{0};
+    const std::uint8_t *keyframe_data{nullptr};
+    std::size_t keyframe_data_size{0};
+
+    KeyframeEntry keyframe(std::size_t index) const;
+};
+
+constexpr std::size_t KEYFRAME_ENTRY_SIZE = 8;
+
+struct Replay {
+    std::uint64_t seed{0};
+    std::int32_t final_score{0};
+    std::int32_t final_lines{0};
+    std::vector<std::uint8_t> inputs{};
+    std::vector<std::uint8_t> keyframes{};
+    std::vector<std::uint8_t> keyframe_data{};
+
+    ReplayView view() const;
+};
+
+// Records a game from its first state. Call after each apply_action/tick with
+// the game as it is afterwards; events after game over are dropped.
+class ReplayRecorder {
+public:
+    explicit ReplayRecorder(std::uint64_t seed, int keyframe_interval = 32);
+
+    void record_action(core::InputAction action, const core::Game &game);
+    void record_tick(const core::Game &game);
+
+    const Replay &replay() const noexcept { return replay_; }
+    Replay take() { return std::move(replay_); }
+
+private:
+    void record(std::uint8_t event, const core::Game &game);
+
+    Replay replay_{};
+    int keyframe_interval_;
+    std::uint64_t last_keyframe_piece_{0};
+    bool finished_{false};
+};
+
+class ReplayPlayer {
+public:
+    explicit ReplayPlayer(const ReplayView &replay);
+
+    // Moves to the state after the first `input_index` events, starting from
+    // the closest earlier keyframe. Returns false if a keyframe is corrupt.
+    bool seek(std::size_t input_index);
+    bool step(); // applies the next event; false at the end
+    void run_to_end();
+
+    std::size_t position() const noexcept { return position_; }
+    const core::Game &game() const noexcept { return game_; }
+
+private:
+    ReplayView replay_;
+    core::Game game_;
+    std::size_t position_{0};
+};
+
+// Restores the game stored in keyframe `index`.
+std::optional<core::Game> load_keyframe(const ReplayView &replay, std::size_t index);
+
+void apply_event(core::Game &game, std::uint8_t event);
+
+struct VerifyResult {
+    bool ok{false};
+    std::int32_t score{0};
+    std::int32_t lines{0};
+    std::size_t bad_keyframes{0}; // keyframes that disagree with the re-simulation
+};
+
+// Re-simulates the whole replay from its seed, checks every keyframe on the way
+// and compares the final score and lines with the recorded ones.
+VerifyResult verify(const ReplayView &replay);
+
+} // namespace cretris::replay
@@ -0,0 +1,262 @@
+#include "ReplayArchive.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <random>
+
+namespace cretris::replay {
+
+namespace {
+
+constexpr char MAGIC[8] = {'C', 'R', 'T', 'R', 'P', 'L', 'Y', '1'};
+constexpr std::uint32_t VERSION = 1;
+constexpr std::size_t HEADER_SIZE = 32;
+constexpr std::size_t INDEX_ENTRY_SIZE = 36;
+
+void put(std::vector<std::uint8_t> &out, std::uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+    }
+}
+
+std::uint64_t get(const std::uint8_t *data, int bytes) {
+    std::uint64_t value = 0;
+    for (int i = 0; i < bytes; ++i) {
+        value |= static_cast<std::uint64_t>(data[i]) << (8 * i);
+    }
+    return value;
+}
+
+std::vector<std::uint8_t> header(std::uint32_t count, std::uint64_t index_offset, std::uint32_t id) {
+    std::vector<std::uint8_t> out(MAGIC, MAGIC + sizeof(MAGIC));
+    put(out, VERSION, 4);
+    put(out, count, 4);
+    put(out, index_offset, 8);
+    put(out, id, 4);
+    put(out, 0, 4);
+    return out;
+}
+
+std::uint32_t new_archive_id() {
+    std::random_device device;
+    auto now = static_cast<std::uint64_t>(std::chrono::system_clock::now().time_since_epoch().count());
+    std::uint32_t id = device() ^ static_cast<std::uint32_t>(now ^ (now >> 32));
+    return id != 0 ? id : 1;
+}
+
+} // namespace
+
+ArchiveWriter::~ArchiveWriter() {
+    if (file_) {
+        std::fclose(file_);
+    }
+}
+
+bool ArchiveWriter::open(const std::string &path) {
+    if (file_) {
+        return false;
+    }
+    index_.clear();
+    failed_ = false;
+    file_ = std::fopen(path.c_str(), "r+b");
+    if (file_) {
+        if (!load_index()) {
+            std::fclose(file_);
+            file_ = nullptr;
+            return false;
+        }
+        return true;
+    }
+    if (errno != ENOENT) {
+        return false;
+    }
+
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) {
+        return false;
+    }
+    id_ = new_archive_id();
+    auto placeholder = header(0, 0, id_);
+    failed_ = std::fwrite(placeholder.data(), 1, placeholder.size(), file_) != placeholder.size();
+    offset_ = placeholder.size();
+    return !failed_;
+}
+
+bool ArchiveWriter::load_index() {
+    std::uint8_t head[HEADER_SIZE];
+    if (std::fseek(file_, 0, SEEK_END) != 0) {
+        return false;
+    }
+    long end = std::ftell(file_);
+    if (end < static_cast<long>(HEADER_SIZE) || std::fseek(file_, 0, SEEK_SET) != 0 ||
+        std::fread(head, 1, HEADER_SIZE, file_) != HEADER_SIZE) {
+        return false;
+    }
+    auto size = static_cast<std::uint64_t>(end);
+    std::uint64_t count = get(head + 12, 4);
+    std::uint64_t index_offset = get(head + 16, 8);
+    if (std::memcmp(head, MAGIC, sizeof(MAGIC)) != 0 || get(head + 8, 4) != VERSION || index_offset < HEADER_SIZE ||
+        index_offset > size || (size - index_offset) / INDEX_ENTRY_SIZE < count) {
+        return false;
+    }
+
+    std::vector<std::uint8_t> index(count * INDEX_ENTRY_SIZE);
+    if (std::fseek(file_, static_cast<long>(index_offset), SEEK_SET) != 0 ||
+        std::fread(index.data(), 1, index.size(), file_) != index.size()) {
+        return false;
+    }
+    index_.reserve(count);
+    for (std::uint64_t i = 0; i < count; ++i) {
+        const std::uint8_t *entry = index.data() + i * INDEX_ENTRY_SIZE;
+        IndexEntry parsed{get(entry, 8),
+                          get(entry + 8, 8),
+                          static_cast<std::int32_t>(get(entry + 16, 4)),
+                          static_cast<std::int32_t>(get(entry + 20, 4)),
+                          static_cast<std::uint32_t>(get(entry + 24, 4)),
+                          static_cast<std::uint32_t>(get(entry + 28, 4)),
+                          static_cast<std::uint32_t>(get(entry + 32, 4))};
+        if (parsed.offset < HEADER_SIZE || parsed.offset > index_offset) {
+            return false;
+        }
+        index_.push_back(parsed);
+    }
+
+    // New replays go where the old index was; finish() rewrites the whole index after them.
+    if (std::fseek(file_, static_cast<long>(index_offset), SEEK_SET) != 0) {
+        return false;
+    }
+    id_ = static_cast<std::uint32_t>(get(head + 24, 4));
+    offset_ = index_offset;
+    return true;
+}
+
+bool ArchiveWriter::add(const Replay &replay) {
+    if (!file_ || failed_) {
+        return false;
+    }
+    for (const auto *part : {&replay.keyframes, &replay.inputs, &replay.keyframe_data}) {
+        if (!part->empty() && std::fwrite(part->data(), 1, part->size(), file_) != part->size()) {
+            failed_ = true;
+            return false;
+        }
+    }
+    index_.push_back(IndexEntry{offset_, replay.seed, replay.final_score, replay.final_lines,
+                                static_cast<std::uint32_t>(replay.inputs.size()),
+                                static_cast<std::uint32_t>(replay.keyframes.size() / KEYFRAME_ENTRY_SIZE),
+                                static_cast<std::uint32_t>(replay.keyframe_data.size())});
+    offset_ += replay.keyframes.size() + replay.inputs.size() + replay.keyframe_data.size();
+    return true;
+}
+
+bool ArchiveWriter::finish() {
+    if (!file_) {
+        return false;
+    }
+    std::vector<std::uint8_t> index;
+    index.reserve(index_.size() * INDEX_ENTRY_SIZE);
+    for (const auto &entry : index_) {
+        put(index, entry.offset, 8);
+        put(index, entry.seed, 8);
+        put(index, static_cast<std::uint32_t>(entry.final_score), 4);
+        put(index, static_cast<std::uint32_t>(entry.final_lines), 4);
+        put(index, entry.input_count, 4);
+        put(index, entry.keyframe_count, 4);
+        put(index, entry.keyframe_data_size, 4);
+    }
+    auto final_header = header(static_cast<std::uint32_t>(index_.size()), offset_, id_);
+    bool ok = !failed_ && std::fwrite(index.data(), 1, index.size(), file_) == index.size() &&
+              std::fseek(file_, 0, SEEK_SET) == 0 &&
+              std::fwrite(final_header.data(), 1, final_header.size(), file_) == final_header.size();
+    ok = std::fclose(file_) == 0 && ok;
+    file_ = nullptr;
+    return ok;
+}
+
+ArchiveReader::~ArchiveReader() { close(); }
+
+bool ArchiveReader::open(const std::string &path) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info {};
+    if (::fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < HEADER_SIZE) {
+        ::close(fd);
+        return false;
+    }
+    length_ = static_cast<std::size_t>(info.st_size);
+    void *mapped = ::mmap(nullptr, length_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        length_ = 0;
+        return false;
+    }
+    data_ = static_cast<const std::uint8_t *>(mapped);
+
+    std::uint64_t count = get(data_ + 12, 4);
+    std::uint64_t index_offset = get(data_ + 16, 8);
+    if (std::memcmp(data_, MAGIC, sizeof(MAGIC)) != 0 || get(data_ + 8, 4) != VERSION ||
+        index_offset > length_ || (length_ - index_offset) / INDEX_ENTRY_SIZE < count) {
+        close();
+        return false;
+    }
+    id_ = static_cast<std::uint32_t>(get(data_ + 24, 4));
+
+    replays_.reserve(count);
+    for (std::uint64_t i = 0; i < count; ++i) {
+        const std::uint8_t *entry = data_ + index_offset + i * INDEX_ENTRY_SIZE;
+        std::uint64_t offset = get(entry, 8);
+        std::uint64_t inputs = get(entry + 24, 4);
+        std::uint64_t keyframes = get(entry + 28, 4);
+        std::uint64_t keyframe_bytes = get(entry + 32, 4);
+        if (offset > index_offset || index_offset - offset < keyframes * KEYFRAME_ENTRY_SIZE + inputs + keyframe_bytes) {
+            close();
+            return false;
+        }
+        ReplayView view;
+        view.seed = get(entry + 8, 8);
+        view.final_score = static_cast<std::int32_t>(get(entry + 16, 4));
+        view.final_lines = static_cast<std::int32_t>(get(entry + 20, 4));
+        view.keyframes = data_ + offset;
+        view.keyframe_count = keyframes;
+        view.inputs = view.keyframes + keyframes * KEYFRAME_ENTRY_SIZE;
+        view.input_count = inputs;
+        view.keyframe_data = view.inputs + inputs;
+        view.keyframe_data_size = keyframe_bytes;
+        replays_.push_back(view);
+    }
+    ::madvise(const_cast<std::uint8_t *>(data_), length_, MADV_SEQUENTIAL);
+    return true;
+}
+
+void ArchiveReader::close() {
+    if (data_) {
+        ::munmap(const_cast<std::uint8_t *>(data_), length_);
+    }
+    data_ = nullptr;
+    id_ = 0;
+    length_ = 0;
+    replays_.clear();
+}
+
+std::optional<std::size_t> ArchiveReader::find(std::uint64_t offset) const {
+    // Replays are indexed in file order, so their offsets ascend.
+    auto before = [this](const ReplayView &view, std::uint64_t target) {
+        return static_cast<std::uint64_t>(view.keyframes - data_) < target;
+    };
+    auto it = std::lower_bound(replays_.begin(), replays_.end(), offset, before);
+    if (it == replays_.end() || static_cast<std::uint64_t>(it->keyframes - data_) != offset) {
+        return std::nullopt;
+    }
+    return static_cast<std::size_t>(it - replays_.begin());
+}
+
+} // namespace cretris::replay
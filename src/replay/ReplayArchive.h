@@ -0,0 +1,88 @@
+#pragma once
+
+#include "Replay.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace cretris::replay {
+
+// Many replays packed into one file:
+//
+//   header  "CRTRPLY1", u32 version, u32 replay count, u64 index offset,
+//           u32 archive id, u32 reserved
+//   blobs   per replay: keyframe entries, input bytes, keyframe data
+//   index   per replay: u64 offset, u64 seed, i32 final score, i32 final lines,
+//           u32 input count, u32 keyframe count, u32 keyframe data size
+//
+// All integers are little-endian. The index goes last so replays can be
+// streamed out before their count is known. The archive id is random and
+// fixed at creation, so a replay is named by (archive id, offset) wherever
+// the file is moved.
+class ArchiveWriter {
+public:
+    ArchiveWriter() = default;
+    ~ArchiveWriter();
+
+    ArchiveWriter(const ArchiveWriter &) = delete;
+    ArchiveWriter &operator=(const ArchiveWriter &) = delete;
+
+    // Creates the archive, or appends to an existing one after checking its
+    // header and index. New replays overwrite the old index and finish()
+    // writes the combined one, so an append interrupted before then leaves
+    // the archive unreadable.
+    bool open(const std::string &path);
+    bool add(const Replay &replay);
+    std::uint64_t next_offset() const noexcept { return offset_; } // where the next add() lands
+    std::uint32_t id() const noexcept { return id_; }
+    bool finish(); // writes the index and closes the file
+
+private:
+    struct IndexEntry {
+        std::uint64_t offset;
+        std::uint64_t seed;
+        std::int32_t final_score;
+        std::int32_t final_lines;
+        std::uint32_t input_count;
+        std::uint32_t keyframe_count;
+        std::uint32_t keyframe_data_size;
+    };
+
+    bool load_index(); // reads an existing archive's header and index, leaving the file at the index
+
+    std::FILE *file_{nullptr};
+    std::uint32_t id_{0};
+    std::uint64_t offset_{0};
+    std::vector<IndexEntry> index_{};
+    bool failed_{false};
+};
+
+// Read-only memory mapping of an archive; views point straight into the map.
+class ArchiveReader {
+public:
+    ArchiveReader() = default;
+    ~ArchiveReader();
+
+    ArchiveReader(const ArchiveReader &) = delete;
+    ArchiveReader &operator=(const ArchiveReader &) = delete;
+
+    bool open(const std::string &path); // false if missing or malformed
+    void close();
+
+    std::size_t size() const noexcept { return replays_.size(); }
+    const ReplayView &replay(std::size_t index) const { return replays_[index]; }
+    std::uint32_t id() const noexcept { return id_; }
+    // Index of the replay stored at `offset` (ArchiveWriter::next_offset() before its add()).
+    std::optional<std::size_t> find(std::uint64_t offset) const;
+
+private:
+    const std::uint8_t *data_{nullptr};
+    std::uint32_t id_{0};
+    std::size_t length_{0};
+    std::vector<ReplayView> replays_{};
+};
+
+} // namespace cretris::replay
@@ -0,0 +1,109 @@
+#include "Scheduler.h"
+
+#include <algorithm>
+
+namespace cretris::runtime {
+
+Task::promise_type::~promise_type() {
+    if (scheduler) {
+        scheduler->forget(Handle::from_promise(*this).address());
+    }
+}
+
+Scheduler::Scheduler() : Scheduler(Options{}) {}
+
+Scheduler::Scheduler(Options options) : options_{std::move(options)} {}
+
+Scheduler::~Scheduler() {
+    std::unordered_set<void *> live;
+    {
+        std::lock_guard lock{mutex_};
+        live.swap(live_);
+    }
+    for (void *frame : live) {
+        auto handle = Task::Handle::from_address(frame);
+        handle.promise().scheduler = nullptr;
+        handle.destroy();
+    }
+}
+
+void Scheduler::spawn(Task task) {
+    auto handle = std::exchange(task.handle_, {});
+    handle.promise().scheduler = this;
+    {
+        std::lock_guard lock{mutex_};
+        live_.insert(handle.address());
+    }
+    ready_.push_back(handle);
+}
+
+void Scheduler::post(std::coroutine_handle<> handle) {
+    {
+        std::lock_guard lock{mutex_};
+        returned_.push_back(handle);
+    }
+    if (options_.wake) {
+        options_.wake();
+    }
+}
+
+void Scheduler::add_timer(clock::time_point deadline, std::coroutine_handle<> handle) {
+    timers_.push(Timer{deadline, timer_sequence_++, handle});
+}
+
+void Scheduler::forget(void *frame) {
+    std::lock_guard lock{mutex_};
+    live_.erase(frame);
+}
+
+void Scheduler::run_due() {
+    {
+        std::lock_guard lock{mutex_};
+        ready_.insert(ready_.end(), returned_.begin(), returned_.end());
+        returned_.clear();
+    }
+    auto now = clock::now();
+    while (!timers_.empty() && timers_.top().deadline <= now) {
+        ready_.push_back(timers_.top().handle);
+        timers_.pop();
+    }
+    if (!frame_waiters_.empty() && next_frame_ <= now) {
+        ready_.insert(ready_.end(), frame_waiters_.begin(), frame_waiters_.end());
+        frame_waiters_.clear();
+        next_frame_ = now + options_.frame_interval;
+    }
+    // Tasks made ready while draining run in this call too; new timers and
+    // frame waiters wait for the next one.
+    while (!ready_.empty()) {
+        auto handle = ready_.front();
+        ready_.pop_front();
+        handle.resume();
+    }
+}
+
+Scheduler::clock::time_point Scheduler::next_wake() const {
+    if (!ready_.empty()) {
+        return clock::time_point::min();
+    }
+    {
+        std::lock_guard lock{mutex_};
+        if (!returned_.empty()) {
+            return clock::time_point::min();
+        }
+    }
+    auto wake = clock::time_point::max();
+    if (!timers_.empty()) {
+        wake = timers_.top().deadline;
+    }
+    if (!frame_waiters_.empty()) {
+        wake = std::min(wake, next_frame_);
+    }
+    return wake;
+}
+
+std::size_t Scheduler::tasks() const {
+    std::lock_guard lock{mutex_};
+    return live_.size();
+}
+
+} // namespace cretris::runtime
@@ -0,0 +1,198 @@
+#pragma once
+
+#include "ThreadPool.h"
+
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace cretris::runtime {
+
+class Scheduler;
+
+// Coroutine started by Scheduler::spawn. Nothing awaits it: it runs on the
+// scheduler's thread until it returns, or is destroyed with the scheduler
+// while suspended.
+class Task {
+public:
+    struct promise_type {
+        Scheduler *scheduler{nullptr};
+
+        Task get_return_object() { return Task{Handle::from_promise(*this)}; }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+        ~promise_type();
+    };
+    using Handle = std::coroutine_handle<promise_type>;
+
+    Task(Task &&other) noexcept : handle_{std::exchange(other.handle_, {})} {}
+    Task &operator=(Task &&) = delete;
+    ~Task() {
+        if (handle_) {
+            handle_.destroy(); // never spawned
+        }
+    }
+
+private:
+    friend class Scheduler;
+    explicit Task(Handle handle) : handle_{handle} {}
+
+    Handle handle_{};
+};
+
+// Single-threaded cooperative scheduler for the game loop. Tasks suspend on
+// timers, on the next frame or on a Signal, and the owner of the loop asks
+// next_wake() how long it may block, then calls run_due() to resume whatever
+// became ready. A task may hop onto a ThreadPool and back; only the hop back
+// (resume_here) touches the scheduler from another thread.
+class Scheduler {
+public:
+    using clock = std::chrono::steady_clock;
+
+    struct Options {
+        clock::duration frame_interval{std::chrono::microseconds{16667}};
+        // Called from any thread when a task comes back from a pool, so the
+        // loop can cut its wait short.
+        std::function<void()> wake{};
+    };
+
+    Scheduler();
+    explicit Scheduler(Options options);
+    ~Scheduler(); // destroys tasks still suspended; none may be out on a pool
+
+    Scheduler(const Scheduler &) = delete;
+    Scheduler &operator=(const Scheduler &) = delete;
+
+    void spawn(Task task);
+
+    // Resumes tasks whose timers expired, frame waiters when a frame is due,
+    // tasks back from a pool, and anything those made ready in turn.
+    void run_due();
+    // When run_due() next has work: now if some is ready, time_point::max()
+    // if every task waits on a Signal or nothing is left.
+    clock::time_point next_wake() const;
+    std::size_t tasks() const;
+
+    // Queues a suspended task to resume in run_due(). Scheduler thread only.
+    void schedule(std::coroutine_handle<> handle) { ready_.push_back(handle); }
+    // As schedule(), from any thread.
+    void post(std::coroutine_handle<> handle);
+
+    struct SleepAwaiter {
+        Scheduler &scheduler;
+        clock::time_point deadline;
+
+        bool await_ready() const { return deadline <= clock::now(); }
+        void await_suspend(std::coroutine_handle<> handle) { scheduler.add_timer(deadline, handle); }
+        void await_resume() const noexcept {}
+    };
+
+    struct FrameAwaiter {
+        Scheduler &scheduler;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) { scheduler.frame_waiters_.push_back(handle); }
+        void await_resume() const noexcept {}
+    };
+
+    struct PoolAwaiter {
+        ThreadPool &pool;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) {
+            pool.submit([handle] { handle.resume(); });
+        }
+        void await_resume() const noexcept {}
+    };
+
+    struct ReturnAwaiter {
+        Scheduler &scheduler;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) { scheduler.post(handle); }
+        void await_resume() const noexcept {}
+    };
+
+    SleepAwaiter sleep_until(clock::time_point deadline) { return {*this, deadline}; }
+    SleepAwaiter sleep_for(clock::duration duration) { return {*this, clock::now() + duration}; }
+    // Resumes at the start of the next frame, at most once per frame_interval.
+    FrameAwaiter next_frame() { return {*this}; }
+    // Continues the task on a pool worker; resume_here() brings it back.
+    PoolAwaiter resume_on(ThreadPool &pool) { return {pool}; }
+    ReturnAwaiter resume_here() { return {*this}; }
+
+private:
+    friend struct Task::promise_type;
+
+    struct Timer {
+        clock::time_point deadline;
+        std::uint64_t sequence; // keeps equal deadlines first-in, first-out
+        std::coroutine_handle<> handle;
+
+        bool operator>(const Timer &other) const {
+            return deadline != other.deadline ? deadline > other.deadline : sequence > other.sequence;
+        }
+    };
+
+    void add_timer(clock::time_point deadline, std::coroutine_handle<> handle);
+    void forget(void *frame);
+
+    Options options_;
+    std::deque<std::coroutine_handle<>> ready_;
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<>> timers_;
+    std::uint64_t timer_sequence_{0};
+    std::vector<std::coroutine_handle<>> frame_waiters_;
+    clock::time_point next_frame_{};
+
+    mutable std::mutex mutex_; // guards the two members below
+    std::vector<std::coroutine_handle<>> returned_;
+    std::unordered_set<void *> live_; // frames of spawned tasks not yet finished
+};
+
+// Hands each published value to the tasks waiting for it at that moment;
+// values published while nobody waits are dropped. Scheduler thread only.
+template <typename T>
+class Signal {
+public:
+    explicit Signal(Scheduler &scheduler) : scheduler_{scheduler} {}
+
+    Signal(const Signal &) = delete;
+    Signal &operator=(const Signal &) = delete;
+
+    struct Awaiter {
+        Signal &signal;
+        T value{};
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) { signal.waiters_.push_back({handle, &value}); }
+        T await_resume() { return std::move(value); }
+    };
+
+    Awaiter operator co_await() { return Awaiter{*this}; }
+
+    void publish(const T &value) {
+        auto waiters = std::exchange(waiters_, {});
+        for (auto &[handle, slot] : waiters) {
+            *slot = value;
+            scheduler_.schedule(handle);
+        }
+    }
+
+    bool has_waiters() const noexcept { return !waiters_.empty(); }
+
+private:
+    Scheduler &scheduler_;
+    std::vector<std::pair<std::coroutine_handle<>, T *>> waiters_;
+};
+
+} // namespace cretris::runtime
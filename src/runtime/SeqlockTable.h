@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace cretris::runtime {
+
+// Fixed table of trivially copyable values, one writer per slot and any number
+// of readers. Writers never wait; a reader that overlaps a write retries its
+// copy. Values travel as relaxed 64-bit atomics so a torn copy is only ever
+// discarded, never undefined.
+template <typename T>
+class SeqlockTable {
+    static_assert(std::is_trivially_copyable_v<T>, "seqlock slots are copied word by word");
+
+public:
+    explicit SeqlockTable(std::size_t slots) : slots_(slots) {}
+
+    SeqlockTable(const SeqlockTable &) = delete;
+    SeqlockTable &operator=(const SeqlockTable &) = delete;
+
+    std::size_t size() const noexcept { return slots_.size(); }
+
+    void publish(std::size_t slot, const T &value) noexcept {
+        Slot &target = slots_[slot];
+        Words words{};
+        std::memcpy(words.data(), &value, sizeof(T));
+        auto sequence = target.sequence.load(std::memory_order_relaxed);
+        target.sequence.store(sequence + 1, std::memory_order_relaxed); // odd: write in progress
+        std::atomic_thread_fence(std::memory_order_release);
+        for (std::size_t i = 0; i < WORDS; ++i) {
+            target.words[i].store(words[i], std::memory_order_relaxed);
+        }
+        target.sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    // Copies a consistent value into `out` and returns its sequence number,
+    // which only changes when the slot is published again.
+    std::uint64_t read(std::size_t slot, T &out) const noexcept {
+        const Slot &source = slots_[slot];
+        Words words;
+        for (;;) {
+            auto before = source.sequence.load(std::memory_order_acquire);
+            if (before & 1) {
+                continue;
+            }
+            for (std::size_t i = 0; i < WORDS; ++i) {
+                words[i] = source.words[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (source.sequence.load(std::memory_order_relaxed) == before) {
+                std::memcpy(static_cast<void *>(&out), words.data(), sizeof(T));
+                return before;
+            }
+        }
+    }
+
+    std::uint64_t sequence(std::size_t slot) const noexcept {
+        return slots_[slot].sequence.load(std::memory_order_acquire);
+    }
+
+private:
+    static constexpr std::size_t WORDS = (sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+    using Words = std::array<std::uint64_t, WORDS>;
+
+    struct alignas(64) Slot {
+        std::atomic<std::uint64_t> sequence{0};
+        std::array<std::atomic<std::uint64_t>, WORDS> words{};
+    };
+
+    std::vector<Slot> slots_;
+};
+
+} // namespace cretris::runtime
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+namespace cretris::runtime {
+
+// Bounded single-producer, single-consumer queue. Neither side ever blocks
+// or allocates: try_push fails when the ring is full and try_pop when it is
+// empty. Each index is written by one side only and sits on its own cache
+// line, and each side caches the other's index so a push or pop usually
+// touches no shared line at all.
+template <typename T>
+class SpscRing {
+    static_assert(std::is_nothrow_copy_assignable_v<T>, "slots are assigned in place");
+
+public:
+    // Rounded up to a power of two.
+    explicit SpscRing(std::size_t capacity) : slots_(round_up(capacity)), mask_{slots_.size() - 1} {}
+
+    SpscRing(const SpscRing &) = delete;
+    SpscRing &operator=(const SpscRing &) = delete;
+
+    std::size_t capacity() const noexcept { return slots_.size(); }
+
+    // Producer only.
+    bool try_push(const T &value) noexcept {
+        auto tail = tail_.value.load(std::memory_order_relaxed);
+        if (tail - head_cache_ == slots_.size()) {
+            head_cache_ = head_.value.load(std::memory_order_acquire);
+            if (tail - head_cache_ == slots_.size()) {
+                return false;
+            }
+        }
+        slots_[tail & mask_] = value;
+        tail_.value.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only.
+    std::optional<T> try_pop() noexcept {
+        auto head = head_.value.load(std::memory_order_relaxed);
+        if (head == tail_cache_) {
+            tail_cache_ = tail_.value.load(std::memory_order_acquire);
+            if (head == tail_cache_) {
+                return std::nullopt;
+            }
+        }
+        T value = slots_[head & mask_];
+        head_.value.store(head + 1, std::memory_order_release);
+        return value;
+    }
+
+private:
+    static std::size_t round_up(std::size_t capacity) {
+        std::size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    struct alignas(64) Index {
+        std::atomic<std::uint64_t> value{0};
+    };
+
+    std::vector<T> slots_;
+    std::size_t mask_;
+    Index head_; // next slot to pop, written by the consumer
+    alignas(64) std::uint64_t tail_cache_{0}; // consumer's copy of tail_
+    Index tail_; // next slot to push, written by the producer
+    alignas(64) std::uint64_t head_cache_{0}; // producer's copy of head_
+};
+
+} // namespace cretris::runtime
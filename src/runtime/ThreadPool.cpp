@@ -0,0 +1,89 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace cretris::runtime {
+
+ThreadPool::ThreadPool(std::size_t threads) : chunks_(std::make_unique<Chunk[]>(threads)) {
+    workers_.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i) {
+        workers_.emplace_back([this, i] { worker_loop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    available_.notify_all();
+    for (auto &worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push_back(std::move(task));
+    }
+    available_.notify_one();
+}
+
+void ThreadPool::run_batch(std::size_t count, ChunkFn fn, void *context) {
+    std::size_t chunks = std::min(count, workers_.size() + 1);
+    if (chunks <= 1) {
+        if (count > 0) {
+            fn(context, 0, count);
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> batch(batch_mutex_);
+    auto bounds = [&](std::size_t chunk) { return chunk * count / chunks; };
+    pending_.store(chunks - 1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (std::size_t chunk = 1; chunk < chunks; ++chunk) {
+            chunks_[chunk - 1] = Chunk{fn, context, bounds(chunk), bounds(chunk + 1)};
+        }
+    }
+    available_.notify_all();
+    fn(context, 0, bounds(1));
+
+    for (std::size_t left = pending_.load(std::memory_order_acquire); left != 0;
+         left = pending_.load(std::memory_order_acquire)) {
+        pending_.wait(left, std::memory_order_acquire);
+    }
+}
+
+void ThreadPool::worker_loop(std::size_t index) {
+    Chunk &slot = chunks_[index];
+    while (true) {
+        std::function<void()> task;
+        Chunk chunk;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            available_.wait(lock, [&] { return stopping_ || !tasks_.empty() || slot.fn; });
+            if (slot.fn) {
+                chunk = std::exchange(slot, Chunk{});
+            } else if (tasks_.empty()) {
+                return;
+            } else {
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+        }
+        if (chunk.fn) {
+            chunk.fn(chunk.context, chunk.begin, chunk.end);
+            if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                pending_.notify_one();
+            }
+            continue;
+        }
+        task();
+    }
+}
+
+} // namespace cretris::runtime
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace cretris::runtime {
+
+// Fixed set of worker threads fed from one FIFO queue, plus one chunk slot per
+// worker for parallel_for batches.
+class ThreadPool {
+public:
+    explicit ThreadPool(std::size_t threads = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    std::size_t size() const noexcept { return workers_.size(); }
+
+    void submit(std::function<void()> task);
+
+    // Splits [0, count) into one contiguous chunk per worker plus one for the
+    // calling thread, and returns once body(begin, end) has run for all of them.
+    // Chunks go straight into the workers' slots, so a batch allocates nothing.
+    template <typename Body>
+    void parallel_for(std::size_t count, Body &&body) {
+        using Callable = std::remove_reference_t<Body>;
+        run_batch(count, &body_thunk<Callable>, const_cast<void *>(static_cast<const void *>(&body)));
+    }
+
+private:
+    using ChunkFn = void (*)(void *context, std::size_t begin, std::size_t end);
+
+    struct Chunk {
+        ChunkFn fn{nullptr};
+        void *context{nullptr};
+        std::size_t begin{0};
+        std::size_t end{0};
+    };
+
+    template <typename Callable>
+    static void body_thunk(void *context, std::size_t begin, std::size_t end) {
+        (*static_cast<Callable *>(context))(begin, end);
+    }
+
+    void run_batch(std::size_t count, ChunkFn fn, void *context);
+    void worker_loop(std::size_t index);
+
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> tasks_;
+    std::unique_ptr<Chunk[]> chunks_; // guarded by mutex_; fn is null when the slot is empty
+    std::mutex mutex_;
+    std::condition_variable available_;
+    bool stopping_{false};
+
+    std::mutex batch_mutex_;                 // one batch owns the chunk slots at a time
+    std::atomic<std::size_t> pending_{0};    // completion latch for the current batch
+};
+
+} // namespace cretris::runtime
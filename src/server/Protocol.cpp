@@ -0,0 +1,38 @@
+#include "Protocol.h"
+
+namespace cretris::server {
+
+bool append_frame(MessageType type, const std::uint8_t *payload, std::size_t size, std::vector<std::uint8_t> &out) {
+    if (size > MAX_FRAME_PAYLOAD) {
+        return false;
+    }
+    out.push_back(static_cast<std::uint8_t>(size & 0xFF));
+    out.push_back(static_cast<std::uint8_t>(size >> 8));
+    out.push_back(static_cast<std::uint8_t>(type));
+    out.insert(out.end(), payload, payload + size);
+    return true;
+}
+
+std::size_t parse_frame(const std::uint8_t *data, std::size_t available, FrameView &frame) {
+    if (available < FRAME_HEADER_SIZE) {
+        return 0;
+    }
+    std::size_t size = static_cast<std::size_t>(data[0]) | (static_cast<std::size_t>(data[1]) << 8);
+    if (available < FRAME_HEADER_SIZE + size) {
+        return 0;
+    }
+    frame.type = static_cast<MessageType>(data[2]);
+    frame.payload = data + FRAME_HEADER_SIZE;
+    frame.size = size;
+    return FRAME_HEADER_SIZE + size;
+}
+
+bool decode_action(std::uint8_t byte, core::InputAction &action) {
+    if (byte > static_cast<std::uint8_t>(core::InputAction::Quit)) {
+        return false;
+    }
+    action = static_cast<core::InputAction>(byte);
+    return true;
+}
+
+} // namespace cretris::server
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "../core/Game.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace cretris::server {
+
+// Wire format shared by the session server and its clients.
+//
+// Client -> server: a stream of single bytes, each one an InputAction value.
+// Server -> client: length-prefixed frames, [u16 payload length][u8 type][payload].
+// Delta frames carry stream::DeltaEncoder output; the first one of a session
+// always starts with a keyframe.
+
+enum class MessageType : std::uint8_t {
+    Delta = 2,
+};
+
+constexpr std::size_t FRAME_HEADER_SIZE = 3;
+constexpr std::size_t MAX_FRAME_PAYLOAD = 0xFFFF;
+
+struct FrameView {
+    MessageType type{};
+    const std::uint8_t *payload{nullptr};
+    std::size_t size{0};
+};
+
+bool append_frame(MessageType type, const std::uint8_t *payload, std::size_t size, std::vector<std::uint8_t> &out);
+
+// Returns the bytes consumed, or 0 while `data` does not yet hold a whole frame.
+std::size_t parse_frame(const std::uint8_t *data, std::size_t available, FrameView &frame);
+
+bool decode_action(std::uint8_t byte, core::InputAction &action);
+
+} // namespace cretris::server
@@ -0,0 +1,85 @@
+#include "RemoteSession.h"
+
+#include "Protocol.h"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+
+namespace cretris::server {
+
+RemoteSession::~RemoteSession() { disconnect(); }
+
+bool RemoteSession::connect(const std::string &socket_path) {
+    disconnect();
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path)) {
+        return false;
+    }
+    std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+
+    fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd_ < 0) {
+        return false;
+    }
+    if (::connect(fd_, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0) {
+        disconnect();
+        return false;
+    }
+    ::fcntl(fd_, F_SETFL, ::fcntl(fd_, F_GETFL) | O_NONBLOCK);
+    return true;
+}
+
+void RemoteSession::send_action(core::InputAction action) {
+    if (fd_ < 0 || action == core::InputAction::None) {
+        return;
+    }
+    auto byte = static_cast<std::uint8_t>(action);
+    if (::send(fd_, &byte, 1, MSG_NOSIGNAL) < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+        disconnect();
+    }
+}
+
+bool RemoteSession::poll() {
+    if (fd_ < 0) {
+        return false;
+    }
+    std::array<std::uint8_t, 4096> buffer{};
+    while (true) {
+        ssize_t received = ::recv(fd_, buffer.data(), buffer.size(), 0);
+        if (received > 0) {
+            inbox_.insert(inbox_.end(), buffer.begin(), buffer.begin() + received);
+            continue;
+        }
+        if (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            disconnect();
+        }
+        break;
+    }
+
+    std::size_t offset = 0;
+    FrameView frame;
+    while (std::size_t consumed = parse_frame(inbox_.data() + offset, inbox_.size() - offset, frame)) {
+        if (frame.type == MessageType::Delta) {
+            decoder_.decode(frame.payload, frame.size);
+        }
+        offset += consumed;
+    }
+    inbox_.erase(inbox_.begin(), inbox_.begin() + static_cast<std::ptrdiff_t>(offset));
+    return fd_ >= 0;
+}
+
+void RemoteSession::disconnect() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+} // namespace cretris::server
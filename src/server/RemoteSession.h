@@ -0,0 +1,40 @@
+#pragma once
+
+#include "../core/Game.h"
+#include "../stream/DeltaStream.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace cretris::server {
+
+// Client side of a server session: forwards inputs and rebuilds the GameState
+// from the delta stream so any Frontend can render it.
+class RemoteSession {
+public:
+    RemoteSession() = default;
+    ~RemoteSession();
+
+    RemoteSession(const RemoteSession &) = delete;
+    RemoteSession &operator=(const RemoteSession &) = delete;
+
+    bool connect(const std::string &socket_path);
+    void send_action(core::InputAction action);
+
+    // Drains whatever the server has sent; returns false once the connection is gone.
+    bool poll();
+
+    const core::GameState &state() const noexcept { return decoder_.state(); }
+    bool synced() const noexcept { return decoder_.synced(); }
+    core::GameEvents take_events() noexcept { return decoder_.take_events(); } // see DeltaDecoder::take_events
+
+private:
+    void disconnect();
+
+    int fd_{-1};
+    std::vector<std::uint8_t> inbox_{};
+    stream::DeltaDecoder decoder_{};
+};
+
+} // namespace cretris::server
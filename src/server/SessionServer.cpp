@@ -0,0 +1,514 @@
+#include "SessionServer.h"
+
+#include "Protocol.h"
+#include "TimerWheel.h"
+
+#include "../core/Game.h"
+#include "../metrics/GameMetrics.h"
+#include "../stream/DeltaStream.h"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+namespace cretris::server {
+
+namespace {
+
+constexpr std::uint32_t WAKE_ID = std::numeric_limits<std::uint32_t>::max();
+constexpr int MAX_EVENTS = 256;
+constexpr std::size_t READ_CHUNK = 256;
+
+std::uint64_t pack_key(std::uint32_t id, std::uint32_t generation) {
+    return (static_cast<std::uint64_t>(generation) << 32) | id;
+}
+
+void drain_eventfd(int fd) {
+    std::uint64_t value = 0;
+    while (::read(fd, &value, sizeof(value)) > 0) {
+    }
+}
+
+void signal_eventfd(int fd) {
+    std::uint64_t one = 1;
+    [[maybe_unused]] auto written = ::write(fd, &one, sizeof(one));
+}
+
+void raise_fd_limit() {
+    rlimit limit{};
+    if (::getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        ::setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+} // namespace
+
+class SessionServer::Worker {
+public:
+    explicit Worker(const ServerConfig &config) : config_(config) {
+        epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+        event_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = pack_key(WAKE_ID, 0);
+        ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, event_fd_, &event);
+    }
+
+    ~Worker() {
+        for (auto &session : sessions_) {
+            if (session.fd >= 0) {
+                ::close(session.fd);
+            }
+        }
+        for (int fd : handoff_) {
+            ::close(fd);
+        }
+        ::close(event_fd_);
+        ::close(epoll_fd_);
+    }
+
+    bool valid() const noexcept { return epoll_fd_ >= 0 && event_fd_ >= 0; }
+
+    void start() {
+        epoch_ = std::chrono::steady_clock::now();
+        thread_ = std::thread([this] { run(); });
+    }
+
+    void stop() {
+        stop_.store(true, std::memory_order_relaxed);
+        signal_eventfd(event_fd_);
+    }
+
+    void join() {
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    void adopt(int fd) {
+        {
+            std::lock_guard<std::mutex> lock(handoff_mutex_);
+            handoff_.push_back(fd);
+        }
+        signal_eventfd(event_fd_);
+    }
+
+private:
+    struct Session {
+        int fd{-1};
+        std::uint32_t generation{0};
+        std::optional<core::Game> game{};
+        stream::DeltaEncoder encoder{};
+        std::vector<std::uint8_t> pending{};
+        bool write_armed{false};
+        TimerWheel::Tick gravity_deadline{0}; // of the last scheduled tick
+        int gravity_level{0};                 // level it was scheduled at; 0 before the first
+    };
+
+    TimerWheel::Tick now_tick() const {
+        auto elapsed = std::chrono::steady_clock::now() - epoch_;
+        return static_cast<TimerWheel::Tick>(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count());
+    }
+
+    void run() {
+        std::array<epoll_event, MAX_EVENTS> events{};
+        while (!stop_.load(std::memory_order_relaxed)) {
+            int timeout = poll_timeout();
+            int count = ::epoll_wait(epoll_fd_, events.data(), MAX_EVENTS, timeout);
+            if (count < 0 && errno != EINTR) {
+                std::perror("epoll_wait");
+                break;
+            }
+            for (int i = 0; i < count; ++i) {
+                std::uint32_t id = static_cast<std::uint32_t>(events[i].data.u64);
+                std::uint32_t generation = static_cast<std::uint32_t>(events[i].data.u64 >> 32);
+                if (id == WAKE_ID) {
+                    drain_eventfd(event_fd_);
+                    accept_handoffs();
+                    continue;
+                }
+                if (id >= sessions_.size() || sessions_[id].generation != generation || sessions_[id].fd < 0) {
+                    continue;
+                }
+                if (events[i].events & (EPOLLHUP | EPOLLERR)) {
+                    close_session(id);
+                    continue;
+                }
+                if (events[i].events & EPOLLOUT) {
+                    flush_pending(id);
+                }
+                if (sessions_[id].fd >= 0 && (events[i].events & EPOLLIN)) {
+                    handle_readable(id);
+                }
+            }
+
+            wheel_.advance(now_tick(), [this](std::uint32_t id, std::uint32_t generation) {
+                if (id < sessions_.size() && sessions_[id].generation == generation && sessions_[id].fd >= 0) {
+                    on_gravity(id);
+                }
+            });
+        }
+    }
+
+    // Milliseconds until the next gravity tick is due (the wheel's
+    // granularity), or -1 to block until a socket or handoff wakes us.
+    int poll_timeout() const {
+        auto deadline = wheel_.next_deadline();
+        if (!deadline) {
+            return -1;
+        }
+        auto now = now_tick();
+        if (*deadline <= now) {
+            return 0;
+        }
+        return static_cast<int>(std::min<TimerWheel::Tick>(*deadline - now, std::numeric_limits<int>::max()));
+    }
+
+    void accept_handoffs() {
+        std::vector<int> incoming;
+        {
+            std::lock_guard<std::mutex> lock(handoff_mutex_);
+            incoming.swap(handoff_);
+        }
+        for (int fd : incoming) {
+            open_session(fd);
+        }
+    }
+
+    void open_session(int fd) {
+        std::uint32_t id;
+        if (!free_ids_.empty()) {
+            id = free_ids_.back();
+            free_ids_.pop_back();
+        } else {
+            id = static_cast<std::uint32_t>(sessions_.size());
+            sessions_.emplace_back();
+        }
+
+        auto &session = sessions_[id];
+        session.fd = fd;
+        session.encoder.force_keyframe();
+        session.pending.clear();
+        session.write_armed = false;
+        session.gravity_level = 0;
+        session.game.emplace();
+        game_metrics_.game_started();
+        sessions_open_.add(1);
+
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLRDHUP;
+        event.data.u64 = pack_key(id, session.generation);
+        if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) != 0) {
+            close_session(id);
+            return;
+        }
+
+        send_state(id);
+        if (session.fd >= 0) {
+            schedule_gravity(id);
+        }
+    }
+
+    void close_session(std::uint32_t id) {
+        auto &session = sessions_[id];
+        if (session.fd < 0) {
+            return;
+        }
+        ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, session.fd, nullptr);
+        ::close(session.fd);
+        session.fd = -1;
+        session.game.reset();
+        sessions_open_.add(-1);
+        session.pending.clear();
+        session.pending.shrink_to_fit();
+        ++session.generation; // invalidates pending timer entries and stale epoll events
+        free_ids_.push_back(id);
+    }
+
+    void handle_readable(std::uint32_t id) {
+        std::array<std::uint8_t, READ_CHUNK> buffer{};
+        bool changed = false;
+        while (true) {
+            ssize_t received = ::recv(sessions_[id].fd, buffer.data(), buffer.size(), 0);
+            if (received == 0) {
+                close_session(id);
+                return;
+            }
+            if (received < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    close_session(id);
+                    return;
+                }
+                break;
+            }
+            auto &game = *sessions_[id].game;
+            for (ssize_t i = 0; i < received; ++i) {
+                core::InputAction action{};
+                if (!decode_action(buffer[static_cast<std::size_t>(i)], action) || action == core::InputAction::Quit) {
+                    close_session(id);
+                    return;
+                }
+                if (action != core::InputAction::None) {
+                    // Drained per action: a batch of hard drops can emit more events than the buffer holds.
+                    game.apply_action(action);
+                    game_metrics_.record(game.take_events());
+                    changed = true;
+                }
+            }
+        }
+        if (changed) {
+            send_state(id);
+        }
+    }
+
+    void on_gravity(std::uint32_t id) {
+        auto &game = *sessions_[id].game;
+        game.tick();
+        game_metrics_.record(game.take_events());
+        send_state(id);
+        if (sessions_[id].fd >= 0) {
+            schedule_gravity(id);
+        }
+    }
+
+    // Ticks follow the previous deadline rather than the moment it was handled,
+    // so lateness in epoll_wait or in handling does not add up over a game.
+    // A new game or level starts the cadence afresh, and a session more than
+    // an interval behind drops the ticks it missed instead of bursting through them.
+    void schedule_gravity(std::uint32_t id) {
+        auto &session = sessions_[id];
+        const auto &state = session.game->state();
+        if (state.game_over) {
+            return;
+        }
+        auto interval = static_cast<TimerWheel::Tick>(session.game->gravity_interval().count());
+        auto now = now_tick();
+        auto deadline = session.gravity_deadline + interval;
+        if (session.gravity_level != state.level) {
+            deadline = now + interval;
+        } else if (deadline + interval < now) {
+            deadline = now;
+        }
+        session.gravity_deadline = deadline;
+        session.gravity_level = state.level;
+        wheel_.schedule(id, session.generation, deadline);
+    }
+
+    void send_state(std::uint32_t id) {
+        auto &session = sessions_[id];
+        delta_.clear();
+        session.encoder.encode(session.game->state(), delta_);
+        if (delta_.empty()) {
+            return;
+        }
+        frame_.clear();
+        append_frame(MessageType::Delta, delta_.data(), delta_.size(), frame_);
+
+        std::size_t offset = 0;
+        if (session.pending.empty()) {
+            ssize_t sent = ::send(session.fd, frame_.data(), frame_.size(), MSG_NOSIGNAL);
+            if (sent < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+                close_session(id);
+                return;
+            }
+            offset = sent > 0 ? static_cast<std::size_t>(sent) : 0;
+            if (offset == frame_.size()) {
+                return;
+            }
+        }
+
+        if (session.pending.size() + frame_.size() - offset > config_.max_pending_bytes) {
+            close_session(id);
+            return;
+        }
+        session.pending.insert(session.pending.end(), frame_.begin() + static_cast<std::ptrdiff_t>(offset), frame_.end());
+        set_write_interest(id, true);
+    }
+
+    void flush_pending(std::uint32_t id) {
+        auto &session = sessions_[id];
+        while (!session.pending.empty()) {
+            ssize_t sent = ::send(session.fd, session.pending.data(), session.pending.size(), MSG_NOSIGNAL);
+            if (sent < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    close_session(id);
+                }
+                return;
+            }
+            session.pending.erase(session.pending.begin(), session.pending.begin() + sent);
+        }
+        set_write_interest(id, false);
+    }
+
+    void set_write_interest(std::uint32_t id, bool enabled) {
+        auto &session = sessions_[id];
+        if (session.write_armed == enabled) {
+            return;
+        }
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLRDHUP | (enabled ? EPOLLOUT : 0u);
+        event.data.u64 = pack_key(id, session.generation);
+        ::epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, session.fd, &event);
+        session.write_armed = enabled;
+    }
+
+    const ServerConfig &config_;
+    int epoll_fd_{-1};
+    int event_fd_{-1};
+    std::thread thread_{};
+    std::atomic<bool> stop_{false};
+    std::mutex handoff_mutex_{};
+    std::vector<int> handoff_{};
+    std::vector<Session> sessions_{};
+    std::vector<std::uint32_t> free_ids_{};
+    TimerWheel wheel_{};
+    std::vector<std::uint8_t> delta_{};
+    std::vector<std::uint8_t> frame_{};
+    std::chrono::steady_clock::time_point epoch_{};
+    metrics::GameMetrics game_metrics_{};
+    metrics::Gauge &sessions_open_{metrics::registry().gauge("cretris_server_sessions", "Open server sessions.")};
+};
+
+SessionServer::SessionServer(ServerConfig config) : config_(std::move(config)) {
+    if (config_.worker_count == 0) {
+        config_.worker_count = 1;
+    }
+}
+
+SessionServer::~SessionServer() {
+    for (auto &worker : workers_) {
+        worker->stop();
+        worker->join();
+    }
+    if (listen_fd_ >= 0) {
+        ::close(listen_fd_);
+        ::unlink(config_.socket_path.c_str());
+    }
+    if (wake_fd_ >= 0) {
+        ::close(wake_fd_);
+    }
+}
+
+int SessionServer::run() {
+    raise_fd_limit();
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (config_.socket_path.size() >= sizeof(address.sun_path)) {
+        std::fprintf(stderr, "Socket path too long: %s\n", config_.socket_path.c_str());
+        return 1;
+    }
+    std::memcpy(address.sun_path, config_.socket_path.c_str(), config_.socket_path.size() + 1);
+
+    listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+        std::perror("socket");
+        return 1;
+    }
+    ::unlink(config_.socket_path.c_str());
+    if (::bind(listen_fd_, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 ||
+        ::listen(listen_fd_, SOMAXCONN) != 0) {
+        std::perror("bind/listen");
+        return 1;
+    }
+
+    wake_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    int epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+    if (wake_fd_ < 0 || epoll_fd < 0) {
+        std::perror("eventfd/epoll");
+        return 1;
+    }
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = listen_fd_;
+    ::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd_, &event);
+    event.data.fd = wake_fd_;
+    ::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd_, &event);
+
+    for (std::size_t i = 0; i < config_.worker_count; ++i) {
+        auto worker = std::make_unique<Worker>(config_);
+        if (!worker->valid()) {
+            std::perror("worker setup");
+            ::close(epoll_fd);
+            return 1;
+        }
+        worker->start();
+        workers_.push_back(std::move(worker));
+    }
+
+    std::printf("cretris server listening on %s with %zu workers\n", config_.socket_path.c_str(), workers_.size());
+    std::fflush(stdout);
+
+    std::size_t next_worker = 0;
+    std::array<epoll_event, 2> events{};
+    while (!stop_requested_.load(std::memory_order_relaxed)) {
+        int count = ::epoll_wait(epoll_fd, events.data(), static_cast<int>(events.size()), -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::perror("epoll_wait");
+            break;
+        }
+        for (int i = 0; i < count; ++i) {
+            if (events[static_cast<std::size_t>(i)].data.fd == wake_fd_) {
+                drain_eventfd(wake_fd_);
+                continue;
+            }
+            while (true) {
+                int client = ::accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+                if (client < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                        std::perror("accept4");
+                    }
+                    break;
+                }
+                workers_[next_worker]->adopt(client);
+                next_worker = (next_worker + 1) % workers_.size();
+            }
+        }
+    }
+
+    ::close(epoll_fd);
+    for (auto &worker : workers_) {
+        worker->stop();
+    }
+    for (auto &worker : workers_) {
+        worker->join();
+    }
+    workers_.clear();
+    return 0;
+}
+
+void SessionServer::request_stop() {
+    stop_requested_.store(true, std::memory_order_relaxed);
+    if (wake_fd_ >= 0) {
+        signal_eventfd(wake_fd_);
+    }
+}
+
+} // namespace cretris::server
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace cretris::server {
+
+struct ServerConfig {
+    std::string socket_path{"/tmp/cretris.sock"};
+    std::size_t worker_count{4};
+    std::size_t max_pending_bytes{64 * 1024}; // per client; slower readers are disconnected
+};
+
+// Hosts many independent core::Game sessions behind a Unix domain socket.
+// The calling thread accepts connections and deals them out round-robin to a
+// fixed set of workers; each worker owns its shard of sessions, an epoll set
+// and a TimerWheel that drives gravity for every game it hosts.
+class SessionServer {
+public:
+    explicit SessionServer(ServerConfig config);
+    ~SessionServer();
+
+    SessionServer(const SessionServer &) = delete;
+    SessionServer &operator=(const SessionServer &) = delete;
+
+    int run(); // blocks until request_stop(); returns a process exit code
+    void request_stop();
+
+private:
+    class Worker;
+
+    ServerConfig config_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::atomic<bool> stop_requested_{false};
+    int listen_fd_{-1};
+    int wake_fd_{-1};
+};
+
+} // namespace cretris::server
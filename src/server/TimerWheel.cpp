@@ -0,0 +1,38 @@
+#include "TimerWheel.h"
+
+#include <algorithm>
+
+namespace cretris::server {
+
+TimerWheel::TimerWheel(std::size_t slot_bits)
+    : slots_(std::size_t{1} << slot_bits), mask_((Tick{1} << slot_bits) - 1) {}
+
+void TimerWheel::schedule(std::uint32_t id, std::uint32_t generation, Tick deadline) {
+    // Never schedule into a slot the wheel has already passed.
+    deadline = std::max(deadline, current_);
+    slots_[static_cast<std::size_t>(deadline & mask_)].push_back(Entry{id, generation, deadline});
+    earliest_ = size_ == 0 ? deadline : std::min(earliest_, deadline);
+    ++size_;
+}
+
+void TimerWheel::find_earliest() {
+    earliest_ = ~Tick{0};
+    if (size_ == 0) {
+        return;
+    }
+    // An entry due this revolution sits in the slot of its own deadline, so the
+    // first such slot holds the earliest one; entries passed on the way are a
+    // revolution or more out. With none due this revolution every slot has
+    // been seen and earliest_ is the minimum over all of them.
+    for (Tick tick = current_; tick <= current_ + mask_; ++tick) {
+        for (const auto &entry : slots_[static_cast<std::size_t>(tick & mask_)]) {
+            if (entry.deadline == tick) {
+                earliest_ = tick;
+                return;
+            }
+            earliest_ = std::min(earliest_, entry.deadline);
+        }
+    }
+}
+
+} // namespace cretris::server
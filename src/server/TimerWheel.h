@@ -0,0 +1,90 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace cretris::server {
+
+// Hashed timing wheel with one-millisecond slots. Every session on a worker
+// shares a single wheel, so gravity for thousands of games costs one pass over
+// the due slot instead of a timer (or thread) per game. Deadlines further out
+// than one revolution stay in their slot until their round comes up.
+class TimerWheel {
+public:
+    using Tick = std::uint64_t;
+
+    explicit TimerWheel(std::size_t slot_bits = 12);
+
+    void schedule(std::uint32_t id, std::uint32_t generation, Tick deadline);
+
+    // Fires on_expire(id, generation) for every entry due at or before now.
+    template <typename Fn>
+    void advance(Tick now, Fn &&on_expire);
+
+    // Earliest pending deadline, so a caller can sleep until it instead of
+    // polling every tick. Cached: schedule() lowers it, and advance() only
+    // searches for the next one after entries fire.
+    std::optional<Tick> next_deadline() const noexcept {
+        return size_ == 0 ? std::nullopt : std::optional<Tick>{earliest_};
+    }
+
+    Tick current() const noexcept { return current_; }
+    std::size_t size() const noexcept { return size_; }
+
+private:
+    struct Entry {
+        std::uint32_t id;
+        std::uint32_t generation;
+        Tick deadline;
+    };
+
+    void find_earliest();
+
+    std::vector<std::vector<Entry>> slots_;
+    std::vector<Entry> scratch_;
+    Tick mask_;
+    Tick current_{0};
+    Tick earliest_{~Tick{0}}; // meaningful while size_ > 0
+    std::size_t size_{0};
+};
+
+template <typename Fn>
+void TimerWheel::advance(Tick now, Fn &&on_expire) {
+    if (size_ == 0 || earliest_ > now) {
+        // Nothing is due. Entries in the slots skipped here are a revolution
+        // or more out and wait there for their round.
+        current_ = std::max(current_, now + 1);
+        return;
+    }
+
+    // After a stall longer than one revolution every slot is due; visiting each once is enough.
+    Tick revolution = mask_ + 1;
+    if (now >= current_ + revolution) {
+        current_ = now + 1 - revolution;
+    }
+
+    while (current_ <= now) {
+        auto &slot = slots_[static_cast<std::size_t>(current_ & mask_)];
+        ++current_;
+        if (slot.empty()) {
+            continue;
+        }
+        scratch_.clear();
+        std::swap(scratch_, slot);
+        for (const auto &entry : scratch_) {
+            if (entry.deadline <= now) {
+                --size_;
+                on_expire(entry.id, entry.generation);
+            } else {
+                slot.push_back(entry);
+            }
+        }
+    }
+    find_earliest();
+}
+
+} // namespace cretris::server
@@ -0,0 +1,117 @@
+#include "Simulation.h"
+
+#include "../ai/Planner.h"
+
+#include <optional>
+
+namespace cretris::sim {
+
+Simulation::Simulation(SimulationConfig config)
+    : config_{config}, counters_(std::max<std::size_t>(config.threads, 1)), samples_{counters_.size()} {}
+
+Simulation::~Simulation() {
+    stop();
+    join();
+}
+
+void Simulation::start() {
+    started_ = std::chrono::steady_clock::now();
+    running_.store(counters_.size(), std::memory_order_release);
+    for (std::size_t i = 0; i < counters_.size(); ++i) {
+        threads_.emplace_back([this, i] { run_worker(i); });
+    }
+}
+
+void Simulation::stop() { stopping_.store(true, std::memory_order_relaxed); }
+
+void Simulation::join() {
+    for (auto &thread : threads_) {
+        thread.join();
+    }
+    threads_.clear();
+}
+
+SimulationStats Simulation::stats() const {
+    SimulationStats stats;
+    stats.target_games = config_.games;
+    stats.workers.reserve(counters_.size());
+    for (const auto &counters : counters_) {
+        WorkerStats worker;
+        worker.games = counters.games.load(std::memory_order_relaxed);
+        worker.pieces = counters.pieces.load(std::memory_order_relaxed);
+        worker.lines = counters.lines.load(std::memory_order_relaxed);
+        worker.busy_ns = counters.busy_ns.load(std::memory_order_relaxed);
+        for (std::size_t b = 0; b < SCORE_BUCKETS; ++b) {
+            stats.score_histogram[b] += counters.scores[b].load(std::memory_order_relaxed);
+        }
+        stats.games += worker.games;
+        stats.pieces += worker.pieces;
+        stats.lines += worker.lines;
+        stats.workers.push_back(worker);
+    }
+    if (finished()) {
+        stats.elapsed = std::chrono::nanoseconds{finished_ns_.load(std::memory_order_relaxed)};
+    } else {
+        stats.elapsed = std::chrono::steady_clock::now() - started_;
+    }
+    return stats;
+}
+
+void Simulation::run_worker(std::size_t index) {
+    using clock = std::chrono::steady_clock;
+    auto &counters = counters_[index];
+    std::optional<ai::Planner> planner;
+    if (config_.policy == Policy::Planner) {
+        planner.emplace(ai::Planner::Options{ai::Weights{}, false, ai::EvaluatorBackend::Auto});
+    }
+
+    std::uint32_t since_sample = config_.sample_every;
+    while (!stopping_.load(std::memory_order_relaxed)) {
+        auto game_index = next_game_.fetch_add(1, std::memory_order_relaxed);
+        if (game_index >= config_.games) {
+            break;
+        }
+        auto begin = clock::now();
+        auto seed = core::counter_random(config_.seed, game_index);
+        core::Game game{seed};
+        int pieces = 0;
+        std::uint64_t step = 0;
+        while (!game.state().game_over && pieces < config_.max_pieces) {
+            if (planner) {
+                auto actions = planner->plan(game);
+                if (actions.empty()) {
+                    break;
+                }
+                for (auto action : actions) {
+                    game.apply_action(action);
+                }
+            } else if (++step % 4 == 0) {
+                game.tick();
+            } else {
+                auto draw = core::counter_random(seed, step);
+                game.apply_action(static_cast<core::InputAction>(draw % static_cast<std::uint64_t>(core::InputAction::Quit)));
+            }
+            if (game.take_changes() & core::CHANGE_LOCK) {
+                ++pieces;
+                WorkerCounters::bump(counters.pieces);
+                if (++since_sample >= config_.sample_every) {
+                    since_sample = 0;
+                    samples_.publish(index, game.state());
+                }
+            }
+        }
+
+        WorkerCounters::bump(counters.lines, static_cast<std::uint64_t>(game.state().total_lines));
+        WorkerCounters::bump(counters.scores[score_bucket(game.state().score)]);
+        WorkerCounters::bump(counters.busy_ns, static_cast<std::uint64_t>((clock::now() - begin).count()));
+        WorkerCounters::bump(counters.games);
+    }
+
+    std::int64_t elapsed = (clock::now() - started_).count();
+    auto latest = finished_ns_.load(std::memory_order_relaxed);
+    while (latest < elapsed && !finished_ns_.compare_exchange_weak(latest, elapsed, std::memory_order_relaxed)) {
+    }
+    running_.fetch_sub(1, std::memory_order_release);
+}
+
+} // namespace cretris::sim
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "../core/Game.h"
+#include "../runtime/SeqlockTable.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace cretris::sim {
+
+enum class Policy {
+    Random,  // random inputs, gravity every fourth step
+    Planner, // ai::Planner placements
+};
+
+struct SimulationConfig {
+    std::uint64_t games{10000};
+    std::size_t threads{std::thread::hardware_concurrency()};
+    std::uint64_t seed{1};
+    Policy policy{Policy::Random};
+    int max_pieces{1000};           // a game that reaches this many pieces is scored as finished
+    std::uint32_t sample_every{64}; // pieces between mini-board samples
+};
+
+// Score histogram buckets: 0, then [2^(i-1), 2^i) up to the last, open-ended one.
+constexpr std::size_t SCORE_BUCKETS = 20;
+
+constexpr std::size_t score_bucket(int score) {
+    std::size_t bucket = 0;
+    for (auto value = static_cast<std::uint32_t>(std::max(score, 0)); value != 0 && bucket + 1 < SCORE_BUCKETS;
+         value >>= 1) {
+        ++bucket;
+    }
+    return bucket;
+}
+
+// Written by exactly one worker, read by anyone. Plain relaxed load + store
+// rather than read-modify-write, and a cache line per worker, so counting costs
+// the simulation nothing measurable.
+struct alignas(64) WorkerCounters {
+    std::atomic<std::uint64_t> games{0};
+    std::atomic<std::uint64_t> pieces{0};
+    std::atomic<std::uint64_t> lines{0};
+    std::atomic<std::uint64_t> busy_ns{0};
+    std::array<std::atomic<std::uint64_t>, SCORE_BUCKETS> scores{};
+
+    static void bump(std::atomic<std::uint64_t> &counter, std::uint64_t by = 1) noexcept {
+        counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    }
+};
+
+struct WorkerStats {
+    std::uint64_t games{0};
+    std::uint64_t pieces{0};
+    std::uint64_t lines{0};
+    std::uint64_t busy_ns{0};
+};
+
+struct SimulationStats {
+    std::vector<WorkerStats> workers{};
+    std::array<std::uint64_t, SCORE_BUCKETS> score_histogram{};
+    std::uint64_t games{0};
+    std::uint64_t pieces{0};
+    std::uint64_t lines{0};
+    std::uint64_t target_games{0};
+    std::chrono::nanoseconds elapsed{0};
+};
+
+// Plays config.games games across worker threads that pull seeds from a
+// shared counter, counting into per-worker WorkerCounters and publishing one
+// sampled game per worker for display.
+class Simulation {
+public:
+    explicit Simulation(SimulationConfig config);
+    ~Simulation();
+
+    Simulation(const Simulation &) = delete;
+    Simulation &operator=(const Simulation &) = delete;
+
+    void start();
+    void stop(); // asks workers to finish their current game
+    void join();
+    bool finished() const noexcept { return running_.load(std::memory_order_acquire) == 0; }
+
+    std::size_t workers() const noexcept { return counters_.size(); }
+    SimulationStats stats() const;
+    // Latest sampled state of a game on `worker`; returns its publish sequence.
+    std::uint64_t sample(std::size_t worker, core::GameState &out) const { return samples_.read(worker, out); }
+
+private:
+    void run_worker(std::size_t index);
+
+    SimulationConfig config_;
+    std::vector<WorkerCounters> counters_;
+    runtime::SeqlockTable<core::GameState> samples_;
+    std::vector<std::thread> threads_;
+    std::atomic<std::uint64_t> next_game_{0};
+    std::atomic<std::size_t> running_{0};
+    std::atomic<bool> stopping_{false};
+    std::chrono::steady_clock::time_point started_{};
+    std::atomic<std::int64_t> finished_ns_{0}; // elapsed when the last worker exited
+};
+
+} // namespace cretris::sim
@@ -0,0 +1,302 @@
+#include "ResultsStore.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstring>
+
+namespace cretris::store {
+
+namespace {
+
+static_assert(std::endian::native == std::endian::little, "records are mapped in host byte order");
+
+constexpr char MAGIC[8] = {'C', 'R', 'T', 'R', 'E', 'S', '0', '1'};
+constexpr std::uint32_t VERSION = 1;
+constexpr std::size_t HEADER_SIZE = 64;
+constexpr std::size_t INITIAL_RECORDS = 16 * 1024;
+constexpr std::uint32_t NONE = ~std::uint32_t{0};
+
+struct Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t record_size;
+    std::uint64_t count;
+};
+
+std::uint32_t checksum(const ResultRecord &record) {
+    std::uint64_t words[5];
+    std::memcpy(words, &record, sizeof(words));
+    std::uint64_t hash = 0x9E3779B97F4A7C15ull;
+    for (std::uint64_t word : words) {
+        hash = (hash ^ word) * 0xBF58476D1CE4E5B9ull;
+        hash ^= hash >> 31;
+    }
+    hash = (hash ^ record.replay_archive) * 0xBF58476D1CE4E5B9ull;
+    hash ^= hash >> 31;
+    return static_cast<std::uint32_t>(hash ^ (hash >> 32));
+}
+
+bool valid(const ResultRecord &record) { return record.checksum == checksum(record); }
+
+std::uint64_t seed_hash(std::uint64_t seed) {
+    seed ^= seed >> 33;
+    seed *= 0xFF51AFD7ED558CCDull;
+    return seed ^ (seed >> 33);
+}
+
+} // namespace
+
+ResultsStore::ResultsStore(std::size_t top_capacity) : top_capacity_{std::max<std::size_t>(1, top_capacity)} {}
+
+ResultsStore::~ResultsStore() { close(); }
+
+const ResultRecord *ResultsStore::records() const noexcept {
+    return reinterpret_cast<const ResultRecord *>(base_ + HEADER_SIZE);
+}
+
+bool ResultsStore::open(const std::string &path) {
+    close();
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        return false;
+    }
+    struct stat info {};
+    if (::fstat(fd_, &info) != 0) {
+        close();
+        return false;
+    }
+
+    auto existing = static_cast<std::size_t>(info.st_size);
+    bool fresh = existing == 0;
+    if (!fresh && (existing < HEADER_SIZE || (existing - HEADER_SIZE) % sizeof(ResultRecord) != 0)) {
+        close();
+        return false;
+    }
+    if (!reserve(fresh ? INITIAL_RECORDS : (existing - HEADER_SIZE) / sizeof(ResultRecord))) {
+        close();
+        return false;
+    }
+
+    auto *header = reinterpret_cast<Header *>(base_);
+    if (fresh) {
+        std::memcpy(header->magic, MAGIC, sizeof(MAGIC));
+        header->version = VERSION;
+        header->record_size = sizeof(ResultRecord);
+        header->count = 0;
+    } else if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 || header->version != VERSION ||
+               header->record_size != sizeof(ResultRecord)) {
+        close();
+        return false;
+    }
+
+    // Committed records are indexed unless damaged; past the committed count,
+    // records that still check out were written by a process that died before
+    // publishing them.
+    std::size_t capacity = (mapped_bytes_ - HEADER_SIZE) / sizeof(ResultRecord);
+    std::size_t committed = std::min<std::size_t>(header->count, capacity);
+    std::size_t position = 0;
+    for (; position < capacity; ++position) {
+        const ResultRecord &record = records()[position];
+        if (!valid(record)) {
+            if (position >= committed) {
+                break;
+            }
+            ++corrupt_;
+        }
+        next_same_seed_.push_back(NONE);
+        if (valid(record)) {
+            index(static_cast<std::uint32_t>(position), record);
+        }
+    }
+    count_ = position;
+    header->count = count_;
+    return true;
+}
+
+void ResultsStore::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (base_) {
+        ::munmap(base_, mapped_bytes_);
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+    fd_ = -1;
+    base_ = nullptr;
+    mapped_bytes_ = 0;
+    count_ = 0;
+    corrupt_ = 0;
+    top_.clear();
+    seed_slots_.clear();
+    seed_count_ = 0;
+    next_same_seed_.clear();
+}
+
+bool ResultsStore::reserve(std::size_t wanted) {
+    std::size_t bytes = HEADER_SIZE + wanted * sizeof(ResultRecord);
+    if (bytes <= mapped_bytes_) {
+        return true;
+    }
+    if (base_) {
+        bytes = std::max(bytes, HEADER_SIZE + 2 * (mapped_bytes_ - HEADER_SIZE));
+    }
+    struct stat info {};
+    if (::fstat(fd_, &info) != 0) {
+        return false;
+    }
+    if (static_cast<std::size_t>(info.st_size) < bytes && ::ftruncate(fd_, static_cast<off_t>(bytes)) != 0) {
+        return false;
+    }
+    void *mapped = base_ ? ::mremap(base_, mapped_bytes_, bytes, MREMAP_MAYMOVE)
+                         : ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+    base_ = static_cast<std::uint8_t *>(mapped);
+    mapped_bytes_ = bytes;
+    return true;
+}
+
+std::int64_t ResultsStore::append(const ResultRecord &record) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!base_ || !reserve(count_ + 1)) {
+        return -1;
+    }
+    ResultRecord stored = record;
+    stored.checksum = checksum(stored);
+    auto position = static_cast<std::uint32_t>(count_);
+    std::memcpy(base_ + HEADER_SIZE + position * sizeof(ResultRecord), &stored, sizeof(stored));
+    next_same_seed_.push_back(NONE);
+    index(position, stored);
+    ++count_;
+    std::atomic_ref<std::uint64_t>{reinterpret_cast<Header *>(base_)->count}.store(count_, std::memory_order_release);
+    return position;
+}
+
+bool ResultsStore::append(const ResultRecord *batch, std::size_t count) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!base_ || !reserve(count_ + count)) {
+        return false;
+    }
+    next_same_seed_.reserve(count_ + count);
+    for (std::size_t i = 0; i < count; ++i) {
+        ResultRecord stored = batch[i];
+        stored.checksum = checksum(stored);
+        auto position = static_cast<std::uint32_t>(count_ + i);
+        std::memcpy(base_ + HEADER_SIZE + position * sizeof(ResultRecord), &stored, sizeof(stored));
+        next_same_seed_.push_back(NONE);
+        index(position, stored);
+    }
+    count_ += count;
+    std::atomic_ref<std::uint64_t>{reinterpret_cast<Header *>(base_)->count}.store(count_, std::memory_order_release);
+    return true;
+}
+
+void ResultsStore::flush_async() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (base_) {
+        ::msync(base_, HEADER_SIZE + count_ * sizeof(ResultRecord), MS_ASYNC);
+    }
+}
+
+ResultRecord ResultsStore::record(std::size_t index) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return records()[index];
+}
+
+void ResultsStore::index(std::uint32_t position, const ResultRecord &record) {
+    // Heap ordered so the front is the weakest kept entry.
+    auto better = [this](std::uint32_t a, std::uint32_t b) {
+        int score_a = records()[a].score;
+        int score_b = records()[b].score;
+        return score_a != score_b ? score_a > score_b : a < b;
+    };
+    if (top_.size() < top_capacity_) {
+        top_.push_back(position);
+        std::push_heap(top_.begin(), top_.end(), better);
+    } else if (record.score > records()[top_.front()].score) {
+        std::pop_heap(top_.begin(), top_.end(), better);
+        top_.back() = position;
+        std::push_heap(top_.begin(), top_.end(), better);
+    }
+
+    SeedSlot &slot = seed_slot(record.seed);
+    if (slot.last == NONE) {
+        slot = SeedSlot{record.seed, position, position};
+        ++seed_count_;
+    } else {
+        next_same_seed_[slot.last] = position;
+        slot.last = position;
+    }
+}
+
+ResultsStore::SeedSlot &ResultsStore::seed_slot(std::uint64_t seed) {
+    if ((seed_count_ + 1) * 2 > seed_slots_.size()) {
+        grow_seed_table();
+    }
+    std::size_t mask = seed_slots_.size() - 1;
+    for (std::size_t i = seed_hash(seed) & mask;; i = (i + 1) & mask) {
+        if (seed_slots_[i].last == NONE || seed_slots_[i].seed == seed) {
+            return seed_slots_[i];
+        }
+    }
+}
+
+void ResultsStore::grow_seed_table() {
+    std::vector<SeedSlot> old = std::move(seed_slots_);
+    seed_slots_.assign(std::max<std::size_t>(1024, old.size() * 2), SeedSlot{0, NONE, NONE});
+    std::size_t mask = seed_slots_.size() - 1;
+    for (const auto &slot : old) {
+        if (slot.last == NONE) {
+            continue;
+        }
+        std::size_t i = seed_hash(slot.seed) & mask;
+        while (seed_slots_[i].last != NONE) {
+            i = (i + 1) & mask;
+        }
+        seed_slots_[i] = slot;
+    }
+}
+
+std::vector<ResultRecord> ResultsStore::top(std::size_t k) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::uint32_t> order = top_;
+    std::sort(order.begin(), order.end(), [this](std::uint32_t a, std::uint32_t b) {
+        int score_a = records()[a].score;
+        int score_b = records()[b].score;
+        return score_a != score_b ? score_a > score_b : a < b;
+    });
+    order.resize(std::min(k, order.size()));
+    std::vector<ResultRecord> result;
+    result.reserve(order.size());
+    for (auto position : order) {
+        result.push_back(records()[position]);
+    }
+    return result;
+}
+
+std::vector<ResultRecord> ResultsStore::by_seed(std::uint64_t seed) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<ResultRecord> result;
+    if (seed_slots_.empty()) {
+        return result;
+    }
+    std::size_t mask = seed_slots_.size() - 1;
+    for (std::size_t i = seed_hash(seed) & mask; seed_slots_[i].last != NONE; i = (i + 1) & mask) {
+        if (seed_slots_[i].seed == seed) {
+            for (std::uint32_t position = seed_slots_[i].first; position != NONE; position = next_same_seed_[position]) {
+                result.push_back(records()[position]);
+            }
+            break;
+        }
+    }
+    return result;
+}
+
+} // namespace cretris::store
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace cretris::store {
+
+constexpr std::uint64_t NO_REPLAY = ~std::uint64_t{0};
+
+// One finished game. Stored verbatim as a fixed 48-byte little-endian record.
+struct ResultRecord {
+    std::uint64_t seed{0};
+    std::int32_t score{0};
+    std::int32_t lines{0};
+    std::int32_t level{0};
+    std::uint32_t duration_ms{0};
+    std::uint64_t replay_offset{NO_REPLAY}; // byte offset of the replay in its archive
+    std::uint64_t finished_at_ms{0};        // unix time
+    std::uint32_t checksum{0};              // filled in by the store
+    std::uint32_t replay_archive{0};        // id of the archive holding the replay; 0 if unknown
+};
+
+static_assert(sizeof(ResultRecord) == 48, "ResultRecord is the on-disk layout");
+
+// Append-only log of finished games in one memory-mapped file.
+//
+// Appends copy the record into the mapping and bump the committed count in the
+// header; nothing is fsynced, so a crash of the process loses nothing and a
+// crash of the machine loses whatever the kernel had not written back. Each
+// record carries a checksum, and records that fail it are skipped on open.
+// The top-K and per-seed indexes live in memory and are rebuilt by one scan at
+// open.
+class ResultsStore {
+public:
+    explicit ResultsStore(std::size_t top_capacity = 1000);
+    ~ResultsStore();
+
+    ResultsStore(const ResultsStore &) = delete;
+    ResultsStore &operator=(const ResultsStore &) = delete;
+
+    bool open(const std::string &path); // creates the file if missing
+    void close();
+    bool is_open() const noexcept { return base_ != nullptr; }
+
+    // Thread-safe; returns the record's index, or -1 if the file could not grow.
+    std::int64_t append(const ResultRecord &record);
+    bool append(const ResultRecord *records, std::size_t count);
+
+    void flush_async(); // schedules write-back without waiting for it
+
+    std::size_t size() const noexcept { return count_; }
+    std::size_t corrupt_records() const noexcept { return corrupt_; }
+    ResultRecord record(std::size_t index) const;
+
+    // Best `k` games by score (ties keep the earlier game first); k is capped at top_capacity.
+    std::vector<ResultRecord> top(std::size_t k) const;
+    // Every game played with `seed`, oldest first.
+    std::vector<ResultRecord> by_seed(std::uint64_t seed) const;
+
+private:
+    struct SeedSlot {
+        std::uint64_t seed;
+        std::uint32_t first;
+        std::uint32_t last; // UINT32_MAX marks an empty slot
+    };
+
+    const ResultRecord *records() const noexcept;
+    bool reserve(std::size_t records);
+    void index(std::uint32_t position, const ResultRecord &record);
+    SeedSlot &seed_slot(std::uint64_t seed);
+    void grow_seed_table();
+
+    int fd_{-1};
+    std::uint8_t *base_{nullptr};
+    std::size_t mapped_bytes_{0};
+    std::size_t count_{0};
+    std::size_t corrupt_{0};
+
+    std::size_t top_capacity_;
+    std::vector<std::uint32_t> top_{}; // min-heap on (score, -index)
+    std::vector<SeedSlot> seed_slots_{};
+    std::size_t seed_count_{0};
+    std::vector<std::uint32_t> next_same_seed_{};
+    mutable std::mutex mutex_{};
+};
+
+} // namespace cretris::store
@@ -0,0 +1,436 @@
+#include "DeltaStream.h"
+
+#include <algorithm>
+
+namespace cretris::stream {
+
+namespace {
+
+using Board = decltype(core::GameState::board);
+
+constexpr std::uint8_t OP_MASK = 0xF0;
+constexpr std::uint8_t ARG_MASK = 0x0F;
+
+struct Reader {
+    const std::uint8_t *cursor;
+    const std::uint8_t *end;
+    bool ok{true};
+
+    std::uint8_t byte() {
+        if (cursor == end) {
+            ok = false;
+            return 0;
+        }
+        return *cursor++;
+    }
+
+    std::uint64_t varint() {
+        std::uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            std::uint8_t b = byte();
+            value |= static_cast<std::uint64_t>(b & 0x7F) << shift;
+            if (!(b & 0x80)) {
+                return value;
+            }
+        }
+        ok = false;
+        return 0;
+    }
+
+    std::int64_t svarint() {
+        std::uint64_t raw = varint();
+        return static_cast<std::int64_t>(raw >> 1) ^ -static_cast<std::int64_t>(raw & 1);
+    }
+};
+
+void put_varint(std::vector<std::uint8_t> &out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<std::uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<std::uint8_t>(value));
+}
+
+void put_svarint(std::vector<std::uint8_t> &out, std::int64_t value) {
+    put_varint(out, (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63));
+}
+
+void put_op(std::vector<std::uint8_t> &out, DeltaOp op, core::Rotation rotation = core::Rotation::R0) {
+    out.push_back(static_cast<std::uint8_t>(static_cast<std::uint8_t>(op) | static_cast<std::uint8_t>(rotation)));
+}
+
+bool fits(const Board &board, core::TetrominoType type, core::Rotation rotation, int x, int y) {
+    const auto &cells = core::tetromino_shape(type)[static_cast<std::size_t>(rotation)];
+    for (const auto &cell : cells) {
+        int cx = x + cell.x;
+        int cy = y + cell.y;
+        if (cx < 0 || cx >= core::BOARD_WIDTH || cy < 0 || cy >= core::BOARD_HEIGHT || board[cy][cx] != -1) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Records the cleared rows, bottom first, in `event` when given one.
+int clear_full_rows(Board &board, core::GameEvent *event = nullptr) {
+    int cleared = 0;
+    int write = core::BOARD_HEIGHT - 1;
+    for (int read = core::BOARD_HEIGHT - 1; read >= 0; --read) {
+        bool full = std::all_of(board[read].begin(), board[read].end(), [](int value) { return value != -1; });
+        if (full) {
+            if (event && event->count < event->rows.size()) {
+                event->rows[event->count++] = static_cast<std::int16_t>(read);
+            }
+            ++cleared;
+            continue;
+        }
+        if (write != read) {
+            board[write] = board[read];
+        }
+        --write;
+    }
+    for (; write >= 0; --write) {
+        board[write].fill(-1);
+    }
+    return cleared;
+}
+
+// Mirrors core::Game::lock_piece followed by spawn_piece, including the events
+// it emits when given a buffer; score travels separately.
+void apply_lock(core::GameState &state, core::Rotation rotation, int x, int y, core::TetrominoType queued,
+                core::GameEvents *events = nullptr) {
+    core::GameEvent locked;
+    locked.type = core::GameEventType::PieceLocked;
+    locked.value = static_cast<std::int16_t>(state.active_piece.type);
+    const auto &cells = core::tetromino_shape(state.active_piece.type)[static_cast<std::size_t>(rotation)];
+    for (const auto &cell : cells) {
+        int cx = x + cell.x;
+        int cy = y + cell.y;
+        if (cx >= 0 && cx < core::BOARD_WIDTH && cy >= 0 && cy < core::BOARD_HEIGHT) {
+            state.board[cy][cx] = static_cast<int>(state.active_piece.type);
+            locked.cells[locked.count++] = {static_cast<std::int16_t>(cx), static_cast<std::int16_t>(cy)};
+        }
+    }
+
+    core::GameEvent cleared;
+    cleared.type = core::GameEventType::LinesCleared;
+    int lines = clear_full_rows(state.board, &cleared);
+    int previous_level = state.level;
+    if (lines > 0) {
+        state.total_lines += lines;
+        state.level = std::min(core::MAX_LEVEL, state.total_lines / core::LINES_PER_LEVEL + 1);
+    }
+    if (events) {
+        events->push_back(locked);
+        if (lines > 0) {
+            events->push_back(cleared);
+        }
+        if (state.level != previous_level) {
+            core::GameEvent level;
+            level.type = core::GameEventType::LevelChanged;
+            level.value = static_cast<std::int16_t>(state.level);
+            events->push_back(level);
+        }
+    }
+
+    if (!state.queue.empty()) {
+        state.active_piece = core::Tetromino{state.queue.front(), core::Rotation::R0, {core::BOARD_WIDTH / 2 - 1, 0}};
+        state.queue.pop_front();
+    }
+    state.queue.push_back(queued);
+}
+
+bool same_piece(const core::Tetromino &a, const core::Tetromino &b) {
+    return a.type == b.type && a.rotation == b.rotation && a.position.x == b.position.x &&
+           a.position.y == b.position.y;
+}
+
+bool same_state(const core::GameState &a, const core::GameState &b) {
+    return a.score == b.score && a.total_lines == b.total_lines && a.level == b.level &&
+           a.game_over == b.game_over && same_piece(a.active_piece, b.active_piece) && a.queue == b.queue &&
+           a.board == b.board;
+}
+
+// The piece that was active in `before` rested somewhere before it locked; find a resting
+// pose whose lock and line clear reproduces `after`'s board, trying the last seen column first.
+bool find_lock_pose(const core::GameState &before, const core::GameState &after, core::Rotation &rotation, int &x,
+                    int &y) {
+    const auto type = before.active_piece.type;
+    auto matches = [&](core::Rotation rot, int px, int py) {
+        Board board = before.board;
+        const auto &cells = core::tetromino_shape(type)[static_cast<std::size_t>(rot)];
+        for (const auto &cell : cells) {
+            board[py + cell.y][px + cell.x] = static_cast<int>(type);
+        }
+        clear_full_rows(board);
+        return board == after.board;
+    };
+    auto try_column = [&](core::Rotation rot, int px) {
+        for (int py = -2; py < core::BOARD_HEIGHT; ++py) {
+            if (fits(before.board, type, rot, px, py) && !fits(before.board, type, rot, px, py + 1) &&
+                matches(rot, px, py)) {
+                rotation = rot;
+                x = px;
+                y = py;
+                return true;
+            }
+        }
+        return false;
+    };
+
+    if (try_column(before.active_piece.rotation, before.active_piece.position.x)) {
+        return true;
+    }
+    for (std::size_t r = 0; r < static_cast<std::size_t>(core::Rotation::Count); ++r) {
+        for (int px = -2; px < core::BOARD_WIDTH + 2; ++px) {
+            if (try_column(static_cast<core::Rotation>(r), px)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+DeltaEncoder::DeltaEncoder(int keyframe_interval) : keyframe_interval_(std::max(1, keyframe_interval)) {}
+
+void DeltaEncoder::encode(const core::GameState &state, std::vector<std::uint8_t> &out) {
+    if (synced_ && locks_since_keyframe_ < keyframe_interval_) {
+        std::size_t mark = out.size();
+        if (encode_delta(state, out)) {
+            return;
+        }
+        out.resize(mark);
+    }
+    encode_keyframe(state, out);
+    shadow_ = state;
+    synced_ = true;
+    locks_since_keyframe_ = 0;
+}
+
+void DeltaEncoder::encode_keyframe(const core::GameState &state, std::vector<std::uint8_t> &out) {
+    put_op(out, DeltaOp::Keyframe);
+    put_svarint(out, state.score);
+    put_varint(out, static_cast<std::uint64_t>(state.total_lines));
+    out.push_back(static_cast<std::uint8_t>(state.level));
+    out.push_back(state.game_over ? 1 : 0);
+    out.push_back(static_cast<std::uint8_t>(static_cast<std::uint8_t>(state.active_piece.type) |
+                                            (static_cast<std::uint8_t>(state.active_piece.rotation) << 4)));
+    out.push_back(static_cast<std::uint8_t>(static_cast<std::int8_t>(state.active_piece.position.x)));
+    out.push_back(static_cast<std::uint8_t>(static_cast<std::int8_t>(state.active_piece.position.y)));
+    out.push_back(static_cast<std::uint8_t>(state.queue.size()));
+    for (auto type : state.queue) {
+        out.push_back(static_cast<std::uint8_t>(type));
+    }
+
+    // Two cells per byte: empty is 0, otherwise TetrominoType + 1.
+    std::uint8_t pending = 0;
+    bool high = false;
+    for (const auto &row : state.board) {
+        for (int cell : row) {
+            auto nibble = static_cast<std::uint8_t>((cell + 1) & ARG_MASK);
+            if (high) {
+                out.push_back(static_cast<std::uint8_t>(pending | (nibble << 4)));
+            } else {
+                pending = nibble;
+            }
+            high = !high;
+        }
+    }
+    if (high) {
+        out.push_back(pending);
+    }
+}
+
+bool DeltaEncoder::encode_delta(const core::GameState &state, std::vector<std::uint8_t> &out) {
+    core::GameState next = shadow_;
+
+    if (next.board != state.board || next.queue != state.queue) {
+        if (next.queue.empty() || state.queue.size() != next.queue.size() ||
+            state.active_piece.type != next.queue.front() ||
+            !std::equal(next.queue.begin() + 1, next.queue.end(), state.queue.begin())) {
+            return false;
+        }
+        core::Rotation rotation{};
+        int x = 0;
+        int y = 0;
+        if (!find_lock_pose(next, state, rotation, x, y)) {
+            return false;
+        }
+        auto queued = state.queue.back();
+        put_op(out, DeltaOp::Lock, rotation);
+        out.push_back(static_cast<std::uint8_t>(static_cast<std::int8_t>(x)));
+        out.push_back(static_cast<std::uint8_t>(static_cast<std::int8_t>(y)));
+        out.push_back(static_cast<std::uint8_t>(queued));
+        apply_lock(next, rotation, x, y, queued);
+        ++locks_since_keyframe_;
+    }
+
+    if (!same_piece(next.active_piece, state.active_piece)) {
+        if (next.active_piece.type != state.active_piece.type) {
+            return false;
+        }
+        int dx = state.active_piece.position.x - next.active_piece.position.x;
+        int dy = state.active_piece.position.y - next.active_piece.position.y;
+        if (dx >= -8 && dx < 8 && dy >= -8 && dy < 8) {
+            put_op(out, DeltaOp::Move, state.active_piece.rotation);
+            out.push_back(static_cast<std::uint8_t>(((dx & ARG_MASK) << 4) | (dy & ARG_MASK)));
+        } else {
+            put_op(out, DeltaOp::Place, state.active_piece.rotation);
+            out.push_back(static_cast<std::uint8_t>(static_cast<std::int8_t>(state.active_piece.position.x)));
+            out.push_back(static_cast<std::uint8_t>(static_cast<std::int8_t>(state.active_piece.position.y)));
+        }
+        next.active_piece = state.active_piece;
+    }
+
+    if (next.score != state.score) {
+        put_op(out, DeltaOp::ScoreDelta);
+        put_svarint(out, static_cast<std::int64_t>(state.score) - next.score);
+        next.score = state.score;
+    }
+
+    if (state.game_over != next.game_over) {
+        if (!state.game_over) {
+            return false;
+        }
+        put_op(out, DeltaOp::GameOver);
+        next.game_over = true;
+    }
+
+    if (!same_state(next, state)) {
+        return false;
+    }
+    shadow_ = std::move(next);
+    return true;
+}
+
+bool DeltaDecoder::decode(const std::uint8_t *data, std::size_t size) {
+    Reader in{data, data + size};
+    while (in.ok && in.cursor != in.end) {
+        std::uint8_t header = in.byte();
+        auto op = static_cast<DeltaOp>(header & OP_MASK);
+        auto rotation = static_cast<core::Rotation>(header & ARG_MASK);
+        if (op != DeltaOp::Keyframe && !synced_) {
+            return false;
+        }
+        if ((header & ARG_MASK) >= static_cast<std::uint8_t>(core::Rotation::Count)) {
+            in.ok = false;
+            break;
+        }
+
+        switch (op) {
+        case DeltaOp::Keyframe: {
+            int previous_level = state_.level;
+            state_.score = static_cast<int>(in.svarint());
+            state_.total_lines = static_cast<int>(in.varint());
+            state_.level = in.byte();
+            if (state_.level != previous_level) {
+                // Joining mid-game: effects keyed to the level start from the right one.
+                core::GameEvent level;
+                level.type = core::GameEventType::LevelChanged;
+                level.value = static_cast<std::int16_t>(state_.level);
+                events_.push_back(level);
+            }
+            state_.game_over = in.byte() != 0;
+            std::uint8_t piece = in.byte();
+            if ((piece & ARG_MASK) >= static_cast<std::uint8_t>(core::TetrominoType::Count) ||
+                (piece >> 4) >= static_cast<std::uint8_t>(core::Rotation::Count)) {
+                in.ok = false;
+                break;
+            }
+            state_.active_piece.type = static_cast<core::TetrominoType>(piece & ARG_MASK);
+            state_.active_piece.rotation = static_cast<core::Rotation>(piece >> 4);
+            state_.active_piece.position.x = static_cast<std::int8_t>(in.byte());
+            state_.active_piece.position.y = static_cast<std::int8_t>(in.byte());
+            std::size_t queued = in.byte();
+            if (queued > state_.queue.capacity()) {
+                in.ok = false;
+                break;
+            }
+            state_.queue.clear();
+            for (std::size_t i = 0; i < queued; ++i) {
+                std::uint8_t type = in.byte();
+                if (type >= static_cast<std::uint8_t>(core::TetrominoType::Count)) {
+                    in.ok = false;
+                }
+                state_.queue.push_back(static_cast<core::TetrominoType>(type));
+            }
+            std::uint8_t packed = 0;
+            bool high = false;
+            for (auto &row : state_.board) {
+                for (int &cell : row) {
+                    if (!high) {
+                        packed = in.byte();
+                    }
+                    int value = high ? (packed >> 4) : (packed & ARG_MASK);
+                    if (value > core::GARBAGE_CELL + 1) {
+                        in.ok = false;
+                    }
+                    cell = value - 1;
+                    high = !high;
+                }
+            }
+            synced_ = in.ok;
+            break;
+        }
+        case DeltaOp::Move: {
+            std::uint8_t delta = in.byte();
+            auto dx = static_cast<int>(static_cast<std::int8_t>(delta) >> 4);
+            auto dy = static_cast<int>(static_cast<std::int8_t>(static_cast<std::uint8_t>(delta << 4)) >> 4);
+            state_.active_piece.rotation = rotation;
+            state_.active_piece.position.x += dx;
+            state_.active_piece.position.y += dy;
+            break;
+        }
+        case DeltaOp::Place:
+            state_.active_piece.rotation = rotation;
+            state_.active_piece.position.x = static_cast<std::int8_t>(in.byte());
+            state_.active_piece.position.y = static_cast<std::int8_t>(in.byte());
+            break;
+        case DeltaOp::Lock: {
+            int x = static_cast<std::int8_t>(in.byte());
+            int y = static_cast<std::int8_t>(in.byte());
+            std::uint8_t queued = in.byte();
+            if (!in.ok || queued >= static_cast<std::uint8_t>(core::TetrominoType::Count)) {
+                in.ok = false;
+                break;
+            }
+            // The stream has no drop op, but a piece that locks below where it
+            // was last shown fell there within one update, which is a hard drop.
+            if (int fallen = y - state_.active_piece.position.y; fallen > 0) {
+                core::GameEvent drop;
+                drop.type = core::GameEventType::HardDrop;
+                drop.value = static_cast<std::int16_t>(fallen);
+                events_.push_back(drop);
+            }
+            apply_lock(state_, rotation, x, y, static_cast<core::TetrominoType>(queued), &events_);
+            break;
+        }
+        case DeltaOp::ScoreDelta:
+            state_.score += static_cast<int>(in.svarint());
+            break;
+        case DeltaOp::GameOver:
+            if (!state_.game_over) {
+                core::GameEvent over;
+                over.type = core::GameEventType::GameOver;
+                events_.push_back(over);
+            }
+            state_.game_over = true;
+            break;
+        default:
+            in.ok = false;
+            break;
+        }
+    }
+
+    if (!in.ok) {
+        synced_ = false;
+    }
+    if (size > 0) {
+        ++state_.version; // lets front ends skip redraws between updates
+    }
+    return in.ok;
+}
+
+} // namespace cretris::stream
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "../core/Game.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace cretris::stream {
+
+// Compact spectator stream for a single game.
+//
+// The encoder keeps a shadow copy of the state its decoders have seen and
+// emits only the operations that carry them forward: piece moves, locks (the
+// decoder replays the line clears and queue advance itself) and score changes.
+// A keyframe with the full state is sent first, every keyframe_interval locks,
+// and whenever a change cannot be expressed as a delta. A typical placement
+// costs 4-8 bytes, and the byte stream can be broadcast unchanged to any number
+// of DeltaDecoders.
+enum class DeltaOp : std::uint8_t {
+    Keyframe = 0x00,
+    Move = 0x10,       // low bits: rotation; payload: signed dx/dy nibbles
+    Place = 0x20,      // low bits: rotation; payload: x, y
+    Lock = 0x30,       // low bits: rotation; payload: x, y, newly queued piece
+    ScoreDelta = 0x40, // payload: zigzag varint
+    GameOver = 0x50,
+};
+
+class DeltaEncoder {
+public:
+    explicit DeltaEncoder(int keyframe_interval = 64);
+
+    // Appends the operations that bring a decoder from the previously encoded state to this one.
+    void encode(const core::GameState &state, std::vector<std::uint8_t> &out);
+
+    // Appends a standalone keyframe for a late joiner without disturbing the delta chain.
+    static void encode_keyframe(const core::GameState &state, std::vector<std::uint8_t> &out);
+
+    void force_keyframe() noexcept { synced_ = false; }
+
+private:
+    bool encode_delta(const core::GameState &state, std::vector<std::uint8_t> &out);
+
+    core::GameState shadow_{};
+    bool synced_{false};
+    int keyframe_interval_;
+    int locks_since_keyframe_{0};
+};
+
+class DeltaDecoder {
+public:
+    // Applies a run of operations; returns false (and drops sync) on malformed input.
+    bool decode(const std::uint8_t *data, std::size_t size);
+
+    const core::GameState &state() const noexcept { return state_; }
+    bool synced() const noexcept { return synced_; }
+    // Events rebuilt from the decoded operations since the last call, oldest
+    // first, as core::Game would have emitted them: pieces locked, lines
+    // cleared, level changes, game over, and hard drops inferred from a lock
+    // below the piece's last decoded row.
+    core::GameEvents take_events() noexcept { return std::exchange(events_, core::GameEvents{}); }
+
+private:
+    core::GameState state_{};
+    core::GameEvents events_{};
+    bool synced_{false};
+};
+
+} // namespace cretris::stream
@@ -0,0 +1,84 @@
+#include "RollbackSession.h"
+
+#include <algorithm>
+
+namespace cretris::versus {
+
+RollbackSession::RollbackSession(std::uint64_t seed, int local_player, std::size_t max_rollback)
+    : local_player_{local_player},
+      max_rollback_{static_cast<std::uint32_t>(std::max<std::size_t>(1, max_rollback))},
+      state_{seed},
+      snapshots_(max_rollback_ + 1, state_),
+      local_inputs_(max_rollback_ + 1, core::InputAction::None),
+      remote_inputs_(2 * (max_rollback_ + 1)) {}
+
+core::InputAction RollbackSession::remote_for(std::uint32_t frame) const {
+    const auto &remote = remote_inputs_[frame % remote_inputs_.size()];
+    return remote.frame == frame ? remote.action : core::InputAction::None;
+}
+
+FrameInput RollbackSession::inputs_for(std::uint32_t frame) const {
+    FrameInput input;
+    input.actions[static_cast<std::size_t>(local_player_)] = local_inputs_[slot(frame)];
+    input.actions[static_cast<std::size_t>(1 - local_player_)] = remote_for(frame);
+    return input;
+}
+
+void RollbackSession::resimulate() {
+    if (rollback_to_ >= frame_) {
+        rollback_to_ = ~std::uint32_t{0};
+        return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    state_ = snapshots_[slot(rollback_to_)];
+    for (std::uint32_t f = rollback_to_; f < frame_; ++f) {
+        snapshots_[slot(f)] = state_;
+        step(state_, inputs_for(f));
+    }
+    auto spent = std::chrono::steady_clock::now() - start;
+
+    std::uint32_t depth = frame_ - rollback_to_;
+    ++stats_.rollbacks;
+    stats_.resimulated_frames += depth;
+    stats_.deepest_rollback = std::max(stats_.deepest_rollback, depth);
+    stats_.rollback_time += spent;
+    stats_.slowest_rollback = std::max<std::chrono::nanoseconds>(stats_.slowest_rollback, spent);
+    rollback_to_ = ~std::uint32_t{0};
+}
+
+std::uint32_t RollbackSession::advance(core::InputAction local) {
+    resimulate();
+    std::uint32_t frame = frame_;
+    local_inputs_[slot(frame)] = local;
+    snapshots_[slot(frame)] = state_;
+    step(state_, inputs_for(frame));
+    ++frame_;
+    ++stats_.frames;
+    while (confirmed_ < frame_ && remote_inputs_[confirmed_ % remote_inputs_.size()].frame == confirmed_) {
+        ++confirmed_;
+    }
+    return frame;
+}
+
+void RollbackSession::add_remote_input(std::uint32_t frame, core::InputAction action) {
+    if (frame < confirmed_ || frame >= confirmed_ + remote_inputs_.size()) {
+        return; // duplicate, or further ahead than the peer is allowed to run
+    }
+    auto &remote = remote_inputs_[frame % remote_inputs_.size()];
+    remote = RemoteInput{frame, action};
+    if (frame < frame_ && action != core::InputAction::None) {
+        rollback_to_ = std::min(rollback_to_, frame); // simulated with a None prediction
+    }
+    while (confirmed_ < frame_ && remote_inputs_[confirmed_ % remote_inputs_.size()].frame == confirmed_) {
+        ++confirmed_;
+    }
+}
+
+std::optional<std::uint64_t> RollbackSession::checksum_at(std::uint32_t frame) const {
+    if (frame > confirmed_ || rollback_to_ <= frame || frame + max_rollback_ < frame_) {
+        return std::nullopt;
+    }
+    return frame == frame_ ? checksum(state_) : checksum(snapshots_[slot(frame)]);
+}
+
+} // namespace cretris::versus
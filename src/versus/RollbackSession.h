@@ -0,0 +1,78 @@
+#pragma once
+
+#include "VersusMatch.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace cretris::versus {
+
+// One peer's view of a versus match with rollback netcode.
+//
+// Local inputs are applied immediately; the remote player's input for frames
+// not yet heard from is predicted as InputAction::None. When a late remote
+// input contradicts that prediction, the next advance() restores the snapshot
+// taken before that frame and re-simulates up to the present with the
+// corrected inputs. Snapshots are kept in a ring of max_rollback frames; the
+// session refuses to run further ahead of the last confirmed frame than that.
+class RollbackSession {
+public:
+    struct Stats {
+        std::uint64_t frames{0};
+        std::uint64_t rollbacks{0};
+        std::uint64_t resimulated_frames{0};
+        std::uint32_t deepest_rollback{0};                  // frames
+        std::chrono::nanoseconds rollback_time{0};          // restore plus re-simulation, summed
+        std::chrono::nanoseconds slowest_rollback{0};
+    };
+
+    RollbackSession(std::uint64_t seed, int local_player, std::size_t max_rollback = 30);
+
+    // False while the remote side lags so far behind that advancing would
+    // outrun the snapshot ring; the caller should wait for remote input.
+    bool can_advance() const noexcept { return frame_ - confirmed_ < max_rollback_; }
+
+    // Applies any pending rollback, then simulates the next frame with `local`
+    // as this player's input. Returns the frame number the input belongs to.
+    std::uint32_t advance(core::InputAction local);
+
+    void add_remote_input(std::uint32_t frame, core::InputAction action);
+
+    // Performs a pending rollback without simulating a new frame.
+    void resimulate();
+
+    int local_player() const noexcept { return local_player_; }
+    const MatchState &state() const noexcept { return state_; }
+    std::uint32_t frame() const noexcept { return frame_; }         // next frame to simulate
+    std::uint32_t confirmed_frame() const noexcept { return confirmed_; } // every input before it is known
+    const Stats &stats() const noexcept { return stats_; }
+
+    // Checksum of the state at the start of `frame`, if it is still in the ring and final.
+    std::optional<std::uint64_t> checksum_at(std::uint32_t frame) const;
+
+private:
+    struct RemoteInput {
+        std::uint32_t frame{~std::uint32_t{0}};
+        core::InputAction action{core::InputAction::None};
+    };
+
+    std::size_t slot(std::uint32_t frame) const noexcept { return frame % snapshots_.size(); }
+    FrameInput inputs_for(std::uint32_t frame) const;
+    core::InputAction remote_for(std::uint32_t frame) const;
+
+    int local_player_;
+    std::uint32_t max_rollback_;
+    MatchState state_;
+    std::uint32_t frame_{0};
+    std::uint32_t confirmed_{0};
+    std::uint32_t rollback_to_{~std::uint32_t{0}};
+    std::vector<MatchState> snapshots_{};          // state at the start of each recent frame
+    std::vector<core::InputAction> local_inputs_{}; // same ring as snapshots_
+    std::vector<RemoteInput> remote_inputs_{};      // twice as deep: the peer may be ahead of us
+    Stats stats_{};
+};
+
+} // namespace cretris::versus
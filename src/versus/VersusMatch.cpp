@@ -0,0 +1,87 @@
+#include "VersusMatch.h"
+
+namespace cretris::versus {
+
+namespace {
+
+constexpr std::uint64_t GARBAGE_STREAM = 0x6761726261676500ull; // keys hole columns apart from the piece bags
+
+void mix(std::uint64_t &hash, std::uint64_t value) {
+    hash = (hash ^ value) * 0x100000001B3ull;
+    hash ^= hash >> 29;
+}
+
+} // namespace
+
+MatchState::MatchState(std::uint64_t match_seed)
+    : games{core::Game{match_seed}, core::Game{match_seed}}, seed{match_seed} {}
+
+void step(MatchState &match, const FrameInput &input) {
+    for (int p = 0; p < PLAYERS; ++p) {
+        auto &game = match.games[static_cast<std::size_t>(p)];
+        if (game.state().game_over) {
+            continue;
+        }
+        auto pieces_before = game.randomizer().position();
+        int lines_before = game.state().total_lines;
+
+        game.step_frame(input.actions[static_cast<std::size_t>(p)]);
+        if (game.randomizer().position() == pieces_before) {
+            continue;
+        }
+
+        // A piece locked: clears cancel incoming garbage first and send the rest
+        // across; a lock without a clear lets the waiting garbage rise.
+        int cleared = game.state().total_lines - lines_before;
+        int attack = attack_lines(cleared);
+        auto &incoming = match.pending_garbage[static_cast<std::size_t>(p)];
+        int cancelled = std::min(attack, incoming);
+        incoming -= cancelled;
+        match.pending_garbage[static_cast<std::size_t>(1 - p)] += attack - cancelled;
+        if (cleared == 0 && incoming > 0) {
+            auto hole = core::counter_random(match.seed ^ GARBAGE_STREAM, match.garbage_events++) %
+                        static_cast<std::uint64_t>(core::BOARD_WIDTH);
+            game.add_garbage(incoming, static_cast<int>(hole));
+            incoming = 0;
+        }
+    }
+
+    if (match.winner < 0) {
+        bool over0 = match.games[0].state().game_over;
+        bool over1 = match.games[1].state().game_over;
+        if (over0 != over1) {
+            match.winner = over0 ? 1 : 0;
+        }
+    }
+    ++match.frame;
+}
+
+std::uint64_t checksum(const MatchState &match) {
+    std::uint64_t hash = 0xCBF29CE484222325ull;
+    mix(hash, match.frame);
+    mix(hash, match.garbage_events);
+    mix(hash, static_cast<std::uint64_t>(match.winner));
+    for (int p = 0; p < PLAYERS; ++p) {
+        const auto &game = match.games[static_cast<std::size_t>(p)];
+        const auto &state = game.state();
+        mix(hash, static_cast<std::uint64_t>(game.lock_frames()));
+        mix(hash, static_cast<std::uint64_t>(match.pending_garbage[static_cast<std::size_t>(p)]));
+        mix(hash, game.randomizer().position());
+        for (auto row : game.occupancy()) {
+            mix(hash, row);
+        }
+        mix(hash, static_cast<std::uint64_t>(state.active_piece.type) |
+                      static_cast<std::uint64_t>(state.active_piece.rotation) << 8 |
+                      static_cast<std::uint64_t>(static_cast<std::uint32_t>(state.active_piece.position.x)) << 16 |
+                      static_cast<std::uint64_t>(static_cast<std::uint32_t>(state.active_piece.position.y)) << 40);
+        for (auto type : state.queue) {
+            mix(hash, static_cast<std::uint64_t>(type));
+        }
+        mix(hash, static_cast<std::uint64_t>(state.score));
+        mix(hash, static_cast<std::uint64_t>(state.total_lines));
+        mix(hash, state.game_over ? 1 : 0);
+    }
+    return hash;
+}
+
+} // namespace cretris::versus
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "../core/Game.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace cretris::versus {
+
+constexpr int PLAYERS = 2;
+constexpr std::chrono::microseconds FRAME_DURATION{1000000 / core::StandardRules::frame_rate};
+
+struct FrameInput {
+    std::array<core::InputAction, PLAYERS> actions{core::InputAction::None, core::InputAction::None};
+};
+
+// Everything a versus match needs to advance one frame. Trivially copyable,
+// so a rollback snapshot is a plain copy.
+struct MatchState {
+    explicit MatchState(std::uint64_t seed);
+
+    std::array<core::Game, PLAYERS> games; // driven by Game::step_frame, gravity and lock delay included
+    std::array<std::int32_t, PLAYERS> pending_garbage{}; // lines waiting to rise under each player
+    std::uint64_t seed;
+    std::uint32_t frame{0};
+    std::uint32_t garbage_events{0};
+    std::int32_t winner{-1};
+};
+
+static_assert(std::is_trivially_copyable_v<MatchState>, "rollback snapshots copy matches as plain bytes");
+
+// Lines sent for clearing 0-4 lines at once.
+constexpr int attack_lines(int cleared) {
+    constexpr std::array<int, 5> table = {0, 0, 1, 2, 4};
+    return cleared >= 0 && cleared < static_cast<int>(table.size()) ? table[static_cast<std::size_t>(cleared)] : 4;
+}
+
+// Advances the match by one frame. Deterministic: the same state and inputs
+// give the same result on every peer.
+void step(MatchState &match, const FrameInput &input);
+
+// Hash over the game-visible fields (not raw bytes, which include padding).
+std::uint64_t checksum(const MatchState &match);
+
+} // namespace cretris::versus
@@ -0,0 +1,207 @@
+// Self-play training data utility.
+//
+//   cretris-dataset generate DIR [--games N] [--threads N] [--seed S]
+//                   [--policy planner|placement|inputs] [--epsilon E]
+//                   [--max-pieces N] [--segment-records N]
+//       plays games and writes their positions as columnar segment files
+//   cretris-dataset stats PATH...
+//       maps segment files (or every segment in a directory) and summarises them
+//   cretris-dataset write-bench DIR [--records N] [--threads N]
+//       writer bandwidth alone: synthetic records, no games
+
+#include "dataset/Dataset.h"
+#include "dataset/Generator.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace cretris;
+using clock_type = std::chrono::steady_clock;
+
+double seconds_since(clock_type::time_point start) {
+    return std::chrono::duration<double>(clock_type::now() - start).count();
+}
+
+std::vector<std::string> segment_files(const std::vector<std::string> &paths) {
+    std::vector<std::string> files;
+    for (const auto &path : paths) {
+        if (!std::filesystem::is_directory(path)) {
+            files.push_back(path);
+            continue;
+        }
+        for (const auto &entry : std::filesystem::directory_iterator{path}) {
+            if (entry.path().extension() == ".crtd") {
+                files.push_back(entry.path().string());
+            }
+        }
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+int stats(const std::vector<std::string> &paths) {
+    std::uint64_t records = 0;
+    std::uint64_t games = 0;
+    std::uint64_t topped_out = 0;
+    std::uint64_t inconsistent = 0;
+    double final_score_sum = 0.0;
+    std::array<std::uint64_t, 5> lines{};
+    auto start = clock_type::now();
+    for (const auto &path : segment_files(paths)) {
+        dataset::SegmentReader reader;
+        if (!reader.open(path)) {
+            std::cerr << "Cannot open segment " << path << "\n";
+            return 1;
+        }
+        auto boards = reader.boards();
+        for (std::size_t i = 0; i < reader.size(); ++i) {
+            auto record = reader.record(i);
+            ++records;
+            // Locking the recorded pose must reproduce the next position of the game.
+            auto pose = core::Tetromino{record.piece, static_cast<core::Rotation>(record.placement.rotation),
+                                        {record.placement.x, record.placement.y}};
+            ai::Bitboard after = record.board;
+            if (!ai::fits(after, pose) || ai::lock(after, pose) != record.placement.lines ||
+                (record.pieces_left > 0 && after != boards[i + 1])) {
+                ++inconsistent;
+            }
+            lines[std::min<std::size_t>(record.placement.lines, lines.size() - 1)]++;
+            if (record.pieces_left == 0) {
+                // Last record of a game: its outcome is the game's.
+                ++games;
+                topped_out += record.topped_out ? 1 : 0;
+                final_score_sum += record.final_score;
+            }
+            inconsistent += record.score > record.final_score ? 1 : 0;
+        }
+    }
+    double elapsed = seconds_since(start);
+    std::printf("%llu records from %llu games in %.2fs (%.1f M records/sec)\n",
+                static_cast<unsigned long long>(records), static_cast<unsigned long long>(games), elapsed,
+                static_cast<double>(records) / std::max(elapsed, 1e-9) / 1e6);
+    std::printf("mean final score %.1f, %.1f%% topped out, %llu inconsistent records\n",
+                games ? final_score_sum / static_cast<double>(games) : 0.0,
+                games ? 100.0 * static_cast<double>(topped_out) / static_cast<double>(games) : 0.0,
+                static_cast<unsigned long long>(inconsistent));
+    std::printf("placements clearing 0/1/2/3/4 lines: %llu %llu %llu %llu %llu\n",
+                static_cast<unsigned long long>(lines[0]), static_cast<unsigned long long>(lines[1]),
+                static_cast<unsigned long long>(lines[2]), static_cast<unsigned long long>(lines[3]),
+                static_cast<unsigned long long>(lines[4]));
+    return inconsistent == 0 ? 0 : 1;
+}
+
+int write_bench(const std::string &directory, std::uint64_t records, std::size_t threads) {
+    constexpr std::size_t SEGMENT = 1u << 20;
+    constexpr int GAME = 500;
+    std::filesystem::create_directories(directory);
+    auto start = clock_type::now();
+    std::vector<std::thread> workers;
+    for (std::size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            core::Game game{t + 1};
+            dataset::Position position = dataset::Position::capture(game);
+            core::Tetromino pose = game.state().active_piece;
+            dataset::SegmentWriter writer;
+            std::size_t segment = 0;
+            for (std::uint64_t written = t; written < records; written += threads * GAME) {
+                if (writer.free_records() < GAME) {
+                    char name[32];
+                    std::snprintf(name, sizeof(name), "bench-%03zu-%05zu.crtd", t, segment++);
+                    writer.close();
+                    writer.open((std::filesystem::path{directory} / name).string(), SEGMENT);
+                }
+                writer.begin_game(written);
+                for (int i = 0; i < GAME; ++i) {
+                    position.board[static_cast<std::size_t>(i % core::BOARD_HEIGHT)] ^= static_cast<std::uint16_t>(i);
+                    writer.add(position, pose, i & 3);
+                }
+                writer.end_game(0, true);
+            }
+            writer.close();
+        });
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    double elapsed = seconds_since(start);
+    double bytes = static_cast<double>(records) * static_cast<double>(dataset::record_bytes());
+    std::printf("wrote %.0f MB with %zu thread(s) in %.2fs: %.0f MB/s, %.1f M records/sec\n", bytes / 1e6, threads,
+                elapsed, bytes / elapsed / 1e6, static_cast<double>(records) / elapsed / 1e6);
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::vector<std::string> positional;
+    dataset::GeneratorConfig config;
+    config.threads = std::max(1u, std::thread::hardware_concurrency());
+    std::uint64_t bench_records = 20'000'000;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string { return i + 1 < argc ? argv[++i] : "0"; };
+        if (arg == "--games") {
+            config.games = std::stoull(next());
+        } else if (arg == "--threads") {
+            config.threads = std::max<std::size_t>(1, std::stoul(next()));
+        } else if (arg == "--seed") {
+            config.seed = std::stoull(next());
+        } else if (arg == "--policy") {
+            std::string policy = next();
+            config.policy = policy == "inputs"      ? dataset::Policy::RandomInputs
+                            : policy == "placement" ? dataset::Policy::RandomPlacement
+                                                    : dataset::Policy::Planner;
+        } else if (arg == "--epsilon") {
+            config.epsilon = std::stod(next());
+        } else if (arg == "--max-pieces") {
+            config.max_pieces = std::max(1, std::stoi(next()));
+        } else if (arg == "--segment-records") {
+            config.segment_records = std::stoul(next());
+        } else if (arg == "--records") {
+            bench_records = std::stoull(next());
+        } else {
+            positional.push_back(arg);
+        }
+    }
+    if (positional.size() < 2) {
+        std::cout << "Usage: " << argv[0]
+                  << " generate DIR [--games N] [--threads N] [--seed S] [--policy planner|placement|inputs]\n"
+                  << "                [--epsilon E] [--max-pieces N] [--segment-records N]\n"
+                  << "       " << argv[0] << " stats PATH...\n"
+                  << "       " << argv[0] << " write-bench DIR [--records N] [--threads N]\n";
+        return 1;
+    }
+
+    const std::string &command = positional[0];
+    if (command == "generate") {
+        config.directory = positional[1];
+        auto stats = dataset::generate(config);
+        double elapsed = std::chrono::duration<double>(stats.elapsed).count();
+        std::printf("%llu games, %llu records in %zu segment(s) in %.2fs: %.0f records/sec, %.1f MB/s\n",
+                    static_cast<unsigned long long>(stats.games), static_cast<unsigned long long>(stats.records),
+                    stats.segments, elapsed, static_cast<double>(stats.records) / elapsed,
+                    static_cast<double>(stats.bytes) / elapsed / 1e6);
+        if (!stats.ok) {
+            std::cerr << "Failed to write segments under " << config.directory << "\n";
+            return 1;
+        }
+        return 0;
+    }
+    if (command == "stats") {
+        return stats({positional.begin() + 1, positional.end()});
+    }
+    if (command == "write-bench") {
+        return write_bench(positional[1], bench_records, config.threads);
+    }
+    std::cerr << "Unknown command " << command << "\n";
+    return 1;
+}
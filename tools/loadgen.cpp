@@ -0,0 +1,237 @@
+// Load generator for `cretris --server`: opens many client sessions over the
+// Unix socket, feeds them random inputs and reports update throughput plus the
+// spread of gaps between consecutive state updates.
+
+#include "server/Protocol.h"
+#include "stream/DeltaStream.h"
+
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+struct Options {
+    std::string socket_path{"/tmp/cretris.sock"};
+    std::size_t clients{1000};
+    std::size_t threads{2};
+    double duration_s{10.0};
+    double actions_per_second{2.0}; // per client; 0 leaves only gravity updates
+};
+
+struct Client {
+    int fd{-1};
+    std::vector<std::uint8_t> inbox{};
+    cretris::stream::DeltaDecoder decoder{};
+    clock_type::time_point last_update{};
+    clock_type::time_point next_action{};
+    bool seen_update{false};
+};
+
+struct ThreadResult {
+    std::uint64_t updates{0};
+    std::uint64_t actions{0};
+    std::uint64_t bytes{0};
+    std::uint64_t connected{0};
+    std::uint64_t decode_errors{0};
+    std::vector<std::uint32_t> gaps_us{};
+};
+
+int connect_client(const std::string &path) {
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    if (::connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+    return fd;
+}
+
+void consume_frames(Client &client, ThreadResult &result, clock_type::time_point now) {
+    std::size_t offset = 0;
+    while (true) {
+        cretris::server::FrameView frame;
+        std::size_t consumed =
+            cretris::server::parse_frame(client.inbox.data() + offset, client.inbox.size() - offset, frame);
+        if (consumed == 0) {
+            break;
+        }
+        if (frame.type != cretris::server::MessageType::Delta || !client.decoder.decode(frame.payload, frame.size)) {
+            ++result.decode_errors;
+        }
+        if (client.seen_update) {
+            auto gap = std::chrono::duration_cast<std::chrono::microseconds>(now - client.last_update).count();
+            result.gaps_us.push_back(static_cast<std::uint32_t>(gap));
+        }
+        client.seen_update = true;
+        client.last_update = now;
+        ++result.updates;
+        offset += consumed;
+    }
+    client.inbox.erase(client.inbox.begin(), client.inbox.begin() + static_cast<std::ptrdiff_t>(offset));
+}
+
+void run_clients(const Options &options, std::size_t count, unsigned seed, const std::atomic<bool> &stop,
+                 ThreadResult &result) {
+    std::mt19937 rng{seed};
+    std::uniform_int_distribution<int> action_dist(static_cast<int>(cretris::core::InputAction::MoveLeft),
+                                                   static_cast<int>(cretris::core::InputAction::RotateCCW));
+    std::exponential_distribution<double> interval_dist(options.actions_per_second > 0.0 ? options.actions_per_second
+                                                                                        : 1.0);
+
+    int epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+    std::vector<Client> clients(count);
+    auto start = clock_type::now();
+    for (std::size_t i = 0; i < count; ++i) {
+        clients[i].fd = connect_client(options.socket_path);
+        if (clients[i].fd < 0) {
+            continue;
+        }
+        ++result.connected;
+        clients[i].next_action = start + std::chrono::duration_cast<clock_type::duration>(
+                                             std::chrono::duration<double>(interval_dist(rng)));
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = i;
+        ::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, clients[i].fd, &event);
+    }
+
+    std::vector<epoll_event> events(256);
+    std::vector<std::uint8_t> buffer(64 * 1024);
+    while (!stop.load(std::memory_order_relaxed)) {
+        int ready = ::epoll_wait(epoll_fd, events.data(), static_cast<int>(events.size()), 1);
+        auto now = clock_type::now();
+        for (int i = 0; i < ready; ++i) {
+            auto &client = clients[events[static_cast<std::size_t>(i)].data.u64];
+            while (true) {
+                ssize_t received = ::recv(client.fd, buffer.data(), buffer.size(), 0);
+                if (received <= 0) {
+                    if (received == 0) {
+                        ::epoll_ctl(epoll_fd, EPOLL_CTL_DEL, client.fd, nullptr);
+                        ::close(client.fd);
+                        client.fd = -1;
+                    }
+                    break;
+                }
+                result.bytes += static_cast<std::uint64_t>(received);
+                client.inbox.insert(client.inbox.end(), buffer.begin(), buffer.begin() + received);
+            }
+            consume_frames(client, result, now);
+        }
+
+        if (options.actions_per_second <= 0.0) {
+            continue;
+        }
+        for (auto &client : clients) {
+            if (client.fd < 0 || now < client.next_action) {
+                continue;
+            }
+            auto action = static_cast<std::uint8_t>(action_dist(rng));
+            if (::send(client.fd, &action, 1, MSG_NOSIGNAL) == 1) {
+                ++result.actions;
+            }
+            client.next_action = now + std::chrono::duration_cast<clock_type::duration>(
+                                           std::chrono::duration<double>(interval_dist(rng)));
+        }
+    }
+
+    for (auto &client : clients) {
+        if (client.fd >= 0) {
+            ::close(client.fd);
+        }
+    }
+    ::close(epoll_fd);
+}
+
+std::uint32_t percentile(std::vector<std::uint32_t> &values, double fraction) {
+    if (values.empty()) {
+        return 0;
+    }
+    auto index = static_cast<std::size_t>(fraction * static_cast<double>(values.size() - 1));
+    std::nth_element(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(index), values.end());
+    return values[index];
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string { return i + 1 < argc ? argv[++i] : ""; };
+        if (arg == "--socket") {
+            options.socket_path = next();
+        } else if (arg == "--clients") {
+            options.clients = std::stoul(next());
+        } else if (arg == "--threads") {
+            options.threads = std::max<std::size_t>(1, std::stoul(next()));
+        } else if (arg == "--duration") {
+            options.duration_s = std::stod(next());
+        } else if (arg == "--rate") {
+            options.actions_per_second = std::stod(next());
+        } else {
+            std::cout << "Usage: " << argv[0]
+                      << " [--socket PATH] [--clients N] [--threads N] [--duration SECONDS] [--rate ACTIONS_PER_SEC]\n";
+            return arg == "--help" || arg == "-h" ? 0 : 1;
+        }
+    }
+
+    std::atomic<bool> stop{false};
+    std::vector<ThreadResult> results(options.threads);
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < options.threads; ++t) {
+        std::size_t share = options.clients / options.threads + (t < options.clients % options.threads ? 1 : 0);
+        threads.emplace_back(run_clients, std::cref(options), share, static_cast<unsigned>(t + 1), std::cref(stop),
+                             std::ref(results[t]));
+    }
+
+    auto start = clock_type::now();
+    std::this_thread::sleep_for(std::chrono::duration<double>(options.duration_s));
+    stop.store(true);
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    double elapsed = std::chrono::duration<double>(clock_type::now() - start).count();
+
+    ThreadResult total;
+    for (auto &result : results) {
+        total.updates += result.updates;
+        total.actions += result.actions;
+        total.bytes += result.bytes;
+        total.connected += result.connected;
+        total.decode_errors += result.decode_errors;
+        total.gaps_us.insert(total.gaps_us.end(), result.gaps_us.begin(), result.gaps_us.end());
+    }
+
+    std::printf("sessions connected : %llu / %zu\n", static_cast<unsigned long long>(total.connected), options.clients);
+    std::printf("updates/sec        : %.0f\n", static_cast<double>(total.updates) / elapsed);
+    std::printf("actions/sec        : %.0f\n", static_cast<double>(total.actions) / elapsed);
+    std::printf("MiB/sec received   : %.2f\n", static_cast<double>(total.bytes) / elapsed / (1024.0 * 1024.0));
+    std::printf("bytes/update       : %.1f\n",
+                total.updates > 0 ? static_cast<double>(total.bytes) / static_cast<double>(total.updates) : 0.0);
+    std::printf("decode errors      : %llu\n", static_cast<unsigned long long>(total.decode_errors));
+    std::printf("update gap us      : p50 %u  p99 %u  max %u\n", percentile(total.gaps_us, 0.5),
+                percentile(total.gaps_us, 0.99), percentile(total.gaps_us, 1.0));
+    return total.decode_errors == 0 ? 0 : 1;
+}
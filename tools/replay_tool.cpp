@@ -0,0 +1,311 @@
+// Replay archive utility.
+//
+//   cretris-replay generate ARCHIVE [--games N] [--pieces N] [--seed S] [--threads N]
+//       records bot games (the greedy planner, with a gravity tick before every piece)
+//   cretris-replay verify ARCHIVE [--threads N]
+//       re-simulates every replay in parallel and flags score, line or keyframe mismatches
+//   cretris-replay seek ARCHIVE REPLAY EVENT
+//       jumps to an event through the nearest keyframe and prints the state there; REPLAY is
+//       an index or the ID@OFFSET that cretris-results prints
+//   cretris-replay thumbnails ARCHIVE OUTDIR [--cell PX] [--frames N] [--ppm] [--threads N]
+//       renders each replay's final state headlessly to OUTDIR/replay-NNNNNN.png (or .ppm);
+//       with --frames, also an animated PNG of N evenly spaced states, replay-NNNNNN-preview.png
+
+#include "ai/Planner.h"
+#include "render/Image.h"
+#include "render/StateRenderer.h"
+#include "replay/ReplayArchive.h"
+#include "runtime/ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace cretris;
+using clock_type = std::chrono::steady_clock;
+
+struct Options {
+    std::string command{};
+    std::string archive{};
+    std::vector<std::string> positional{};
+    std::size_t games{256};
+    int pieces{500};
+    std::uint64_t seed{1};
+    std::size_t threads{std::max(1u, std::thread::hardware_concurrency())};
+    int cell{8};
+    std::size_t frames{0};
+    bool ppm{false};
+};
+
+constexpr int PREVIEW_FRAME_MS = 200;
+
+int usage(const char *program) {
+    std::cout << "Usage: " << program << " generate ARCHIVE [--games N] [--pieces N] [--seed S] [--threads N]\n"
+              << "       " << program << " verify ARCHIVE [--threads N]\n"
+              << "       " << program << " seek ARCHIVE REPLAY EVENT\n"
+              << "       " << program << " thumbnails ARCHIVE OUTDIR [--cell PX] [--frames N] [--ppm] [--threads N]\n";
+    return 1;
+}
+
+double seconds_since(clock_type::time_point start) {
+    return std::chrono::duration<double>(clock_type::now() - start).count();
+}
+
+replay::Replay record_bot_game(std::uint64_t seed, int pieces, ai::Planner &planner) {
+    core::Game game{seed};
+    replay::ReplayRecorder recorder{seed};
+    for (int piece = 0; piece < pieces && !game.state().game_over; ++piece) {
+        game.tick();
+        recorder.record_tick(game);
+        for (auto action : planner.plan(game)) {
+            game.apply_action(action);
+            recorder.record_action(action, game);
+        }
+    }
+    return recorder.take();
+}
+
+int generate(const Options &options) {
+    std::vector<replay::Replay> replays(options.games);
+    auto start = clock_type::now();
+    runtime::ThreadPool pool{options.threads - 1};
+    pool.parallel_for(options.games, [&](std::size_t begin, std::size_t end) {
+        ai::Planner::Options planner_options;
+        planner_options.look_ahead = false;
+        ai::Planner planner{planner_options};
+        for (std::size_t i = begin; i < end; ++i) {
+            replays[i] = record_bot_game(core::counter_random(options.seed, i), options.pieces, planner);
+        }
+    });
+
+    replay::ArchiveWriter writer;
+    std::remove(options.archive.c_str()); // a fresh corpus, not appended to the last one
+    if (!writer.open(options.archive)) {
+        std::cerr << "Cannot write " << options.archive << "\n";
+        return 1;
+    }
+    std::size_t events = 0;
+    for (const auto &recorded : replays) {
+        writer.add(recorded);
+        events += recorded.inputs.size();
+    }
+    if (!writer.finish()) {
+        std::cerr << "Failed writing " << options.archive << "\n";
+        return 1;
+    }
+    std::printf("recorded %zu replays, %zu events in %.2fs\n", replays.size(), events, seconds_since(start));
+    return 0;
+}
+
+int verify(const Options &options) {
+    replay::ArchiveReader reader;
+    if (!reader.open(options.archive)) {
+        std::cerr << "Cannot open archive " << options.archive << "\n";
+        return 1;
+    }
+
+    std::atomic<std::size_t> mismatches{0};
+    std::atomic<std::size_t> events{0};
+    auto start = clock_type::now();
+    runtime::ThreadPool pool{options.threads - 1};
+    pool.parallel_for(reader.size(), [&](std::size_t begin, std::size_t end) {
+        std::size_t local_events = 0;
+        for (std::size_t i = begin; i < end; ++i) {
+            const auto &view = reader.replay(i);
+            auto result = replay::verify(view);
+            local_events += view.input_count;
+            if (!result.ok) {
+                ++mismatches;
+                std::printf("replay %zu (seed %llu): score %d/%d lines %d/%d, %zu bad keyframes\n", i,
+                            static_cast<unsigned long long>(view.seed), result.score, view.final_score, result.lines,
+                            view.final_lines, result.bad_keyframes);
+            }
+        }
+        events += local_events;
+    });
+    double elapsed = seconds_since(start);
+    std::printf("verified %zu replays, %zu events in %.3fs (%.1f M events/sec, %zu threads): %zu mismatches\n",
+                reader.size(), events.load(), elapsed, static_cast<double>(events.load()) / elapsed / 1e6,
+                options.threads, mismatches.load());
+    return mismatches == 0 ? 0 : 1;
+}
+
+int seek(const Options &options) {
+    replay::ArchiveReader reader;
+    if (options.positional.size() != 2 || !reader.open(options.archive)) {
+        std::cerr << "Cannot open archive " << options.archive << "\n";
+        return 1;
+    }
+    const std::string &replay = options.positional[0];
+    std::size_t event = std::stoul(options.positional[1]);
+    std::size_t index = 0;
+    if (auto at = replay.find('@'); at != std::string::npos) {
+        if (at > 0 && std::stoul(replay.substr(0, at), nullptr, 16) != reader.id()) {
+            std::fprintf(stderr, "%s is archive %08x, not %s\n", options.archive.c_str(), reader.id(),
+                         replay.substr(0, at).c_str());
+            return 1;
+        }
+        auto found = reader.find(std::stoull(replay.substr(at + 1)));
+        if (!found) {
+            std::cerr << "No replay starts at offset " << replay.substr(at + 1) << "\n";
+            return 1;
+        }
+        index = *found;
+    } else {
+        index = std::stoul(replay);
+    }
+    if (index >= reader.size()) {
+        std::cerr << "Archive holds " << reader.size() << " replays\n";
+        return 1;
+    }
+
+    replay::ReplayPlayer player{reader.replay(index)};
+    auto start = clock_type::now();
+    if (!player.seek(event)) {
+        std::cerr << "Corrupt keyframe before event " << event << "\n";
+        return 1;
+    }
+    double elapsed = seconds_since(start);
+    const auto &state = player.game().state();
+    std::printf("replay %zu event %zu/%zu: score %d lines %d level %d%s (seek %.1f us)\n", index, player.position(),
+                reader.replay(index).input_count, state.score, state.total_lines, state.level,
+                state.game_over ? " game over" : "", elapsed * 1e6);
+    return 0;
+}
+
+// One StateRenderer is shared by every worker; each worker owns its
+// framebuffers and reuses them from replay to replay.
+int thumbnails(const Options &options) {
+    replay::ArchiveReader reader;
+    if (options.positional.size() != 1 || !reader.open(options.archive)) {
+        std::cerr << "Cannot open archive " << options.archive << "\n";
+        return 1;
+    }
+    const std::string &directory = options.positional[0];
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error) {
+        std::cerr << "Cannot create " << directory << ": " << error.message() << "\n";
+        return 1;
+    }
+
+    const render::StateRenderer renderer{options.cell};
+    const std::size_t frame_count = std::max<std::size_t>(options.frames, 1);
+    std::atomic<std::size_t> failures{0};
+    std::atomic<std::size_t> bytes{0};
+    auto start = clock_type::now();
+    runtime::ThreadPool pool{options.threads - 1};
+    pool.parallel_for(reader.size(), [&](std::size_t begin, std::size_t end) {
+        std::vector<render::Framebuffer> frames(frame_count, renderer.make_framebuffer());
+        std::size_t local_bytes = 0;
+        auto write = [&](const std::string &path, const std::vector<std::uint8_t> &data) {
+            if (data.empty() || !render::write_file(path, data)) {
+                ++failures;
+                std::fprintf(stderr, "Failed writing %s\n", path.c_str());
+                return;
+            }
+            local_bytes += data.size();
+        };
+
+        for (std::size_t i = begin; i < end; ++i) {
+            const auto &view = reader.replay(i);
+            replay::ReplayPlayer player{view};
+            if (options.frames > 1) {
+                // Evenly spaced events from the first state to the last, so the final frame is the thumbnail.
+                for (std::size_t f = 0; f < frame_count; ++f) {
+                    std::size_t target = view.input_count * f / (frame_count - 1);
+                    while (player.position() < target && player.step()) {
+                    }
+                    renderer.draw(player.game().state(), frames[f]);
+                }
+            } else if (player.seek(view.input_count)) {
+                renderer.draw(player.game().state(), frames.back());
+            } else {
+                ++failures;
+                std::fprintf(stderr, "replay %zu: corrupt keyframe\n", i);
+                continue;
+            }
+
+            char name[32];
+            std::snprintf(name, sizeof(name), "replay-%06zu", i);
+            const std::string stem = (std::filesystem::path{directory} / name).string();
+            if (options.ppm) {
+                write(stem + ".ppm", render::encode_ppm(frames.back()));
+            } else {
+                write(stem + ".png", render::encode_png(frames.back()));
+            }
+            if (options.frames > 1) {
+                write(stem + "-preview.png", render::encode_apng(frames, PREVIEW_FRAME_MS));
+            }
+        }
+        bytes += local_bytes;
+    });
+    double elapsed = seconds_since(start);
+    std::printf("rendered %zu replays at %dx%d", reader.size(), renderer.width(), renderer.height());
+    if (options.frames > 1) {
+        std::printf(" with %zu-frame previews", frame_count);
+    }
+    std::printf(" in %.3fs (%.0f replays/min, %.1f MB, %zu threads): %zu failures\n", elapsed,
+                static_cast<double>(reader.size()) / elapsed * 60.0, static_cast<double>(bytes.load()) / 1e6,
+                options.threads, failures.load());
+    return failures == 0 ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string { return i + 1 < argc ? argv[++i] : ""; };
+        if (arg == "--games") {
+            options.games = std::stoul(next());
+        } else if (arg == "--pieces") {
+            options.pieces = std::stoi(next());
+        } else if (arg == "--seed") {
+            options.seed = std::stoull(next());
+        } else if (arg == "--threads") {
+            options.threads = std::max<std::size_t>(1, std::stoul(next()));
+        } else if (arg == "--cell") {
+            options.cell = std::stoi(next());
+        } else if (arg == "--frames") {
+            options.frames = std::stoul(next());
+        } else if (arg == "--ppm") {
+            options.ppm = true;
+        } else if (arg == "--help" || arg == "-h") {
+            usage(argv[0]);
+            return 0;
+        } else if (options.command.empty()) {
+            options.command = arg;
+        } else if (options.archive.empty()) {
+            options.archive = arg;
+        } else {
+            options.positional.push_back(arg);
+        }
+    }
+
+    if (options.archive.empty()) {
+        return usage(argv[0]);
+    }
+    if (options.command == "generate") {
+        return generate(options);
+    }
+    if (options.command == "verify") {
+        return verify(options);
+    }
+    if (options.command == "seek") {
+        return seek(options);
+    }
+    if (options.command == "thumbnails") {
+        return thumbnails(options);
+    }
+    return usage(argv[0]);
+}
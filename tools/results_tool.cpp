@@ -0,0 +1,149 @@
+// Results store utility.
+//
+//   cretris-results top STORE [K]
+//   cretris-results seed STORE SEED
+//   cretris-results simulate STORE [--games N] [--threads N] [--seed S]
+//       plays random-input games on the thread pool and appends every result,
+//       reporting games/sec and the cost of the appends alone
+
+#include "core/Game.h"
+#include "runtime/ThreadPool.h"
+#include "store/ResultsStore.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace cretris;
+using clock_type = std::chrono::steady_clock;
+
+double seconds_since(clock_type::time_point start) {
+    return std::chrono::duration<double>(clock_type::now() - start).count();
+}
+
+void print_records(const std::vector<store::ResultRecord> &records) {
+    std::printf("%4s %10s %6s %5s %10s %20s  %s\n", "#", "score", "lines", "level", "seconds", "seed", "replay");
+    for (std::size_t i = 0; i < records.size(); ++i) {
+        const auto &record = records[i];
+        char replay[32] = "-";
+        if (record.replay_offset != store::NO_REPLAY) {
+            std::snprintf(replay, sizeof(replay), "%08x@%llu", record.replay_archive,
+                          static_cast<unsigned long long>(record.replay_offset));
+        }
+        std::printf("%4zu %10d %6d %5d %10.1f %20llu  %s\n", i + 1, record.score, record.lines, record.level,
+                    record.duration_ms / 1000.0, static_cast<unsigned long long>(record.seed), replay);
+    }
+}
+
+// Random inputs with a gravity tick every fourth step, until the stack tops out.
+store::ResultRecord play_random_game(std::uint64_t seed) {
+    core::Game game{seed};
+    std::uint64_t step = 0;
+    while (!game.state().game_over) {
+        std::uint64_t draw = core::counter_random(seed, step++);
+        if (step % 4 == 0) {
+            game.tick();
+        } else {
+            game.apply_action(static_cast<core::InputAction>(draw % static_cast<std::uint64_t>(core::InputAction::Quit)));
+        }
+    }
+    store::ResultRecord record;
+    record.seed = seed;
+    record.score = game.state().score;
+    record.lines = game.state().total_lines;
+    record.level = game.state().level;
+    record.duration_ms = static_cast<std::uint32_t>(step / 4 * 500);
+    return record;
+}
+
+int simulate(store::ResultsStore &results, std::size_t games, std::size_t threads, std::uint64_t seed) {
+    constexpr std::size_t BATCH = 256;
+    runtime::ThreadPool pool{threads - 1};
+    std::atomic<std::uint64_t> append_ns{0};
+    auto start = clock_type::now();
+    std::size_t before = results.size();
+    pool.parallel_for(games, [&](std::size_t begin, std::size_t end) {
+        std::vector<store::ResultRecord> batch;
+        batch.reserve(BATCH);
+        double spent = 0.0;
+        auto now_ms = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                                     std::chrono::system_clock::now().time_since_epoch())
+                                                     .count());
+        for (std::size_t i = begin; i < end; ++i) {
+            batch.push_back(play_random_game(core::counter_random(seed, i)));
+            batch.back().finished_at_ms = now_ms;
+            if (batch.size() == BATCH || i + 1 == end) {
+                auto append_start = clock_type::now();
+                results.append(batch.data(), batch.size());
+                spent += seconds_since(append_start);
+                batch.clear();
+            }
+        }
+        append_ns += static_cast<std::uint64_t>(spent * 1e9);
+    });
+    double elapsed = seconds_since(start);
+    std::size_t added = results.size() - before;
+    results.flush_async();
+    std::printf("simulated %zu games in %.2fs: %.0f games/sec, appends %.0f ns/record\n", added, elapsed,
+                static_cast<double>(added) / elapsed, added > 0 ? static_cast<double>(append_ns.load()) / static_cast<double>(added) : 0.0);
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::vector<std::string> positional;
+    std::size_t games = 100000;
+    std::size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    std::uint64_t seed = 1;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string { return i + 1 < argc ? argv[++i] : ""; };
+        if (arg == "--games") {
+            games = std::stoul(next());
+        } else if (arg == "--threads") {
+            threads = std::max<std::size_t>(1, std::stoul(next()));
+        } else if (arg == "--seed") {
+            seed = std::stoull(next());
+        } else {
+            positional.push_back(arg);
+        }
+    }
+    if (positional.size() < 2) {
+        std::cout << "Usage: " << argv[0] << " top STORE [K]\n"
+                  << "       " << argv[0] << " seed STORE SEED\n"
+                  << "       " << argv[0] << " simulate STORE [--games N] [--threads N] [--seed S]\n";
+        return 1;
+    }
+
+    store::ResultsStore results;
+    auto start = clock_type::now();
+    if (!results.open(positional[1])) {
+        std::cerr << "Cannot open results store " << positional[1] << "\n";
+        return 1;
+    }
+    std::printf("%zu games indexed in %.1f ms (%zu corrupt)\n", results.size(), seconds_since(start) * 1e3,
+                results.corrupt_records());
+
+    const std::string &command = positional[0];
+    if (command == "top") {
+        print_records(results.top(positional.size() > 2 ? std::stoul(positional[2]) : 10));
+        return 0;
+    }
+    if (command == "seed" && positional.size() > 2) {
+        print_records(results.by_seed(std::stoull(positional[2])));
+        return 0;
+    }
+    if (command == "simulate") {
+        return simulate(results, games, threads, seed);
+    }
+    std::cerr << "Unknown command " << command << "\n";
+    return 1;
+}
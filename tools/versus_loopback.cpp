@@ -0,0 +1,206 @@
+// Loopback harness for rollback versus: two peers on threads, linked by a Unix
+// socketpair, each delaying what it sends by --delay-ms (plus up to --jitter-ms).
+// Both players are planner bots. At the end the peers' checksums at their last
+// common confirmed frame are compared with each other and with a clean
+// re-simulation of the full input log, and rollback costs are reported.
+
+#include "ai/Planner.h"
+#include "versus/RollbackSession.h"
+
+#include <sys/socket.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace cretris;
+using clock_type = std::chrono::steady_clock;
+
+constexpr std::size_t MESSAGE_SIZE = 5; // u32 frame, u8 action
+
+struct Options {
+    double seconds{10.0};
+    int delay_ms{60};
+    int jitter_ms{10};
+    int frames_per_action{4}; // bots act at most every n frames
+    std::size_t max_rollback{30};
+    std::uint64_t seed{1};
+};
+
+struct Peer {
+    Peer(std::uint64_t seed, int player, std::size_t max_rollback) : session{seed, player, max_rollback} {}
+
+    versus::RollbackSession session;
+    std::vector<core::InputAction> inputs{}; // every local input, by frame
+    std::uint64_t stalled_frames{0};
+};
+
+void run_peer(Peer &peer, int fd, const Options &options, const std::atomic<bool> &stop) {
+    struct Outgoing {
+        clock_type::time_point due;
+        std::uint8_t bytes[MESSAGE_SIZE];
+    };
+    std::deque<Outgoing> outbox;
+    std::vector<std::uint8_t> inbox;
+    std::mt19937 rng{static_cast<unsigned>(options.seed * 2 + static_cast<unsigned>(peer.session.local_player()))};
+    std::uniform_int_distribution<int> jitter(0, std::max(0, options.jitter_ms));
+
+    ai::Planner::Options planner_options;
+    planner_options.look_ahead = false;
+    ai::Planner planner{planner_options};
+    std::vector<core::InputAction> plan;
+    std::uint64_t planned_piece = ~std::uint64_t{0};
+
+    auto next_frame = clock_type::now();
+    while (!stop.load(std::memory_order_relaxed)) {
+        auto now = clock_type::now();
+
+        std::uint8_t buffer[4096];
+        ssize_t received;
+        while ((received = ::recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT)) > 0) {
+            inbox.insert(inbox.end(), buffer, buffer + received);
+        }
+        std::size_t offset = 0;
+        for (; offset + MESSAGE_SIZE <= inbox.size(); offset += MESSAGE_SIZE) {
+            const std::uint8_t *m = inbox.data() + offset;
+            std::uint32_t frame = static_cast<std::uint32_t>(m[0]) | static_cast<std::uint32_t>(m[1]) << 8 |
+                                  static_cast<std::uint32_t>(m[2]) << 16 | static_cast<std::uint32_t>(m[3]) << 24;
+            peer.session.add_remote_input(frame, static_cast<core::InputAction>(m[4]));
+        }
+        inbox.erase(inbox.begin(), inbox.begin() + static_cast<std::ptrdiff_t>(offset));
+
+        // Later messages never overtake earlier ones, as on a real ordered link.
+        while (!outbox.empty() && outbox.front().due <= now) {
+            ::send(fd, outbox.front().bytes, MESSAGE_SIZE, MSG_NOSIGNAL);
+            outbox.pop_front();
+        }
+
+        if (now < next_frame) {
+            std::this_thread::sleep_for(std::min<clock_type::duration>(next_frame - now, std::chrono::milliseconds{1}));
+            continue;
+        }
+        next_frame += versus::FRAME_DURATION;
+        if (!peer.session.can_advance()) {
+            ++peer.stalled_frames;
+            continue;
+        }
+
+        const auto &game = peer.session.state().games[static_cast<std::size_t>(peer.session.local_player())];
+        auto action = core::InputAction::None;
+        if (game.randomizer().position() != planned_piece) {
+            plan = planner.plan(game);
+            std::reverse(plan.begin(), plan.end());
+            planned_piece = game.randomizer().position();
+        }
+        if (!plan.empty() && peer.session.frame() % static_cast<std::uint32_t>(options.frames_per_action) == 0) {
+            action = plan.back();
+            plan.pop_back();
+        }
+
+        std::uint32_t frame = peer.session.advance(action);
+        peer.inputs.push_back(action);
+        Outgoing message{now + std::chrono::milliseconds{options.delay_ms + jitter(rng)}, {}};
+        if (!outbox.empty()) {
+            message.due = std::max(message.due, outbox.back().due);
+        }
+        for (int i = 0; i < 4; ++i) {
+            message.bytes[i] = static_cast<std::uint8_t>(frame >> (8 * i));
+        }
+        message.bytes[4] = static_cast<std::uint8_t>(action);
+        outbox.push_back(message);
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string { return i + 1 < argc ? argv[++i] : ""; };
+        if (arg == "--seconds") {
+            options.seconds = std::stod(next());
+        } else if (arg == "--delay-ms") {
+            options.delay_ms = std::stoi(next());
+        } else if (arg == "--jitter-ms") {
+            options.jitter_ms = std::stoi(next());
+        } else if (arg == "--frames-per-action") {
+            options.frames_per_action = std::max(1, std::stoi(next()));
+        } else if (arg == "--rollback") {
+            options.max_rollback = std::stoul(next());
+        } else if (arg == "--seed") {
+            options.seed = std::stoull(next());
+        } else {
+            std::cout << "Usage: " << argv[0]
+                      << " [--seconds S] [--delay-ms MS] [--jitter-ms MS] [--frames-per-action N] [--rollback FRAMES]"
+                         " [--seed S]\n";
+            return arg == "--help" || arg == "-h" ? 0 : 1;
+        }
+    }
+
+    int fds[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0) {
+        std::perror("socketpair");
+        return 1;
+    }
+    Peer peers[versus::PLAYERS] = {Peer{options.seed, 0, options.max_rollback},
+                                   Peer{options.seed, 1, options.max_rollback}};
+    std::atomic<bool> stop{false};
+    std::thread first{run_peer, std::ref(peers[0]), fds[0], std::cref(options), std::cref(stop)};
+    std::thread second{run_peer, std::ref(peers[1]), fds[1], std::cref(options), std::cref(stop)};
+    std::this_thread::sleep_for(std::chrono::duration<double>(options.seconds));
+    stop.store(true);
+    first.join();
+    second.join();
+    ::close(fds[0]);
+    ::close(fds[1]);
+
+    for (auto &peer : peers) {
+        peer.session.resimulate();
+        const auto &stats = peer.session.stats();
+        const auto &state = peer.session.state();
+        double mean_us = stats.rollbacks > 0 ? static_cast<double>(stats.rollback_time.count()) / 1e3 /
+                                                   static_cast<double>(stats.rollbacks)
+                                             : 0.0;
+        std::printf("player %d: %llu frames, %llu stalled, %llu rollbacks (%.1f frames avg, %u deepest), "
+                    "rollback %.1f us avg / %.1f us max, score %d vs %d\n",
+                    peer.session.local_player(), static_cast<unsigned long long>(stats.frames),
+                    static_cast<unsigned long long>(peer.stalled_frames),
+                    static_cast<unsigned long long>(stats.rollbacks),
+                    stats.rollbacks > 0 ? static_cast<double>(stats.resimulated_frames) /
+                                              static_cast<double>(stats.rollbacks)
+                                        : 0.0,
+                    stats.deepest_rollback, mean_us, static_cast<double>(stats.slowest_rollback.count()) / 1e3,
+                    state.games[0].state().score, state.games[1].state().score);
+    }
+
+    // Ground truth: replay both input logs without any prediction.
+    std::uint32_t common = std::min(peers[0].session.confirmed_frame(), peers[1].session.confirmed_frame());
+    versus::MatchState truth{options.seed};
+    for (std::uint32_t f = 0; f < common; ++f) {
+        versus::FrameInput input;
+        input.actions[0] = peers[0].inputs[f];
+        input.actions[1] = peers[1].inputs[f];
+        versus::step(truth, input);
+    }
+    auto expected = versus::checksum(truth);
+    auto a = peers[0].session.checksum_at(common);
+    auto b = peers[1].session.checksum_at(common);
+    bool ok = a && b && *a == expected && *b == expected;
+    std::printf("frame %u: checksums %016llx %016llx, re-simulated %016llx -> %s\n", common,
+                static_cast<unsigned long long>(a.value_or(0)), static_cast<unsigned long long>(b.value_or(0)),
+                static_cast<unsigned long long>(expected), ok ? "in sync" : "DESYNC");
+    std::printf("winner: %s\n", truth.winner < 0 ? "none yet" : truth.winner == 0 ? "player 0" : "player 1");
+    return ok ? 0 : 1;
+}